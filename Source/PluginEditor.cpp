@@ -3,16 +3,20 @@
 
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor& p)
-    : AudioProcessorEditor (&p), processorRef (p)
+    : AudioProcessorEditor (&p), processorRef (p), parameterEditor (p)
 {
-    juce::ignoreUnused (processorRef);
+    addAndMakeVisible (parameterEditor);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (juce::jmax (minimumWidth, parameterEditor.getWidth()), displayHeight + parameterEditor.getHeight());
+
+    startTimerHz (refreshRateHz);
 }
 
 AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -21,13 +25,74 @@ void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
 
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+    const auto sampleRate = processorRef.getSampleRate();
+    const auto& display = processorRef.delayDisplay;
+    const auto width = static_cast<int> (peaks.size());
+
+    if (sampleRate <= 0.0 || width == 0 || display.getNumChannels() == 0)
+        return;
+
+    const auto visibleSamples = visibleSeconds * sampleRate;
+    const auto laneHeight = static_cast<float> (displayHeight) / static_cast<float> (display.getNumChannels());
+
+    // Peaks of every pixel column, O(width) whatever the zoom.
+    g.setColour (juce::Colours::orange);
+
+    for (int channel = 0; channel < display.getNumChannels(); ++channel)
+    {
+        display.getPeaks (channel, 0.0, visibleSamples, peaks.data(), width);
+
+        const auto centre = laneHeight * (static_cast<float> (channel) + 0.5f);
+        const auto scale = 0.5f * laneHeight;
+
+        for (int x = 0; x < width; ++x)
+        {
+            const auto top = centre - scale * juce::jlimit (-1.0f, 1.0f, peaks[static_cast<size_t> (x)].maximum);
+            const auto bottom = centre - scale * juce::jlimit (-1.0f, 1.0f, peaks[static_cast<size_t> (x)].minimum);
+            g.drawVerticalLine (x, top, juce::jmax (bottom, top + 1.0f));
+        }
+    }
+
+    // Echo taps, every repeat of the delay time in view.
+    const auto delaySamples = processorRef.apvts.getRawParameterValue ("time")->load() * 0.001 * sampleRate;
+
+    if (delaySamples >= 1.0)
+    {
+        g.setColour (juce::Colours::white.withAlpha (0.6f));
+
+        for (int tap = 1; tap <= maxTaps && tap * delaySamples <= visibleSamples; ++tap)
+        {
+            const auto x = static_cast<float> (tap * delaySamples / visibleSamples) * static_cast<float> (width);
+            g.drawLine (x, 0.0f, x, static_cast<float> (displayHeight));
+        }
+    }
+
+    g.setColour (juce::Colours::lightgrey);
+    g.setFont (12.0f);
+    g.drawText (juce::String (visibleSeconds * 1000.0, 0) + " ms", juce::Rectangle<int> (0, 0, width - 4, 16), juce::Justification::right);
 }
 
 void AudioPluginAudioProcessorEditor::resized()
 {
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
+    auto bounds = getLocalBounds();
+    peaks.resize (static_cast<size_t> (bounds.removeFromTop (displayHeight).getWidth()));
+    parameterEditor.setBounds (bounds);
+}
+
+void AudioPluginAudioProcessorEditor::mouseWheelMove (const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel)
+{
+    juce::ignoreUnused (event);
+
+    // Up zooms in, down out, from 10 ms to the longest delay.
+    visibleSeconds = juce::jlimit (minimumVisibleSeconds,
+                                   static_cast<double> (AudioPluginAudioProcessor::maxDelayTimeInSeconds),
+                                   visibleSeconds * std::exp (-2.0 * static_cast<double> (wheel.deltaY)));
+    repaint (0, 0, getWidth(), displayHeight);
+}
+
+void AudioPluginAudioProcessorEditor::timerCallback()
+{
+    repaint (0, 0, getWidth(), displayHeight);
 }
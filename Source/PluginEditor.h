@@ -3,7 +3,7 @@
 #include "PluginProcessor.h"
 
 //==============================================================================
-class AudioPluginAudioProcessorEditor  : public juce::AudioProcessorEditor
+class AudioPluginAudioProcessorEditor  : public juce::AudioProcessorEditor, private juce::Timer
 {
 public:
     explicit AudioPluginAudioProcessorEditor (AudioPluginAudioProcessor&);
@@ -13,10 +13,29 @@ public:
     void paint (juce::Graphics&) override;
     void resized() override;
 
+    // The mouse wheel zooms the display of the delay lines.
+    void mouseWheelMove (const juce::MouseEvent& event, const juce::MouseWheelDetails& wheel) override;
+
 private:
+    void timerCallback() override;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     AudioPluginAudioProcessor& processorRef;
 
+    // Parameters, below the display.
+    juce::GenericAudioProcessorEditor parameterEditor;
+
+    // Display of the delay lines, one lane for each. The age of the samples grows to the right from the
+    // write head on the left edge, the echo taps are the multiples of the delay time. The peaks of every
+    // pixel column are read from the pyramid the audio thread keeps, the buffers themselves are never read.
+    static constexpr int displayHeight = 160;
+    static constexpr int minimumWidth = 480;
+    static constexpr int refreshRateHz = 60;
+    static constexpr int maxTaps = 32;
+    static constexpr double minimumVisibleSeconds = 0.01;
+    double visibleSeconds = AudioPluginAudioProcessor::maxDelayTimeInSeconds;
+    std::vector<cdrt::utility::PeakPyramid::Peak> peaks; // One for each pixel column.
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessorEditor)
 };
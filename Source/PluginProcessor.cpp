@@ -1,9 +1,30 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include "cdrt/helper/Parameters.h"
+#include "cdrt/helper/State.h"
 #include "cdrt/utility/Conversion.h"
+#include "cdrt/utility/Trace.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 
+namespace
+{
+// Interpolations from the cheapest to the most expensive, the index is the quality level.
+constexpr std::array<cdrt::dsp::DelayEngine<float>::Interpolation, 7> interpolationsByCost {
+    cdrt::dsp::DelayEngine<float>::Interpolation::none,
+    cdrt::dsp::DelayEngine<float>::Interpolation::linear,
+    cdrt::dsp::DelayEngine<float>::Interpolation::thiran,
+    cdrt::dsp::DelayEngine<float>::Interpolation::thiran2nd,
+    cdrt::dsp::DelayEngine<float>::Interpolation::thiran3rd,
+    cdrt::dsp::DelayEngine<float>::Interpolation::thiran4th,
+    cdrt::dsp::DelayEngine<float>::Interpolation::lagrange3rd
+};
+
+int getQualityLevel (const cdrt::dsp::DelayEngine<float>::Interpolation interpolation)
+{
+    return static_cast<int> (std::find (interpolationsByCost.begin(), interpolationsByCost.end(), interpolation) - interpolationsByCost.begin());
+}
+} // namespace
+
 //==============================================================================
 AudioPluginAudioProcessor::AudioPluginAudioProcessor()
      : AudioProcessor (BusesProperties()
@@ -21,6 +42,22 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
     apvts.addParameterListener("feedback", this);
     apvts.addParameterListener("dry", this);
     apvts.addParameterListener("wet", this);
+    apvts.addParameterListener("timemode", this);
+    apvts.addParameterListener("modulation", this);
+    apvts.addParameterListener("modrate", this);
+    apvts.addParameterListener("moddepth", this);
+    apvts.addParameterListener("interpolation", this);
+    apvts.addParameterListener("autoquality", this);
+    apvts.addParameterListener("lowcut", this);
+    apvts.addParameterListener("highcut", this);
+    apvts.addParameterListener("tilt", this);
+    apvts.addParameterListener("saturation", this);
+    apvts.addParameterListener("satshape", this);
+    apvts.addParameterListener("pitch", this);
+    apvts.addParameterListener("grainsize", this);
+    apvts.addParameterListener("spread", this);
+    apvts.addParameterListener("diffusion", this);
+    apvts.addParameterListener("wetmode", this);
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
@@ -31,6 +68,22 @@ AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
     apvts.removeParameterListener("feedback", this);
     apvts.removeParameterListener("dry", this);
     apvts.removeParameterListener("wet", this);
+    apvts.removeParameterListener("timemode", this);
+    apvts.removeParameterListener("modulation", this);
+    apvts.removeParameterListener("modrate", this);
+    apvts.removeParameterListener("moddepth", this);
+    apvts.removeParameterListener("interpolation", this);
+    apvts.removeParameterListener("autoquality", this);
+    apvts.removeParameterListener("lowcut", this);
+    apvts.removeParameterListener("highcut", this);
+    apvts.removeParameterListener("tilt", this);
+    apvts.removeParameterListener("saturation", this);
+    apvts.removeParameterListener("satshape", this);
+    apvts.removeParameterListener("pitch", this);
+    apvts.removeParameterListener("grainsize", this);
+    apvts.removeParameterListener("spread", this);
+    apvts.removeParameterListener("diffusion", this);
+    apvts.removeParameterListener("wetmode", this);
 }
 
 //==============================================================================
@@ -109,44 +162,129 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = static_cast<juce::uint32> (samplesPerBlock);
     spec.numChannels = static_cast<juce::uint32> (2);
-    
-    // Delay lines preparation.
-    for (size_t i = 0; i < numDelayLines; ++i)
-    {
-        delayLines.push_back(std::make_shared<cdrt::dsp::DelayLineLinear<float>>());
-        delayLines[i]->prepare(spec);
-        delayLines[i]->setMaxDelaySamples(maxDelayTimeInSeconds * static_cast<int> (sampleRate));
-        delayLines[i]->setDelaySamples(initialDelaySamples);
-        delayLines[i]->setFeedback(initialFeedback);
-    }
-    
-    delayLineRouter = std::make_unique<cdrt::dsp::DelayLineRoutingStraight<float>>();
-    delayLineRouter->prepare(delayLines);
 
-    // Generic parameters init.
-    // Reading values from apvts.
-    auto inputGainParameter = apvts.getRawParameterValue("input")->load();
-    auto outputGainParameter = apvts.getRawParameterValue("output")->load();
+    // With a mono input a single delay line is written once and read by two taps.
+    monoInput = getMainBusNumInputChannels() == 1;
 
-    auto delayTimeParameter = apvts.getRawParameterValue("time")->load();
-    auto delayFeedbackParameter = apvts.getRawParameterValue("feedback")->load();
+    // A host preparing again at the same sample rate keeps every effect as it is, nothing is allocated
+    // or generated: a different block size only resizes the scratch buffers and the mixer.
+    const auto sameSampleRate = juce::approximatelyEqual (preparedSpec.sampleRate, spec.sampleRate) && preparedSpec.numChannels == spec.numChannels;
+    const auto sameBlockSize = sameSampleRate && preparedSpec.maximumBlockSize == spec.maximumBlockSize;
+    preparedSpec = spec;
 
-    auto delayDryParameter = apvts.getRawParameterValue("dry")->load();
-    auto delayWetParameter = apvts.getRawParameterValue("wet")->load();
+    // Delay engine preparation, later interpolation changes are built in background.
+    selectedInterpolation = static_cast<int> (apvts.getRawParameterValue("interpolation")->load());
+    autoQuality = apvts.getRawParameterValue("autoquality")->load() > 0.5f;
+    requestedInterpolation = static_cast<Interpolation> (selectedInterpolation.load());
 
-    // Apply values from apvts.
-    for (auto& value: inputSmoothed)
+    // With the same sample rate and layout the delay lines are kept with their content, no allocation happens.
+    delayEngines.setResampleOnSampleRateChange(resampleDelayOnSampleRateChange);
+    const auto preparation = delayEngines.prepare(spec, maxDelayTimeInSeconds * static_cast<int> (sampleRate), monoInput, requestedInterpolation);
+    delayEngines.setSwapCrossfadeSamples(static_cast<int> (engineCrossfadeInSeconds * sampleRate));
+
+    qualityGovernor.prepare(sampleRate);
+    qualityGovernor.setThresholds(interpolationStepDownLoad, interpolationStepUpLoad);
+    qualityGovernor.setOverload(interpolationOverloadLoad, getQualityLevel (Interpolation::linear));
+    qualityGovernor.setMaximumLevel(getQualityLevel (requestedInterpolation));
+    qualityGovernor.reset();
+
+    if (preparation != cdrt::dsp::DelayEngineManager<float>::Preparation::reused)
     {
-        value.reset(sampleRate, 0.25f);
-        value.setTargetValue(inputGainParameter);
+        for (auto& delayLine: delayEngines.getActiveEngine()->delayLines)
+        {
+            delayLine->setDelaySamples(initialDelaySamples);
+            delayLine->setFeedback(initialFeedback);
+        }
     }
 
-    for (auto& value: outputSmoothed)
+    // Scratch buffers of the delay lines, resized only when the block size grows.
+    for (auto* scratch: { &delayInput, &delayOutput, &delayTimes, &delayFeedbacks })
+        scratch->setSize (numDelayLines, samplesPerBlock, false, false, true);
+
+    // Parallel processing when enabled, one thread for each delay line but the first.
+    delayWorkers.start (parallelDelayLines.load() ? juce::jmin (numDelayLines - 1, juce::SystemStats::getNumCpus() - 1) : 0);
+    parallelGovernor.prepare (sampleRate);
+    parallelGovernor.setMaximumLevel (1);
+    parallelGovernor.setThresholds (parallelStartLoad, parallelStopLoad);
+    parallelGovernor.reset();
+
+    // Tone of the repeats.
+    feedbackLowCut = apvts.getRawParameterValue("lowcut")->load();
+    feedbackHighCut = apvts.getRawParameterValue("highcut")->load();
+    feedbackTilt = apvts.getRawParameterValue("tilt")->load();
+    saturationDrive = apvts.getRawParameterValue("saturation")->load();
+    saturationShape = static_cast<int> (apvts.getRawParameterValue("satshape")->load());
+
+    // One wet signal at most replaces the echoes, the modes below are updated with the chain.
+    wetMode = static_cast<int> (apvts.getRawParameterValue("wetmode")->load());
+
+    // Grain playback, the pool is allocated here for the longest grains.
+    grainPitch = apvts.getRawParameterValue("pitch")->load();
+    grainSize = apvts.getRawParameterValue("grainsize")->load();
+    activeGrainMode = 0;
+
+    if (! sameSampleRate)
+        for (auto& grainEngine: grainEngines)
+            grainEngine.prepare (spec, static_cast<int> (maxGrainSizeInSeconds * sampleRate));
+
+    // Spectral delay, its latency is reported to the host only while it is the wet mode, the dry signal is then delayed to match.
+    bandSpread = apvts.getRawParameterValue("spread")->load();
+    activeSpectralMode = false;
+
+    if (! sameSampleRate)
+        spectralDelay.prepare (spec, maxDelayTimeInSeconds * static_cast<int> (sampleRate));
+
+    setLatencySamples (wetMode.load() == spectralWetMode ? spectralDelay.getLatencySamples() : 0);
+
+    // Multi-band delay, one buffer for the lines of all the bands.
+    activeMultiBandMode = 0;
+
+    if (! sameSampleRate)
+        multiBandDelay.prepare (spec, maxDelayTimeInSeconds * static_cast<int> (sampleRate));
+
+    // Diffusion, exponentially decaying noise (60 dB in a second) with unit energy, one seed for each channel.
+    diffusion = apvts.getRawParameterValue("diffusion")->load();
+    activeDiffusion = false;
+
+    diffuseBuffer.setSize (static_cast<int> (spec.numChannels), samplesPerBlock, false, false, true);
+
+    if (! sameSampleRate)
     {
-        value.reset(sampleRate, 0.25f);
-        value.setTargetValue(outputGainParameter);
+        const auto impulseSamples = static_cast<int> (diffuseImpulseSeconds * sampleRate);
+        juce::AudioBuffer<float> impulse (static_cast<int> (spec.numChannels), impulseSamples);
+
+        for (int channel = 0; channel < impulse.getNumChannels(); ++channel)
+        {
+            juce::Random random (channel + 1);
+            auto* samples = impulse.getWritePointer (channel);
+            double energy = 0.0;
+
+            for (int i = 0; i < impulseSamples; ++i)
+            {
+                const auto time = static_cast<double> (i) / sampleRate;
+                samples[i] = static_cast<float> ((2.0 * random.nextFloat() - 1.0) * std::exp (-6.9 * time) * juce::jmin (1.0, time / 0.002));
+                energy += static_cast<double> (samples[i]) * static_cast<double> (samples[i]);
+            }
+
+            if (energy > 0.0)
+                juce::FloatVectorOperations::multiply (samples, static_cast<float> (1.0 / std::sqrt (energy)), impulseSamples);
+        }
+
+        diffuser.prepare (spec, impulseSamples);
+        diffuser.setImpulseResponse (impulse.getArrayOfReadPointers(), impulse.getNumChannels(), impulseSamples);
     }
 
+    // Generic parameters init.
+    // Reading values from apvts.
+    inputGain = apvts.getRawParameterValue("input")->load();
+    outputGain = apvts.getRawParameterValue("output")->load();
+    delayLineDry = apvts.getRawParameterValue("dry")->load();
+    delayLineWet = apvts.getRawParameterValue("wet")->load();
+
+    auto delayTimeParameter = apvts.getRawParameterValue("time")->load();
+    auto delayFeedbackParameter = apvts.getRawParameterValue("feedback")->load();
+
+    // Apply values from apvts.
     for (auto& value: delayLineTimeValueSmoothed)
     {
         value.reset(sampleRate, 1.0f);
@@ -159,17 +297,40 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
         value.setTargetValue(delayFeedbackParameter);
     }
 
-    for (auto& value: delayLineDrySmoothed)
-    {
-        value.reset(sampleRate, 0.25f);
-        value.setTargetValue(delayDryParameter);
-    }
+    // Processing chain, the stages start at the current values without ramps.
+    chain.get<inputGainStage>().setRampDurationSeconds (inputGainRampInSeconds);
+    chain.get<outputGainStage>().setRampDurationSeconds (outputGainRampInSeconds);
+    chain.get<delayStage>().setCallback (processDelayStage, this);
+    updateChain();
 
-    for (auto& value: delayLineWetSmoothed)
-    {
-        value.reset(sampleRate, 0.25f);
-        value.setTargetValue(delayWetParameter);
-    }
+    if (! sameBlockSize)
+        chain.prepare (spec);
+
+    // Delay time change mode.
+    delayTimeCrossfadeRequested = apvts.getRawParameterValue("timemode")->load() > 0.5f;
+    delayTimeCrossfade = ! delayTimeCrossfadeRequested;
+    updateDelayTimeMode();
+
+    // Modulation effects.
+    modulationMode = static_cast<int> (apvts.getRawParameterValue("modulation")->load());
+    modulationRate = apvts.getRawParameterValue("modrate")->load();
+    modulationDepth = apvts.getRawParameterValue("moddepth")->load();
+    activeModulationMode = 0;
+
+    if (! sameSampleRate)
+        modulatedDelay.prepare(spec);
+
+    // Display, as long as the delay lines.
+    if (! sameSampleRate)
+        delayDisplay.prepare (numDelayLines, delayEngines.getActiveEngine()->delayLines.front()->getMaximumDelaySamples());
+
+    // Delay lines content restored from the state.
+    applyPendingSnapshot();
+}
+
+void AudioPluginAudioProcessor::setParallelDelayLines (const bool shouldRunParallel)
+{
+    parallelDelayLines = shouldRunParallel;
 }
 
 void AudioPluginAudioProcessor::releaseResources()
@@ -178,6 +339,28 @@ void AudioPluginAudioProcessor::releaseResources()
     // spare memory, etc.
 }
 
+void AudioPluginAudioProcessor::reset()
+{
+    // Back to silence keeping the settings: the delay lines with their feedback filters and saturation,
+    // the grains, the spectral and multi-band delays, the convolution, the modulation and the mixer.
+    delayEngines.reset();
+
+    for (auto& grainEngine: grainEngines)
+        grainEngine.reset();
+
+    spectralDelay.reset();
+    multiBandDelay.reset();
+    diffuser.reset();
+    modulatedDelay.reset();
+    chain.reset();
+    delayDisplay.reset();
+
+    // No glide left from the previous playback.
+    for (auto* smoothers: { &delayLineTimeValueSmoothed, &delayLineFeedbackSmoothed })
+        for (auto& value: *smoothers)
+            value.setCurrentAndTargetValue (value.getTargetValue());
+}
+
 bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
   #if JucePlugin_IsMidiEffect
@@ -207,9 +390,17 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
-    juce::ignoreUnused (midiMessages);
+    CDRT_TRACE_SCOPE ("processBlock");
 
     juce::ScopedNoDenormals noDenormals;
+    delayLineTicks = 0;
+
+    // A new engine is swapped in here when the interpolation changed, the feedback filters move to the new settings.
+    delayEngines.setFeedbackFilter(feedbackLowCut.load(), feedbackHighCut.load(), feedbackTilt.load());
+    delayEngines.setFeedbackSaturation(static_cast<Saturation::Shape> (saturationShape.load()), saturationDrive.load());
+    delayEngines.beginBlock(buffer.getNumSamples());
+    updateDelayTimeMode();
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     
@@ -217,45 +408,462 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.copyFrom(i, 0, buffer, 0, 0, buffer.getNumSamples());
 
-    float *toProcessSamples = new float[2];
-    float **channelDatas = new float*[2];
+    // The block is split at the MIDI changes, the chain processes every part in place.
+    auto block = juce::dsp::AudioBlock<float> (buffer).getSubsetChannelBlock (0, static_cast<size_t> (totalNumOutputChannels));
+
+    cdrt::helper::midi::splitBlock (midiMessages, midiMapping, buffer.getNumSamples(),
+                                    [this, &block] (const int start, const int numSamples)
+                                    {
+                                        processChain (block.getSubBlock (static_cast<size_t> (start), static_cast<size_t> (numSamples)));
+                                    },
+                                    [this] (const cdrt::helper::midi::Change& change) { applyMidiChange (change); });
+
+    updateDelayDisplay (buffer.getNumSamples());
+    updateInterpolation (juce::Time::highResolutionTicksToSeconds (delayLineTicks), buffer.getNumSamples());
+}
+
+void AudioPluginAudioProcessor::updateChain()
+{
+    // The wet mode is read once here, one signal at most replaces the echoes of the delay lines.
+    const auto mode = wetMode.load();
+    const auto grainMode = mode == reverseWetMode || mode == pitchWetMode ? mode : 0;
+    const auto spectralMode = mode == spectralWetMode;
+    const auto multiBandMode = mode >= twoBandsWetMode ? mode - twoBandsWetMode + 1 : 0;
+
+    // Coming from another mode the grains, the frames of the spectral delay or the band lines contain old audio.
+    if (grainMode != activeGrainMode)
+        for (auto& grainEngine: grainEngines)
+            grainEngine.reset();
+
+    if (spectralMode && ! activeSpectralMode)
+        spectralDelay.reset();
+
+    if (multiBandMode != activeMultiBandMode)
+        multiBandDelay.reset();
+
+    activeGrainMode = grainMode;
+    activeSpectralMode = spectralMode;
+    activeMultiBandMode = multiBandMode;
+
+    auto& mixer = chain.get<mixStage>();
+    mixer.setWetLatency (activeSpectralMode ? spectralDelay.getLatencySamples() : 0);
+    mixer.setLevels (delayLineDry.load(), delayLineWet.load());
 
-    float updatedInput[2];
-    float updatedOutput[2];
-    float updatedWet[2];
-    float updatedDry[2];
+    chain.get<inputGainStage>().setGainLinear (inputGain.load());
+    chain.get<outputGainStage>().setGainLinear (outputGain.load() * mixer.getMixLevel());
+}
+
+void AudioPluginAudioProcessor::processChain (juce::dsp::AudioBlock<float> block)
+{
+    // The scratch buffers and the mixer hold the prepared block size, a host sending
+    // longer blocks gets them processed in parts.
+    const auto maxSamples = static_cast<size_t> (delayInput.getNumSamples());
+
+    for (size_t start = 0; maxSamples > 0 && start < block.getNumSamples(); start += maxSamples)
+    {
+        auto part = block.getSubBlock (start, juce::jmin (maxSamples, block.getNumSamples() - start));
 
-    channelDatas[0] = buffer.getWritePointer(0);
-    channelDatas[1] = buffer.getWritePointer(1);
-    for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+        // The dry block goes to the mixer first.
+        updateChain();
+        chain.get<mixStage>().pushDrySamples (part);
+        chain.process (juce::dsp::ProcessContextReplacing<float> (part));
+    }
+}
+
+void AudioPluginAudioProcessor::applyMidiChange (const cdrt::helper::midi::Change& change)
+{
+    // The same values the parameters set, the smoothers start from the position of the event.
+    switch (change.target)
     {
-        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+        // The time lands on the event instead of gliding for a second, a note retunes the repeats at once.
+        // In crossfade mode the delay lines fade between the two read heads.
+        case cdrt::helper::midi::Target::time:
+            for (auto& value: delayLineTimeValueSmoothed)
+                value.setCurrentAndTargetValue (change.value);
+            break;
+
+        case cdrt::helper::midi::Target::feedback:
+            for (auto& value: delayLineFeedbackSmoothed)
+                value.setTargetValue (change.value);
+            break;
+
+        case cdrt::helper::midi::Target::mix:
+            delayLineDry = 1.0f - change.value;
+            delayLineWet = change.value;
+            break;
+    }
+}
+
+void AudioPluginAudioProcessor::processDelayStage (void* context, const juce::dsp::AudioBlock<float>& block)
+{
+    CDRT_TRACE_SCOPE ("processBlock::delay");
+
+    auto& processor = *static_cast<AudioPluginAudioProcessor*> (context);
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), processor.delayInput.getNumChannels());
+
+    // Time and feedback of every sample, the delay lines process the whole block next.
+    {
+        CDRT_TRACE_SCOPE ("processBlock::delay::settings");
+
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            // Read the parameter to increment for the current channel.
-            updatedInput[channel] = inputSmoothed[static_cast<size_t>(channel)].getNextValue();
-            updatedOutput[channel] = outputSmoothed[static_cast<size_t>(channel)].getNextValue();
-            updatedWet[channel] = delayLineWetSmoothed[static_cast<size_t>(channel)].getNextValue();
-            updatedDry[channel] = delayLineDrySmoothed[static_cast<size_t>(channel)].getNextValue();
+            auto& time = processor.delayLineTimeValueSmoothed[static_cast<size_t> (channel)];
+            auto& feedback = processor.delayLineFeedbackSmoothed[static_cast<size_t> (channel)];
+            auto* times = processor.delayTimes.getWritePointer (channel);
+            auto* feedbacks = processor.delayFeedbacks.getWritePointer (channel);
 
             // Delay time is critical, smoothing can get it wrong sometimes and goes above the given target values.
-            auto updatedTime = delayLineTimeValueSmoothed[static_cast<size_t>(channel)].getNextValue();
+            // In crossfade mode the target is applied as it is, the delay lines crossfade between the two read heads.
+            if (processor.delayTimeCrossfade || ! time.isSmoothing())
+                juce::FloatVectorOperations::fill (times, processor.delayTimeCrossfade ? time.getTargetValue() : time.getCurrentValue(), numSamples);
+            else
+                for (int sample = 0; sample < numSamples; ++sample)
+                    times[sample] = time.getNextValue();
+
+            if (! feedback.isSmoothing())
+                juce::FloatVectorOperations::fill (feedbacks, feedback.getCurrentValue(), numSamples);
+            else
+                for (int sample = 0; sample < numSamples; ++sample)
+                    feedbacks[sample] = feedback.getNextValue();
+
+            processor.delayInput.copyFrom (channel, 0, block.getChannelPointer (static_cast<size_t> (channel)), numSamples);
+        }
+    }
+
+    processor.processDelayLines (numSamples);
+    processor.processGrains (numSamples);
+    processor.processMultiBand (numSamples);
+    processor.processSpectral (numSamples);
+    processor.processDiffusion (numSamples);
+    processor.processModulation (numSamples);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::copy (block.getChannelPointer (static_cast<size_t> (channel)), processor.delayOutput.getReadPointer (channel), numSamples);
+}
+
+void AudioPluginAudioProcessor::processDelayLines (const int numSamples)
+{
+    auto& engine = *delayEngines.getActiveEngine();
+
+    // The mono routing shares one delay line between the outputs, and during an engine swap
+    // the old engine runs too: in both cases the samples go through the engines together.
+    // Otherwise every delay line processes the whole block alone, on the workers when it is worth it.
+    const bool canSplit = ! monoInput && ! delayEngines.isCrossfading() && engine.delayLines.size() <= maxDelayLineJobs;
+    const bool canRunParallel = canSplit && parallelDelayLines.load() && delayWorkers.getNumWorkers() > 0 && engine.delayLines.size() > 1;
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+    auto workTicks = static_cast<juce::int64> (0);
+
+    if (canSplit)
+    {
+        delayLineJobs.engine = &engine;
+        delayLineJobs.numSamples = numSamples;
+
+        if (canRunParallel && parallelGovernor.getLevel() == 0)
+            delayWorkers.run (&AudioPluginAudioProcessor::processDelayLine, this, static_cast<int> (engine.delayLines.size()));
+        else
+            for (size_t i = 0; i < engine.delayLines.size(); ++i)
+                processDelayLine (this, static_cast<int> (i));
+
+        // The work is the sum of the jobs, not the time the block took.
+        for (size_t i = 0; i < engine.delayLines.size(); ++i)
+            workTicks += delayLineJobs.ticks[i];
+    }
+    else if (monoInput && ! delayEngines.isCrossfading() && areDelaySettingsSettled (numSamples))
+    {
+        // Settled smoothers, the shared delay line and its tap process the block at once.
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            delayEngines.setDelayTime (channel, delayTimes.getSample (channel, 0));
+            delayEngines.setFeedback (channel, delayFeedbacks.getSample (channel, 0));
+        }
+
+        engine.router->processBlock (delayInput.getReadPointer (0), delayOutput.getWritePointer (0), delayOutput.getWritePointer (1), numSamples);
+        workTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    }
+    else
+    {
+        // Traced per block, as the block paths of the delay lines.
+        CDRT_TRACE_SCOPE ("processBlock::delay::router");
 
-            // Apply the time and feedback.
-            delayLines[static_cast<size_t>(channel)]->setDelayTime (updatedTime);
-            delayLines[static_cast<size_t>(channel)]->setFeedback (delayLineFeedbackSmoothed[static_cast<size_t> (channel)].getNextValue());
+        float samples[2];
 
-            toProcessSamples[channel] = channelDatas[channel][sample];
+        for (auto& delayLine: engine.delayLines)
+            delayLine->prefetchBlock (0, numSamples);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                delayEngines.setDelayTime (channel, delayTimes.getSample (channel, sample));
+                delayEngines.setFeedback (channel, delayFeedbacks.getSample (channel, sample));
+                samples[channel] = delayInput.getSample (channel, sample);
+            }
+
+            delayEngines.processSamples (samples);
+
+            for (int channel = 0; channel < 2; ++channel)
+                delayOutput.setSample (channel, sample, samples[channel]);
         }
-        toProcessSamples[0] = channelDatas[0][sample] * updatedInput[0];
-        toProcessSamples[1] = channelDatas[1][sample] * updatedInput[1];
 
-        toProcessSamples = delayLineRouter->processSamples(toProcessSamples);
+        workTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    }
 
-        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
-            channelDatas[channel][sample] = ((channelDatas[channel][sample] * updatedDry[channel]) + (updatedWet[channel] * toProcessSamples[channel])) * updatedOutput[channel];
+    delayLineTicks += workTicks;
+
+    // Small configurations never leave the single thread.
+    if (canRunParallel)
+        parallelGovernor.addMeasurement (juce::Time::highResolutionTicksToSeconds (workTicks), numSamples);
+}
+
+bool AudioPluginAudioProcessor::areDelaySettingsSettled (const int numSamples) const
+{
+    for (const auto* settings: { &delayTimes, &delayFeedbacks })
+    {
+        for (int channel = 0; channel < settings->getNumChannels(); ++channel)
+        {
+            float minimum, maximum;
+            juce::FloatVectorOperations::findMinAndMax (settings->getReadPointer (channel), numSamples, minimum, maximum);
+
+            if (minimum != maximum)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void AudioPluginAudioProcessor::processGrains (const int numSamples)
+{
+    // The mode is updated with the chain.
+    const auto mode = activeGrainMode;
+
+    if (mode == 0)
+        return;
+
+    const auto& engine = *delayEngines.getActiveEngine();
+    const auto grainSamples = static_cast<int> (grainSize.load() * 0.001 * getSampleRate());
+
+    for (size_t channel = 0; channel < grainEngines.size(); ++channel)
+    {
+        auto& grainEngine = grainEngines[channel];
+        grainEngine.setMode (static_cast<cdrt::dsp::GrainEngine<float>::Mode> (mode - 1));
+        grainEngine.setPitch (grainPitch.load());
+        grainEngine.setGrainSamples (grainSamples);
+
+        // With the mono routing both outputs read the only delay line.
+        const auto& delayLine = *engine.delayLines[monoInput ? 0 : channel];
+        grainEngine.process (delayLine, 0, delayOutput.getWritePointer (static_cast<int> (channel)), numSamples);
     }
-    delete [] channelDatas;
-    delete [] toProcessSamples ;
+}
+
+void AudioPluginAudioProcessor::processSpectral (const int numSamples)
+{
+    // The mode is updated with the chain, before the dry signal is pushed to the mixer.
+    if (! activeSpectralMode)
+        return;
+
+    const auto feedback = delayLineFeedbackSmoothed[0].getTargetValue();
+
+    for (int band = 0; band < cdrt::dsp::SpectralDelay::numBands; ++band)
+        spectralDelay.setBand (band, getBandDelaySamples (band, cdrt::dsp::SpectralDelay::numBands), feedback);
+
+    for (int channel = 0; channel < delayOutput.getNumChannels(); ++channel)
+        delayOutput.copyFrom (channel, 0, delayInput, channel, 0, numSamples);
+
+    auto block = juce::dsp::AudioBlock<float> (delayOutput).getSubBlock (0, static_cast<size_t> (numSamples));
+    spectralDelay.process (juce::dsp::ProcessContextReplacing<float> (block));
+}
+
+void AudioPluginAudioProcessor::processMultiBand (const int numSamples)
+{
+    // The mode is updated with the chain.
+    const auto mode = activeMultiBandMode;
+
+    if (mode == 0)
+        return;
+
+    const auto numBands = mode + 1;
+    const auto feedback = delayLineFeedbackSmoothed[0].getTargetValue();
+
+    multiBandDelay.setNumBands (numBands);
+
+    // Crossovers evenly spaced on a logarithmic scale between 200 Hz and 5 kHz, 1 kHz with 2 bands.
+    for (int crossover = 0; crossover < numBands - 1; ++crossover)
+        multiBandDelay.setCrossover (crossover, numBands == 2 ? 1000.0f : 200.0f * std::pow (25.0f, static_cast<float> (crossover) / static_cast<float> (numBands - 2)));
+
+    for (int band = 0; band < numBands; ++band)
+        multiBandDelay.setBand (band, getBandDelaySamples (band, numBands), feedback);
+
+    for (int channel = 0; channel < delayOutput.getNumChannels(); ++channel)
+        delayOutput.copyFrom (channel, 0, delayInput, channel, 0, numSamples);
+
+    auto block = juce::dsp::AudioBlock<float> (delayOutput).getSubBlock (0, static_cast<size_t> (numSamples));
+    multiBandDelay.process (juce::dsp::ProcessContextReplacing<float> (block));
+}
+
+void AudioPluginAudioProcessor::processDiffusion (const int numSamples)
+{
+    const auto amount = diffusion.load();
+
+    // Coming from off the history and the pending tail contain old audio.
+    if (amount > 0.0f && ! activeDiffusion)
+        diffuser.reset();
+
+    activeDiffusion = amount > 0.0f;
+
+    if (! activeDiffusion)
+        return;
+
+    for (int channel = 0; channel < diffuseBuffer.getNumChannels(); ++channel)
+        diffuseBuffer.copyFrom (channel, 0, delayOutput, channel, 0, numSamples);
+
+    auto block = juce::dsp::AudioBlock<float> (diffuseBuffer).getSubBlock (0, static_cast<size_t> (numSamples));
+    diffuser.process (juce::dsp::ProcessContextReplacing<float> (block));
+
+    for (int channel = 0; channel < diffuseBuffer.getNumChannels(); ++channel)
+    {
+        delayOutput.applyGain (channel, 0, numSamples, 1.0f - amount);
+        delayOutput.addFrom (channel, 0, diffuseBuffer, channel, 0, numSamples, amount);
+    }
+}
+
+void AudioPluginAudioProcessor::processModulation (const int numSamples)
+{
+    const auto mode = modulationMode.load();
+
+    // Coming from off the buffer of the effect contains old audio.
+    if (mode > 0 && activeModulationMode == 0)
+        modulatedDelay.reset();
+
+    activeModulationMode = mode;
+
+    if (mode == 0)
+        return;
+
+    modulatedDelay.setMode (static_cast<cdrt::dsp::ModulatedDelay<float>::Mode> (mode - 1));
+    modulatedDelay.setRate (modulationRate.load());
+    modulatedDelay.setDepth (modulationDepth.load());
+
+    auto block = juce::dsp::AudioBlock<float> (delayOutput).getSubBlock (0, static_cast<size_t> (numSamples));
+    modulatedDelay.process (juce::dsp::ProcessContextReplacing<float> (block));
+}
+
+float AudioPluginAudioProcessor::getBandDelaySamples (const int band, const int numBands) const
+{
+    // The delay time is spread over the bands, low bands shorter with a positive spread.
+    const auto delaySamples = delayLineTimeValueSmoothed[0].getTargetValue() * 0.001f * static_cast<float> (getSampleRate());
+    const auto position = 2.0f * static_cast<float> (band) / static_cast<float> (numBands - 1) - 1.0f;
+
+    return delaySamples * juce::jmax (0.0f, 1.0f + bandSpread.load() * position);
+}
+
+void AudioPluginAudioProcessor::processDelayLine (void* context, const int index)
+{
+    auto& processor = *static_cast<AudioPluginAudioProcessor*> (context);
+    auto& jobs = processor.delayLineJobs;
+    auto& delayLine = *jobs.engine->delayLines[static_cast<size_t> (index)];
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const auto* times = processor.delayTimes.getReadPointer (index);
+    const auto* feedbacks = processor.delayFeedbacks.getReadPointer (index);
+    auto* output = processor.delayOutput.getWritePointer (index);
+
+    // Same as the straight routing: every delay line is fed with the first input.
+    const auto* input = processor.delayInput.getReadPointer (0);
+
+    float minTime, maxTime, minFeedback, maxFeedback;
+    juce::FloatVectorOperations::findMinAndMax (times, jobs.numSamples, minTime, maxTime);
+    juce::FloatVectorOperations::findMinAndMax (feedbacks, jobs.numSamples, minFeedback, maxFeedback);
+
+    // Settled smoothers, the delay line can process the block at once (a copy with an integer delay).
+    if (minTime == maxTime && minFeedback == maxFeedback)
+    {
+        delayLine.setDelayTime (times[0]);
+        delayLine.setFeedback (feedbacks[0]);
+        delayLine.processBlock (0, input, output, jobs.numSamples);
+    }
+    else
+    {
+        delayLine.prefetchBlock (0, jobs.numSamples);
+
+        for (int sample = 0; sample < jobs.numSamples; ++sample)
+        {
+            delayLine.setDelayTime (times[sample]);
+            delayLine.setFeedback (feedbacks[sample]);
+            output[sample] = delayLine.processSample (0, input[sample]);
+        }
+    }
+
+    jobs.ticks[static_cast<size_t> (index)] = juce::Time::getHighResolutionTicks() - startTicks;
+}
+
+void AudioPluginAudioProcessor::updateDelayDisplay (const int numSamples)
+{
+    const auto& engine = *delayEngines.getActiveEngine();
+
+    for (int channel = 0; channel < delayDisplay.getNumChannels(); ++channel)
+    {
+        // With the mono routing both outputs read the only delay line.
+        const auto& delayLine = *engine.delayLines[static_cast<size_t> (monoInput ? 0 : channel)];
+        const auto size = delayLine.getMaximumDelaySamples();
+        const auto* samples = delayLine.getReadPointer (0);
+
+        // The block wrote the samples before the write index, wrapped around the end of the buffer.
+        const auto count = juce::jmin (numSamples, size);
+        const auto start = ((delayLine.getWriteIndex (0) - count) % size + size) % size;
+        const auto first = juce::jmin (count, size - start);
+
+        delayDisplay.push (channel, samples + start, first);
+        delayDisplay.push (channel, samples, count - first);
+    }
+}
+
+void AudioPluginAudioProcessor::updateInterpolation (const double elapsedSeconds, const int numSamples)
+{
+    const auto selected = static_cast<Interpolation> (selectedInterpolation.load());
+    auto wanted = selected;
+
+    qualityGovernor.setMaximumLevel (getQualityLevel (selected));
+
+    if (autoQuality.load())
+    {
+        qualityGovernor.addMeasurement (elapsedSeconds, numSamples);
+        wanted = interpolationsByCost[static_cast<size_t> (qualityGovernor.getLevel())];
+    }
+    else
+    {
+        // Enabling the auto mode starts from the selected interpolation.
+        qualityGovernor.reset();
+    }
+
+    if (wanted == requestedInterpolation)
+        return;
+
+    // The new engine is built in background and crossfaded with the current one.
+    requestedInterpolation = wanted;
+    delayEngines.requestInterpolation (wanted);
+}
+
+void AudioPluginAudioProcessor::updateDelayTimeMode()
+{
+    const bool requested = delayTimeCrossfadeRequested.load();
+
+    if (requested == delayTimeCrossfade)
+        return;
+
+    delayTimeCrossfade = requested;
+
+    const auto crossfadeSamples = delayTimeCrossfade ? static_cast<int> (delayTimeCrossfadeInSeconds * getSampleRate()) : 0;
+
+    for (auto& delayLine: delayEngines.getActiveEngine()->delayLines)
+        delayLine->setCrossfadeSamples (crossfadeSamples);
+
+    // Leaving the crossfade mode the glide must restart from the time currently in use.
+    for (auto& value: delayLineTimeValueSmoothed)
+        value.setCurrentAndTargetValue (value.getTargetValue());
 }
 
 //==============================================================================
@@ -266,20 +874,54 @@ bool AudioPluginAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* AudioPluginAudioProcessor::createEditor()
 {
-//    return new AudioPluginAudioProcessorEditor (*this);
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new AudioPluginAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void AudioPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml (state.createXml());
-    copyXmlToBinary (*xml, destData);
+    cdrt::helper::state::Snapshot snapshot;
+
+    if (delaySnapshotInState)
+    {
+        // Holding the callback lock the delay lines are not processed while being copied.
+        const juce::ScopedLock sl (getCallbackLock());
+
+        if (auto* engine = delayEngines.getActiveEngine())
+        {
+            const auto& delayLines = engine->delayLines;
+
+            snapshot.sampleRate = getSampleRate();
+            snapshot.buffer.setSize (static_cast<int> (delayLines.size()), delayLines[0]->getMaximumDelaySamples());
+
+            for (size_t i = 0; i < delayLines.size(); ++i)
+                delayLines[i]->copyHistory (0, snapshot.buffer.getWritePointer (static_cast<int> (i)));
+        }
+    }
+
+    cdrt::helper::state::write (destData, cdrt::helper::state::getParameters (*this), &snapshot);
 }
 
 void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    if (cdrt::helper::state::isBinaryState (data, sizeInBytes))
+    {
+        std::vector<cdrt::helper::state::Parameter> parameters;
+        cdrt::helper::state::Snapshot snapshot;
+
+        // Corrupted or newer states are ignored, the current state is kept.
+        if (! cdrt::helper::state::read (data, sizeInBytes, parameters, snapshot))
+            return;
+
+        cdrt::helper::state::setParameters (*this, parameters);
+
+        const juce::ScopedLock sl (getCallbackLock());
+        pendingSnapshot = std::move (snapshot);
+        applyPendingSnapshot();
+        return;
+    }
+
+    // Sessions saved before the binary format use XML.
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
     if (xmlState.get() != nullptr)
@@ -287,22 +929,39 @@ void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeI
             apvts.replaceState (juce::ValueTree::fromXml (*xmlState));
 }
 
+void AudioPluginAudioProcessor::applyPendingSnapshot()
+{
+    auto* engine = delayEngines.getActiveEngine();
+
+    if (pendingSnapshot.buffer.getNumChannels() == 0 || engine == nullptr)
+        return;
+
+    const auto& delayLines = engine->delayLines;
+
+    // Tails recorded at another sample rate would be played at the wrong speed.
+    if (juce::approximatelyEqual (pendingSnapshot.sampleRate, getSampleRate()))
+    {
+        // A snapshot saved with the mono layout restores both lines from the same one.
+        for (size_t i = 0; i < delayLines.size(); ++i)
+        {
+            const auto channel = juce::jmin (static_cast<int> (i), pendingSnapshot.buffer.getNumChannels() - 1);
+            delayLines[i]->setHistory (0, pendingSnapshot.buffer.getReadPointer (channel), pendingSnapshot.buffer.getNumSamples());
+        }
+    }
+
+    pendingSnapshot.buffer.setSize (0, 0);
+}
+
 //==============================================================================
 void AudioPluginAudioProcessor::parameterChanged (const juce::String& parameterID, float newValue)
 {
     if (parameterID == "input")
     {
-        for (auto& value: inputSmoothed)
-        {
-            value.setTargetValue(newValue);
-        }
+        inputGain = newValue;
     }
     else if (parameterID == "output")
     {
-        for (auto& value: outputSmoothed)
-        {
-            value.setTargetValue(newValue);
-        }
+        outputGain = newValue;
     }
     else if (parameterID == "time")
     {
@@ -320,17 +979,78 @@ void AudioPluginAudioProcessor::parameterChanged (const juce::String& parameterI
     }
     else if (parameterID == "dry")
     {
-        for (auto& value: delayLineDrySmoothed)
-        {
-            value.setTargetValue(newValue);
-        }
+        delayLineDry = newValue;
     }
     else if (parameterID == "wet")
     {
-        for (auto& value: delayLineWetSmoothed)
-        {
-            value.setTargetValue(newValue);
-        }
+        delayLineWet = newValue;
+    }
+    else if (parameterID == "timemode")
+    {
+        delayTimeCrossfadeRequested = newValue > 0.5f;
+    }
+    else if (parameterID == "interpolation")
+    {
+        selectedInterpolation = static_cast<int> (newValue);
+    }
+    else if (parameterID == "autoquality")
+    {
+        autoQuality = newValue > 0.5f;
+    }
+    else if (parameterID == "modulation")
+    {
+        modulationMode = static_cast<int> (newValue);
+    }
+    else if (parameterID == "modrate")
+    {
+        modulationRate = newValue;
+    }
+    else if (parameterID == "moddepth")
+    {
+        modulationDepth = newValue;
+    }
+    else if (parameterID == "lowcut")
+    {
+        feedbackLowCut = newValue;
+    }
+    else if (parameterID == "highcut")
+    {
+        feedbackHighCut = newValue;
+    }
+    else if (parameterID == "tilt")
+    {
+        feedbackTilt = newValue;
+    }
+    else if (parameterID == "saturation")
+    {
+        saturationDrive = newValue;
+    }
+    else if (parameterID == "satshape")
+    {
+        saturationShape = static_cast<int> (newValue);
+    }
+    else if (parameterID == "wetmode")
+    {
+        wetMode = static_cast<int> (newValue);
+
+        // The host is told about the latency of the spectral delay, the other modes have none.
+        setLatencySamples (wetMode.load() == spectralWetMode ? spectralDelay.getLatencySamples() : 0);
+    }
+    else if (parameterID == "pitch")
+    {
+        grainPitch = newValue;
+    }
+    else if (parameterID == "grainsize")
+    {
+        grainSize = newValue;
+    }
+    else if (parameterID == "spread")
+    {
+        bandSpread = newValue;
+    }
+    else if (parameterID == "diffusion")
+    {
+        diffusion = newValue;
     }
 }
 
@@ -1,9 +1,22 @@
 #pragma once
 
 #include <juce_audio_processors/juce_audio_processors.h>
+#include "cdrt/dsp/DelayEngine.h"
 #include "cdrt/dsp/DelayLine.h"
 #include "cdrt/dsp/DelayLineRouting.h"
+#include "cdrt/dsp/GrainEngine.h"
+#include "cdrt/dsp/ModulatedDelay.h"
+#include "cdrt/dsp/MultiBandDelay.h"
+#include "cdrt/dsp/PartitionedConvolution.h"
+#include "cdrt/dsp/ProcessingStages.h"
+#include "cdrt/dsp/SpectralDelay.h"
+#include "cdrt/helper/MidiControl.h"
+#include "cdrt/helper/State.h"
+#include "cdrt/utility/QualityGovernor.h"
 #include "cdrt/utility/Interpolation.h"
+#include "cdrt/utility/PeakPyramid.h"
+#include "cdrt/utility/Trace.h"
+#include "cdrt/utility/WorkerPool.h"
 
 
 class AudioPluginAudioProcessor : public juce::AudioProcessor, public juce::AudioProcessorValueTreeState::Listener
@@ -14,6 +27,7 @@ public:
     
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void reset() override;
     
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
     
@@ -39,6 +53,7 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
     
     // AudioProcessorValueTreeSTate::Listener
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
     
     juce::AudioProcessorValueTreeState apvts;
     
@@ -48,17 +63,286 @@ public:
     static constexpr float maxDelayTimeInMilliseconds = 3000.0f;
     static constexpr float initialDelaySamples = 250.0f;
     static constexpr float initialFeedback = 0.0f;
-    std::vector<std::shared_ptr<cdrt::dsp::DelayLineBase<float>>> delayLines;
-    std::unique_ptr<cdrt::dsp::DelayLineRoutingBase<float>> delayLineRouter;
-    
+    static constexpr float delayTimeCrossfadeInSeconds = 0.05f;
+    static constexpr float engineCrossfadeInSeconds = 0.02f;
+    using Interpolation = cdrt::dsp::DelayEngine<float>::Interpolation;
+    cdrt::dsp::DelayEngineManager<float> delayEngines; // Delay lines and router.
+
+    // Interpolation, in auto quality mode the selected one is the highest the governor can use.
+    // The governor measures the work of the delay lines only, the other effects don't depend on the interpolation.
+    // In overload it goes straight to linear, skipping the thiran orders.
+    static constexpr double interpolationStepDownLoad = 0.4;
+    static constexpr double interpolationStepUpLoad = 0.15;
+    static constexpr double interpolationOverloadLoad = 0.7;
+    std::atomic<int> selectedInterpolation { static_cast<int> (Interpolation::linear) };
+    std::atomic<bool> autoQuality { false };
+    Interpolation requestedInterpolation = Interpolation::linear;
+    cdrt::utility::QualityGovernor qualityGovernor;
+    juce::int64 delayLineTicks = 0; // Work of the delay lines in the current block.
+
+    /**
+     * @brief This method requests the interpolation to use, chosen by the quality governor in auto quality mode.
+     *
+     * @param elapsedSeconds: time spent processing the delay lines in the last block.
+     * @param numSamples: number of samples of the last block.
+     */
+    void updateInterpolation (const double elapsedSeconds, const int numSamples);
+    bool monoInput = false; // One delay line with two read taps.
+    bool resampleDelayOnSampleRateChange = true; // Keep the echo tail when the host changes sample rate.
+    juce::dsp::ProcessSpec preparedSpec {}; // Last prepareToPlay, the effects are rebuilt only when it changes.
+
     
-    // Generic parameters.
-    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>, 2> inputSmoothed;
-    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>, 2> outputSmoothed;
+    // Generic parameters, the gains are applied by the processing chain. The output gain carries the
+    // level of the mix, it ramps as fast as the proportion of juce::dsp::DryWetMixer (50 ms) to follow it.
+    static constexpr float inputGainRampInSeconds = 0.25f;
+    static constexpr float outputGainRampInSeconds = 0.05f;
+    std::atomic<float> inputGain { 1.0f };
+    std::atomic<float> outputGain { 1.0f };
+    std::atomic<float> delayLineDry { 0.7f };
+    std::atomic<float> delayLineWet { 0.7f };
     
     // Delay parameters.
     std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>, 2> delayLineTimeValueSmoothed;
     std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>, 2> delayLineFeedbackSmoothed;
-    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>, 2> delayLineDrySmoothed;
-    std::array<juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>, 2> delayLineWetSmoothed;
+
+    // Processing chain, every stage processes the block (or a part between MIDI changes) in place: input gain (wet path only,
+    // the dry block is pushed to the mixer before), delay lines and effects, dry/wet mix, output gain.
+    enum ChainStage
+    {
+        inputGainStage,
+        delayStage,
+        mixStage,
+        outputGainStage
+    };
+
+    juce::dsp::ProcessorChain<juce::dsp::Gain<float>,
+                              cdrt::dsp::CallbackStage<float>,
+                              cdrt::dsp::MixStage<float>,
+                              juce::dsp::Gain<float>> chain;
+
+    /**
+     * @brief This method moves the stages of the chain to the current parameters.
+     */
+    void updateChain();
+
+    /**
+     * @brief This method processes a part of the block with the chain, at the current parameters.
+     * Parts longer than the prepared block size go through the chain in pieces.
+     *
+     * @param block: part of the block to process in place.
+     */
+    void processChain (juce::dsp::AudioBlock<float> block);
+
+    // MIDI control of time, feedback and mix. The block is split at the events that change a parameter,
+    // the parts are processed block-wise. The mapping is set before playback.
+    cdrt::helper::midi::Mapping midiMapping;
+
+    /**
+     * @brief This method applies a change received by MIDI, at the beginning of the next part of the block.
+     *
+     * @param change: parameter and its value.
+     */
+    void applyMidiChange (const cdrt::helper::midi::Change& change);
+
+    /**
+     * @brief This function processes the wet path of the block with the delay lines and the effects, delay stage of the chain.
+     *
+     * @param context: the processor.
+     * @param block: block to process in place.
+     */
+    static void processDelayStage (void* context, const juce::dsp::AudioBlock<float>& block);
+
+    // Delay lines processing, input, output, time and feedback of every sample of the block.
+    juce::AudioBuffer<float> delayInput;
+    juce::AudioBuffer<float> delayOutput;
+    juce::AudioBuffer<float> delayTimes;
+    juce::AudioBuffer<float> delayFeedbacks;
+
+    /**
+     * @brief This method processes the block in the scratch buffers with the delay lines,
+     * on the worker threads when the measured work is worth it.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void processDelayLines (const int numSamples);
+
+    /**
+     * @brief This method tells whether the times and the feedbacks of the block are constant, so the delay lines can process it at once.
+     *
+     * @param numSamples: number of samples of the block.
+     * @return bool
+     */
+    bool areDelaySettingsSettled (const int numSamples) const;
+
+    /**
+     * @brief This function processes the block with one delay line, job of the worker pool also run on the audio thread.
+     *
+     * @param context: the processor.
+     * @param index: index of the delay line.
+     */
+    static void processDelayLine (void* context, const int index);
+
+    // Parallel processing of the delay lines, off by default. The governor level is 1 on the audio thread
+    // alone and goes to 0 (parallel) when the work of the delay lines takes a large part
+    // of the block duration, the work is measured the same way in both modes.
+    static constexpr size_t maxDelayLineJobs = 8;
+    static constexpr double parallelStartLoad = 0.25;
+    static constexpr double parallelStopLoad = 0.1;
+    std::atomic<bool> parallelDelayLines { false };
+
+    /**
+     * @brief This method enables the parallel processing of the delay lines, for the large configurations.
+     * The worker threads are started by the next prepareToPlay and only when enabled, disabling it takes effect at once.
+     *
+     * @param shouldRunParallel: true to let the delay lines run on the workers.
+     */
+    void setParallelDelayLines (const bool shouldRunParallel);
+
+    cdrt::utility::WorkerPool delayWorkers;
+    cdrt::utility::QualityGovernor parallelGovernor;
+
+    struct DelayLineJobs
+    {
+        cdrt::dsp::DelayEngine<float>* engine = nullptr;
+        int numSamples = 0;
+        std::array<juce::int64, maxDelayLineJobs> ticks {};
+    } delayLineJobs;
+
+    // Feedback filters, the tone of the repeats.
+    std::atomic<float> feedbackLowCut { 20.0f };
+    std::atomic<float> feedbackHighCut { 20000.0f };
+    std::atomic<float> feedbackTilt { 0.0f };
+
+    // Saturation of the repeats, antialiased at the base sample rate.
+    using Saturation = cdrt::dsp::Saturation<float>;
+    std::atomic<float> saturationDrive { 0.0f };
+    std::atomic<int> saturationShape { 0 };
+
+    // Wet signal, the echoes of the delay lines or one of the signals replacing them. The mode is read once
+    // for every part of the block with the chain, the grains, spectral and multi-band modes below follow from it.
+    enum WetMode
+    {
+        delayWetMode,
+        reverseWetMode,
+        pitchWetMode,
+        spectralWetMode,
+        twoBandsWetMode,
+        threeBandsWetMode,
+        fourBandsWetMode
+    };
+
+    std::atomic<int> wetMode { delayWetMode };
+
+    // Grain playback of the delay buffer (reverse, pitch shifted), replaces the wet signal, 0 means off.
+    static constexpr float maxGrainSizeInSeconds = 0.5f;
+    std::array<cdrt::dsp::GrainEngine<float>, 2> grainEngines;
+    std::atomic<float> grainPitch { 12.0f };
+    std::atomic<float> grainSize { 120.0f };
+    int activeGrainMode = 0;
+
+    /**
+     * @brief This method overwrites the wet signal with the grains read from the delay lines, when enabled.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void processGrains (const int numSamples);
+
+    // Spectral delay, the delay time is spread over the bands and replaces the wet signal when enabled.
+    // Its latency is reported to the host while it is the wet mode and the mixer delays the dry signal to match.
+    cdrt::dsp::SpectralDelay spectralDelay;
+    bool activeSpectralMode = false;
+
+    // Spread of the delay time over the bands of the spectral and multi-band delays, low bands shorter when positive.
+    std::atomic<float> bandSpread { 0.5f };
+
+    /**
+     * @brief This method gets the delay of a band, the delay time spread over the bands.
+     *
+     * @param band: index of the band, 0 is the lowest.
+     * @param numBands: number of bands.
+     * @return float
+     */
+    float getBandDelaySamples (const int band, const int numBands) const;
+
+    /**
+     * @brief This method overwrites the wet signal with the spectral delay of the input, when enabled.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void processSpectral (const int numSamples);
+
+    // Multi-band delay, the input is split by crossovers and every band has its own delay, replaces the wet signal.
+    // 0 means off, otherwise the number of bands is the mode plus 1.
+    cdrt::dsp::MultiBandDelay<float> multiBandDelay;
+    int activeMultiBandMode = 0;
+
+    /**
+     * @brief This method overwrites the wet signal with the multi-band delay of the input, when enabled.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void processMultiBand (const int numSamples);
+
+    // Diffusion of the echoes, the wet signal is crossfaded with its convolution by a decaying noise impulse response.
+    // The convolution has no latency, its long tail is computed on a background thread.
+    static constexpr float diffuseImpulseSeconds = 1.5f;
+    cdrt::dsp::PartitionedConvolution diffuser;
+    juce::AudioBuffer<float> diffuseBuffer;
+    std::atomic<float> diffusion { 0.0f };
+    bool activeDiffusion = false;
+
+    /**
+     * @brief This method mixes the convolution of the wet signal into it, when the diffusion is on.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void processDiffusion (const int numSamples);
+
+    // Delay time change mode, written by the parameter listener and applied at the beginning of the next block.
+    std::atomic<bool> delayTimeCrossfadeRequested { false };
+    bool delayTimeCrossfade = false;
+
+    /**
+     * @brief This method applies the requested delay time change mode (glide or crossfade) to the delay lines.
+     */
+    void updateDelayTimeMode();
+
+    // Modulation effects (chorus, flanger, vibrato), 0 means off.
+    cdrt::dsp::ModulatedDelay<float> modulatedDelay;
+    std::atomic<int> modulationMode { 0 };
+    std::atomic<float> modulationRate { 0.8f };
+    std::atomic<float> modulationDepth { 0.5f };
+    int activeModulationMode = 0;
+
+    /**
+     * @brief This method applies the modulation effect to the wet signal, when enabled. The dry signal is left as it is.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void processModulation (const int numSamples);
+
+    // Display of the delay lines in the editor, the samples written to them by every block.
+    cdrt::utility::PeakPyramid delayDisplay;
+
+    /**
+     * @brief This method pushes the samples the block wrote to the delay lines to the display.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void updateDelayDisplay (const int numSamples);
+
+    // State, set delaySnapshotInState to save the content of the delay lines too (a few MB for each instance).
+    bool delaySnapshotInState = false;
+    cdrt::helper::state::Snapshot pendingSnapshot;
+
+    /**
+     * @brief This method restores the delay lines from the snapshot read by the last setStateInformation, if any.
+     * The snapshot is kept until the delay lines are prepared, and dropped if the sample rate differs.
+     */
+    void applyPendingSnapshot();
+
+   #if CDRT_ENABLE_TRACING
+    // Keeps the process wide trace session alive while this instance exists.
+    juce::SharedResourcePointer<cdrt::utility::trace::Session> traceSession;
+   #endif
 };
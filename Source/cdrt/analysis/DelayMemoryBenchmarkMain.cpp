@@ -0,0 +1,164 @@
+#include "./PerfCounters.h"
+#include "../dsp/DelayEngine.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+// Cost of the memory accesses of long delays: several instances (as in a session) process blocks
+// in turn with a fractional delay, every delay length with and without huge pages. Prints ns/sample
+// and the TLB and cache misses of every thousand samples as CSV, empty when a counter is unavailable.
+// Usage: cdrt-delay-memory-benchmark [--sample-rate HZ] [--instances N] [--block-size N] [--seconds S] [--max-delay S]
+
+namespace
+{
+using DelayEngine = cdrt::dsp::DelayEngine<float>;
+using PerfCounters = cdrt::analysis::PerfCounters;
+
+struct Options
+{
+    double sampleRate = 96000.0;
+    int numInstances = 8;
+    int blockSize = 256;
+    double seconds = 4.0;   // Audio processed by every instance for each measurement.
+    double maxDelay = 3.0;  // Size of the buffers, the delay is swept up to it.
+};
+
+struct Measurement
+{
+    double nsPerSample = 0.0;
+    bool hugePageAdvised = false;
+    std::array<double, PerfCounters::numCounters> missesPerThousand {};
+};
+
+void printUsage()
+{
+    std::cerr << "Usage: cdrt-delay-memory-benchmark [--sample-rate HZ] [--instances N] [--block-size N] [--seconds S] [--max-delay S]" << std::endl;
+}
+
+Measurement measure (const Options& options, const double delaySeconds, const bool hugePages, PerfCounters& counters)
+{
+    cdrt::utility::AlignedStorage::setHugePagesEnabled (hugePages);
+
+    const juce::dsp::ProcessSpec spec { options.sampleRate, static_cast<juce::uint32> (options.blockSize), 1 };
+    const auto maxDelaySamples = static_cast<int> (options.maxDelay * options.sampleRate) + 8;
+    // Always fractional, an integer delay would take the block copy path instead of the interpolator.
+    const auto delaySamples = static_cast<float> (juce::jlimit (1, maxDelaySamples - 8, static_cast<int> (delaySeconds * options.sampleRate))) + 0.5f;
+
+    std::vector<std::unique_ptr<DelayEngine>> instances;
+
+    for (int i = 0; i < options.numInstances; ++i)
+    {
+        instances.push_back (DelayEngine::create (DelayEngine::Interpolation::linear, spec, maxDelaySamples, true));
+        instances.back()->delayLines.front()->setDelaySamples (delaySamples);
+        instances.back()->delayLines.front()->setFeedback (0.5f);
+    }
+
+    juce::Random random (1);
+    std::vector<float> input (static_cast<size_t> (options.blockSize)), output (input.size());
+
+    for (auto& sample: input)
+        sample = 2.0f * random.nextFloat() - 1.0f;
+
+    const auto processBlocks = [&] (const int numBlocks)
+    {
+        for (int block = 0; block < numBlocks; ++block)
+            for (auto& instance: instances)
+                instance->delayLines.front()->processBlock (0, input.data(), output.data(), options.blockSize);
+    };
+
+    // A full buffer first, the read head is in written memory.
+    processBlocks (maxDelaySamples / options.blockSize + 1);
+
+    const auto numBlocks = juce::jmax (1, static_cast<int> (options.seconds * options.sampleRate) / options.blockSize);
+    const auto numSamples = static_cast<double> (numBlocks) * options.blockSize * options.numInstances;
+
+    counters.start();
+    const auto start = juce::Time::getHighResolutionTicks();
+    processBlocks (numBlocks);
+    const auto elapsed = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+    counters.stop();
+
+    Measurement measurement;
+    measurement.nsPerSample = 1.0e9 * elapsed / numSamples;
+    measurement.hugePageAdvised = instances.front()->delayLines.front()->isBufferHugePageAdvised();
+
+    for (int counter = 0; counter < PerfCounters::numCounters; ++counter)
+        measurement.missesPerThousand[static_cast<size_t> (counter)] = 1000.0 * static_cast<double> (counters.getValue (static_cast<PerfCounters::Counter> (counter))) / numSamples;
+
+    return measurement;
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto hasValue = i + 1 < argc;
+
+        if (std::strcmp (argv[i], "--sample-rate") == 0 && hasValue)
+            options.sampleRate = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--instances") == 0 && hasValue)
+            options.numInstances = std::atoi (argv[++i]);
+        else if (std::strcmp (argv[i], "--block-size") == 0 && hasValue)
+            options.blockSize = std::atoi (argv[++i]);
+        else if (std::strcmp (argv[i], "--seconds") == 0 && hasValue)
+            options.seconds = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--max-delay") == 0 && hasValue)
+            options.maxDelay = std::atof (argv[++i]);
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (options.sampleRate <= 0.0 || options.numInstances < 1 || options.blockSize < 1 || options.seconds <= 0.0 || options.maxDelay <= 0.0)
+    {
+        printUsage();
+        return 2;
+    }
+
+    PerfCounters counters;
+
+    for (int counter = 0; counter < PerfCounters::numCounters; ++counter)
+        if (! counters.isAvailable (static_cast<PerfCounters::Counter> (counter)))
+            std::cerr << "cdrt benchmark: " << PerfCounters::getName (static_cast<PerfCounters::Counter> (counter))
+                      << " unavailable (perf_event_paranoid, or no such counter)" << std::endl;
+
+    std::cout << "delay_seconds,huge_pages,huge_page_advised,ns_per_sample";
+
+    for (int counter = 0; counter < PerfCounters::numCounters; ++counter)
+        std::cout << ',' << PerfCounters::getName (static_cast<PerfCounters::Counter> (counter)) << "_per_ksample";
+
+    std::cout << std::endl;
+
+    for (const auto fraction: { 0.001, 0.01, 0.1, 0.25, 0.5, 1.0 })
+    {
+        const auto delaySeconds = fraction * options.maxDelay;
+
+        for (const auto hugePages: { false, true })
+        {
+            const auto measurement = measure (options, delaySeconds, hugePages, counters);
+            std::cout << delaySeconds << ',' << (hugePages ? 1 : 0) << ',' << (measurement.hugePageAdvised ? 1 : 0) << ',' << measurement.nsPerSample;
+
+            for (int counter = 0; counter < PerfCounters::numCounters; ++counter)
+            {
+                std::cout << ',';
+
+                if (counters.isAvailable (static_cast<PerfCounters::Counter> (counter)))
+                    std::cout << measurement.missesPerThousand[static_cast<size_t> (counter)];
+            }
+
+            std::cout << std::endl;
+        }
+    }
+
+    cdrt::utility::AlignedStorage::setHugePagesEnabled (true);
+    return 0;
+}
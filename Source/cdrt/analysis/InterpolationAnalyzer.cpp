@@ -0,0 +1,400 @@
+#include "./InterpolationAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+
+namespace cdrt
+{
+namespace analysis
+{
+//==============================================================================
+// class InterpolationAnalyzer
+
+namespace
+{
+constexpr int numInterpolations = 7;
+constexpr int timingBlockSize = 512;
+constexpr float maxTimedAmplitude = 8.0f; // Noise in [-1, 1] with a feedback of 0.5 stays well below.
+
+// True when every sample is finite and not above the amplitude a stable line can reach.
+bool isBounded (const std::vector<float>& samples, const float maxAmplitude)
+{
+    return std::all_of (samples.begin(), samples.end(), [maxAmplitude] (float sample) { return std::abs (sample) <= maxAmplitude; });
+}
+
+// Energy ratio in dB, silence is -300 dB.
+double toDecibels (const double energy, const double reference)
+{
+    return 10.0 * std::log10 (juce::jmax (energy / juce::jmax (reference, 1.0e-300), 1.0e-30));
+}
+} // namespace
+
+InterpolationAnalyzer::InterpolationAnalyzer (const Settings& newSettings)
+    : settings (newSettings)
+{
+    settings.bandLimitHz = juce::jlimit (20.0, 0.5 * settings.sampleRate, settings.bandLimitHz);
+    settings.timingSamples = juce::jmax (timingBlockSize, settings.timingSamples);
+    settings.timingRepeats = juce::jmax (1, settings.timingRepeats);
+    echoOffset = measureEchoOffset();
+}
+
+//==============================================================================
+// Analysis.
+
+std::vector<InterpolationAnalyzer::Result> InterpolationAnalyzer::analyzeAll()
+{
+    std::vector<Result> results;
+
+    for (int index = 0; index < numInterpolations; ++index)
+        results.push_back (analyze (static_cast<Interpolation> (index)));
+
+    markParetoFront (results);
+    return results;
+}
+
+InterpolationAnalyzer::Result InterpolationAnalyzer::analyze (const Interpolation interpolation)
+{
+    Result result;
+    result.interpolation = interpolation;
+    result.name = getName (interpolation);
+    result.qualityDb = -std::numeric_limits<double>::infinity();
+
+    for (const auto fraction: settings.fractions)
+    {
+        const auto measurement = measureStatic (interpolation, fraction);
+        result.qualityDb = juce::jmax (result.qualityDb, measurement.responseErrorDb, measurement.thdnDb);
+        result.staticSweep.push_back (measurement);
+    }
+
+    for (const auto rateHz: settings.modulationRatesHz)
+    {
+        const auto measurement = measureModulated (interpolation, rateHz);
+        result.qualityDb = juce::jmax (result.qualityDb, measurement.errorDb);
+        result.modulatedSweep.push_back (measurement);
+    }
+
+    measureTiming (result);
+    return result;
+}
+
+void InterpolationAnalyzer::markParetoFront (std::vector<Result>& results)
+{
+    // A result without a valid timing is left out of the front.
+    for (auto& result: results)
+    {
+        result.pareto = result.timingValid && std::none_of (results.begin(), results.end(), [&result] (const Result& other)
+        {
+            return other.timingValid && other.nsPerSample <= result.nsPerSample && other.qualityDb <= result.qualityDb
+                && (other.nsPerSample < result.nsPerSample || other.qualityDb < result.qualityDb);
+        });
+    }
+}
+
+//==============================================================================
+// Output.
+
+juce::String InterpolationAnalyzer::toCsv (const std::vector<Result>& results)
+{
+    juce::String csv ("interpolation,ns_per_sample,ns_per_sample_modulated,quality_db,worst_response_error_db,"
+                      "worst_magnitude_error_db,worst_phase_delay_error_samples,worst_thdn_db,worst_modulation_error_db,pareto\n");
+
+    for (const auto& result: results)
+    {
+        double response = -300.0, magnitude = 0.0, phaseDelay = 0.0, thdn = -300.0, modulation = -300.0;
+
+        for (const auto& measurement: result.staticSweep)
+        {
+            response = juce::jmax (response, measurement.responseErrorDb);
+            magnitude = juce::jmax (magnitude, measurement.magnitudeErrorDb);
+            phaseDelay = juce::jmax (phaseDelay, measurement.phaseDelayErrorSamples);
+            thdn = juce::jmax (thdn, measurement.thdnDb);
+        }
+
+        for (const auto& measurement: result.modulatedSweep)
+            modulation = juce::jmax (modulation, measurement.errorDb);
+
+        // An unbounded output times the overflow, not the interpolation: the timings are left empty.
+        csv << result.name << ',' << (result.timingValid ? juce::String (result.nsPerSample, 3) + ',' + juce::String (result.nsPerSampleModulated, 3) : juce::String (",")) << ','
+            << juce::String (result.qualityDb, 2) << ',' << juce::String (response, 2) << ',' << juce::String (magnitude, 4) << ','
+            << juce::String (phaseDelay, 4) << ',' << juce::String (thdn, 2) << ',' << juce::String (modulation, 2) << ','
+            << (result.pareto ? "1" : "0") << '\n';
+    }
+
+    return csv;
+}
+
+juce::String InterpolationAnalyzer::toSweepCsv (const std::vector<Result>& results)
+{
+    juce::String csv ("interpolation,measurement,fraction,rate_hz,response_error_db,magnitude_error_db,phase_delay_error_samples,thdn_db,modulation_error_db\n");
+
+    for (const auto& result: results)
+    {
+        for (const auto& measurement: result.staticSweep)
+            csv << result.name << ",static," << juce::String (measurement.fraction, 4) << ",," << juce::String (measurement.responseErrorDb, 2) << ','
+                << juce::String (measurement.magnitudeErrorDb, 4) << ',' << juce::String (measurement.phaseDelayErrorSamples, 4) << ','
+                << juce::String (measurement.thdnDb, 2) << ",\n";
+
+        for (const auto& measurement: result.modulatedSweep)
+            csv << result.name << ",modulated,," << juce::String (measurement.rateHz, 3) << ",,,,," << juce::String (measurement.errorDb, 2) << '\n';
+    }
+
+    return csv;
+}
+
+juce::String InterpolationAnalyzer::toJson (const std::vector<Result>& results, const Settings& settings)
+{
+    auto* root = new juce::DynamicObject();
+    auto* settingsObject = new juce::DynamicObject();
+    settingsObject->setProperty ("sampleRate", settings.sampleRate);
+    settingsObject->setProperty ("bandLimitHz", settings.bandLimitHz);
+    settingsObject->setProperty ("testFrequencyHz", settings.testFrequencyHz);
+    settingsObject->setProperty ("modulationDepthSamples", settings.modulationDepthSamples);
+    settingsObject->setProperty ("timingSamples", settings.timingSamples);
+    root->setProperty ("settings", juce::var (settingsObject));
+
+    juce::Array<juce::var> kernels;
+
+    for (const auto& result: results)
+    {
+        auto* kernel = new juce::DynamicObject();
+        kernel->setProperty ("interpolation", result.name);
+        kernel->setProperty ("nsPerSample", result.nsPerSample);
+        kernel->setProperty ("nsPerSampleModulated", result.nsPerSampleModulated);
+        kernel->setProperty ("qualityDb", result.qualityDb);
+        kernel->setProperty ("pareto", result.pareto);
+
+        juce::Array<juce::var> staticSweep;
+
+        for (const auto& measurement: result.staticSweep)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("fraction", measurement.fraction);
+            entry->setProperty ("responseErrorDb", measurement.responseErrorDb);
+            entry->setProperty ("magnitudeErrorDb", measurement.magnitudeErrorDb);
+            entry->setProperty ("phaseDelayErrorSamples", measurement.phaseDelayErrorSamples);
+            entry->setProperty ("thdnDb", measurement.thdnDb);
+            staticSweep.add (juce::var (entry));
+        }
+
+        juce::Array<juce::var> modulatedSweep;
+
+        for (const auto& measurement: result.modulatedSweep)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty ("rateHz", measurement.rateHz);
+            entry->setProperty ("errorDb", measurement.errorDb);
+            modulatedSweep.add (juce::var (entry));
+        }
+
+        kernel->setProperty ("static", staticSweep);
+        kernel->setProperty ("modulated", modulatedSweep);
+        kernels.add (juce::var (kernel));
+    }
+
+    root->setProperty ("interpolations", kernels);
+    return juce::JSON::toString (juce::var (root));
+}
+
+juce::String InterpolationAnalyzer::getName (const Interpolation interpolation)
+{
+    // Same names of the "interpolation" parameter choices.
+    static const juce::StringArray names { "None", "Linear", "Lagrange 3rd", "Thiran", "Thiran 2nd", "Thiran 3rd", "Thiran 4th" };
+    return names[static_cast<int> (interpolation)];
+}
+
+//==============================================================================
+// Private.
+
+std::unique_ptr<cdrt::dsp::DelayEngine<float>> InterpolationAnalyzer::createDelayLine (const Interpolation interpolation) const
+{
+    const juce::dsp::ProcessSpec spec { settings.sampleRate, static_cast<juce::uint32> (timingBlockSize), 1 };
+    auto engine = cdrt::dsp::DelayEngine<float>::create (interpolation, spec, maxDelaySamples, true);
+
+    engine->delayLines.front()->setFeedback (1.0f);
+    return engine;
+}
+
+template <typename DelayFunction>
+std::vector<double> InterpolationAnalyzer::run (const Interpolation interpolation, const std::vector<float>& input, DelayFunction&& delayOf) const
+{
+    jassert (static_cast<int> (input.size()) == runSamples);
+
+    auto engine = createDelayLine (interpolation);
+    auto& delayLine = *engine->delayLines.front();
+
+    for (int n = 0; n < runSamples; ++n)
+    {
+        delayLine.setDelaySamples (delayOf (n));
+        delayLine.processSample (0, input[static_cast<size_t> (n)]);
+    }
+
+    // Oldest first, the last runSamples samples are the whole run.
+    std::vector<float> history (static_cast<size_t> (delayLine.getMaximumDelaySamples()));
+    delayLine.copyHistory (0, history.data());
+
+    return std::vector<double> (history.end() - runSamples, history.end());
+}
+
+int InterpolationAnalyzer::measureEchoOffset() const
+{
+    std::vector<float> impulse (runSamples, 0.0f);
+    impulse[0] = 1.0f;
+
+    const auto buffer = run (Interpolation::none, impulse, [] (int) { return static_cast<float> (baseDelay); });
+    const auto peak = std::max_element (buffer.begin() + 1, buffer.end(), [] (double a, double b) { return std::abs (a) < std::abs (b); });
+
+    return static_cast<int> (peak - buffer.begin()) - baseDelay;
+}
+
+double InterpolationAnalyzer::getBurstSample (const double time) const
+{
+    if (time < 0.0 || time > burstSamples - 1)
+        return 0.0;
+
+    // Raised cosine fades, the burst is band limited enough for the analysis.
+    const auto edge = juce::jmin (time, burstSamples - 1 - time);
+    const auto fade = edge < fadeSamples ? 0.5 - 0.5 * std::cos (juce::MathConstants<double>::pi * edge / fadeSamples) : 1.0;
+
+    return fade * std::sin (juce::MathConstants<double>::twoPi * settings.testFrequencyHz * time / settings.sampleRate);
+}
+
+InterpolationAnalyzer::StaticMeasurement InterpolationAnalyzer::measureStatic (const Interpolation interpolation, const float fraction) const
+{
+    StaticMeasurement measurement;
+    measurement.fraction = fraction;
+
+    const auto delay = static_cast<float> (baseDelay) + fraction;
+    const auto delayOf = [delay] (int) { return delay; };
+
+    // Frequency response, from the echo of an impulse.
+    std::vector<float> input (runSamples, 0.0f);
+    input[0] = 1.0f;
+
+    const auto impulseBuffer = run (interpolation, input, delayOf);
+    const auto responseStart = static_cast<size_t> (baseDelay + echoOffset - responsePreSamples);
+    double errorEnergy = 0.0;
+
+    for (int index = 0; index < numResponseFrequencies; ++index)
+    {
+        // Log spaced from 20 Hz to the band limit.
+        const auto frequency = 20.0 * std::pow (settings.bandLimitHz / 20.0, index / static_cast<double> (numResponseFrequencies - 1));
+        const auto omega = juce::MathConstants<double>::twoPi * frequency / settings.sampleRate;
+
+        std::complex<double> response;
+
+        for (int k = 0; k < responseSamples; ++k)
+            response += impulseBuffer[responseStart + static_cast<size_t> (k)] * std::polar (1.0, -omega * (k - responsePreSamples));
+
+        const auto ideal = std::polar (1.0, -omega * static_cast<double> (fraction));
+        errorEnergy += std::norm (response - ideal);
+
+        measurement.magnitudeErrorDb = juce::jmax (measurement.magnitudeErrorDb, std::abs (20.0 * std::log10 (juce::jmax (std::abs (response), 1.0e-15))));
+        measurement.phaseDelayErrorSamples = juce::jmax (measurement.phaseDelayErrorSamples, std::abs (std::arg (response * std::conj (ideal)) / omega));
+    }
+
+    measurement.responseErrorDb = toDecibels (errorEnergy / numResponseFrequencies, 1.0);
+
+    // THD+N, from the echo of the sine burst.
+    for (int n = 0; n < burstSamples; ++n)
+        input[static_cast<size_t> (n)] = static_cast<float> (getBurstSample (n));
+
+    const auto sineBuffer = run (interpolation, input, delayOf);
+    double signal = 0.0, error = 0.0;
+
+    for (int n = baseDelay + echoOffset + guardSamples; n < baseDelay + echoOffset + burstSamples - guardSamples; ++n)
+    {
+        const auto reference = getBurstSample (n - echoOffset - static_cast<double> (delay));
+        signal += reference * reference;
+        error += (sineBuffer[static_cast<size_t> (n)] - reference) * (sineBuffer[static_cast<size_t> (n)] - reference);
+    }
+
+    measurement.thdnDb = toDecibels (error, signal);
+    return measurement;
+}
+
+InterpolationAnalyzer::ModulatedMeasurement InterpolationAnalyzer::measureModulated (const Interpolation interpolation, const double rateHz) const
+{
+    ModulatedMeasurement measurement;
+    measurement.rateHz = rateHz;
+
+    // Half a sample off the integer delay, every fraction is crossed.
+    const auto depth = static_cast<double> (settings.modulationDepthSamples);
+    const auto delayOf = [this, rateHz, depth] (int n)
+    {
+        return baseDelay + 0.5 + depth * std::sin (juce::MathConstants<double>::twoPi * rateHz * n / settings.sampleRate);
+    };
+
+    std::vector<float> input (runSamples, 0.0f);
+
+    for (int n = 0; n < burstSamples; ++n)
+        input[static_cast<size_t> (n)] = static_cast<float> (getBurstSample (n));
+
+    const auto buffer = run (interpolation, input, [&delayOf] (int n) { return static_cast<float> (delayOf (n)); });
+    const auto margin = static_cast<int> (std::ceil (depth)) + guardSamples;
+    double signal = 0.0, error = 0.0;
+
+    for (int n = baseDelay + echoOffset + margin; n < baseDelay + echoOffset + burstSamples - margin; ++n)
+    {
+        // The delay of the sample is the one in single precision the delay line received.
+        const auto reference = getBurstSample (n - echoOffset - static_cast<double> (static_cast<float> (delayOf (n))));
+        signal += reference * reference;
+        error += (buffer[static_cast<size_t> (n)] - reference) * (buffer[static_cast<size_t> (n)] - reference);
+    }
+
+    measurement.errorDb = toDecibels (error, signal);
+    return measurement;
+}
+
+void InterpolationAnalyzer::measureTiming (Result& result) const
+{
+    // Noise with a stable feedback, the path of the plugin: interpolation, feedback and output.
+    juce::Random random (1);
+    std::vector<float> noise (timingBlockSize), output (timingBlockSize);
+
+    for (auto& sample: noise)
+        sample = 2.0f * random.nextFloat() - 1.0f;
+
+    const auto delay = static_cast<float> (baseDelay) + 0.37f;
+    const auto numBlocks = settings.timingSamples / timingBlockSize;
+    const auto numSamples = numBlocks * timingBlockSize;
+    auto bestStatic = std::numeric_limits<double>::max();
+    auto bestModulated = std::numeric_limits<double>::max();
+    volatile float sink = 0.0f;
+
+    for (int repeat = 0; repeat < settings.timingRepeats; ++repeat)
+    {
+        auto engine = createDelayLine (result.interpolation);
+        auto& delayLine = *engine->delayLines.front();
+        delayLine.setFeedback (0.5f);
+        delayLine.setDelaySamples (delay);
+
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int block = 0; block < numBlocks; ++block)
+            delayLine.processBlock (0, noise.data(), output.data(), timingBlockSize);
+
+        bestStatic = juce::jmin (bestStatic, juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start));
+        sink = sink + output.front();
+        result.timingValid = result.timingValid && isBounded (output, maxTimedAmplitude);
+
+        start = juce::Time::getHighResolutionTicks();
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            delayLine.setDelaySamples (delay + settings.modulationDepthSamples * static_cast<float> (n % timingBlockSize) / timingBlockSize);
+            output[static_cast<size_t> (n % timingBlockSize)] = delayLine.processSample (0, noise[static_cast<size_t> (n % timingBlockSize)]);
+        }
+
+        bestModulated = juce::jmin (bestModulated, juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start));
+        sink = sink + output.front();
+        result.timingValid = result.timingValid && isBounded (output, maxTimedAmplitude);
+    }
+
+    result.nsPerSample = 1.0e9 * bestStatic / numSamples;
+    result.nsPerSampleModulated = 1.0e9 * bestModulated / numSamples;
+}
+
+} // namespace analysis
+} // namespace cdrt
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include "../dsp/DelayEngine.h"
+
+#include <vector>
+
+namespace cdrt
+{
+namespace analysis
+{
+
+// Quality and cost of the interpolations of the delay lines, to choose the defaults and the
+// levels of the auto quality mode from measurements.
+// The output of a delay line reads the integer delay, the interpolation is applied to the
+// feedback: every measurement runs a burst through the delay line with a feedback of 1 and
+// reads its first echo back from the circular buffer (the second one comes after the end
+// of the analysis). The echo is compared with the burst delayed exactly, computed in double.
+class InterpolationAnalyzer
+{
+public:
+    using Interpolation = cdrt::dsp::DelayEngine<float>::Interpolation;
+
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        double bandLimitHz = 16000.0;             // Highest frequency of the response error.
+        double testFrequencyHz = 1000.0;          // Sine of the THD+N and modulation measurements.
+        float modulationDepthSamples = 4.0f;      // Peak deviation of the modulated delay.
+        std::vector<float> fractions { 0.0f, 0.125f, 0.25f, 0.375f, 0.5f, 0.625f, 0.75f, 0.875f };
+        std::vector<double> modulationRatesHz { 0.5, 2.0, 8.0 };
+        int timingSamples = 1 << 18;
+        int timingRepeats = 5;                    // The fastest run is kept.
+    };
+
+    // Static fractional delay, errors relative to the burst delayed exactly.
+    struct StaticMeasurement
+    {
+        float fraction = 0.0f;
+        double responseErrorDb = 0.0;             // Mean energy of the complex response error up to the band limit.
+        double magnitudeErrorDb = 0.0;            // Largest magnitude deviation up to the band limit.
+        double phaseDelayErrorSamples = 0.0;      // Largest phase delay deviation up to the band limit.
+        double thdnDb = 0.0;                      // Error energy over signal energy with the test sine.
+    };
+
+    // Delay modulated by a sine, error of the test sine relative to the exactly modulated one: the sidebands
+    // the interpolation adds (and the modulation it misses).
+    struct ModulatedMeasurement
+    {
+        double rateHz = 0.0;
+        double errorDb = 0.0;
+    };
+
+    struct Result
+    {
+        Interpolation interpolation = Interpolation::linear;
+        juce::String name;
+        std::vector<StaticMeasurement> staticSweep;
+        std::vector<ModulatedMeasurement> modulatedSweep;
+        double nsPerSample = 0.0;                 // processBlock with a static fractional delay.
+        double nsPerSampleModulated = 0.0;        // processSample with a new delay on every sample.
+        double qualityDb = 0.0;                   // Worst error of the sweeps, lower is better.
+        bool timingValid = true;                  // The timed output stayed bounded, else the timings are not reported.
+        bool pareto = false;                      // No other interpolation is both cheaper and better.
+    };
+
+    //==========================================================================
+    // Constructor.
+
+    /**
+     * @brief Construct a new InterpolationAnalyzer object.
+     *
+     * @param newSettings: sweeps and measurement settings.
+     */
+    explicit InterpolationAnalyzer (const Settings& newSettings);
+
+    //==========================================================================
+    // Analysis.
+
+    /**
+     * @brief This method measures every interpolation and marks the Pareto front of quality against cost.
+     * @return std::vector<Result>: one result for each interpolation, in the order of the "interpolation" parameter.
+     */
+    std::vector<Result> analyzeAll();
+
+    /**
+     * @brief This method measures one interpolation, the Pareto flag is left unset.
+     *
+     * @param interpolation: interpolation to measure.
+     * @return Result
+     */
+    Result analyze (const Interpolation interpolation);
+
+    /**
+     * @brief This function sets the Pareto flag of the results on the front of qualityDb against nsPerSample.
+     *
+     * @param results: results to mark.
+     */
+    static void markParetoFront (std::vector<Result>& results);
+
+    //==========================================================================
+    // Output.
+
+    /**
+     * @brief This function formats the results as a CSV table, one row for each interpolation.
+     *
+     * @param results: results to format.
+     * @return juce::String
+     */
+    static juce::String toCsv (const std::vector<Result>& results);
+
+    /**
+     * @brief This function formats the results as a CSV table, one row for each measurement of the sweeps.
+     *
+     * @param results: results to format.
+     * @return juce::String
+     */
+    static juce::String toSweepCsv (const std::vector<Result>& results);
+
+    /**
+     * @brief This function formats the results and the settings as JSON, sweeps included.
+     *
+     * @param results: results to format.
+     * @param settings: settings of the analysis.
+     * @return juce::String
+     */
+    static juce::String toJson (const std::vector<Result>& results, const Settings& settings);
+
+    /**
+     * @brief This function gets the name of an interpolation, as in the "interpolation" parameter.
+     *
+     * @param interpolation: interpolation.
+     * @return juce::String
+     */
+    static juce::String getName (const Interpolation interpolation);
+
+private:
+    // Layout of the runs: the burst starts at 0, its echo around baseDelay and the second
+    // echo after the end of the run.
+    static constexpr int maxDelaySamples = 1 << 17;
+    static constexpr int baseDelay = 57344;
+    static constexpr int burstSamples = 49152;
+    static constexpr int runSamples = baseDelay + burstSamples + 4096;
+    static constexpr int responseSamples = 4096;  // Length of the echo of the impulse used for the response.
+    static constexpr int responsePreSamples = 16; // Samples of the response window before the nominal delay.
+    static constexpr int fadeSamples = 1024;      // Fades of the sine bursts.
+    static constexpr int guardSamples = 2048;     // Edges of the echo left out of the sine measurements.
+    static constexpr int numResponseFrequencies = 64;
+
+    /**
+     * @brief This method builds a delay line with the interpolation, feedback 1 and an empty buffer.
+     *
+     * @param interpolation: interpolation of the delay line.
+     * @return std::unique_ptr<cdrt::dsp::DelayEngine<float>>: engine owning the delay line.
+     */
+    std::unique_ptr<cdrt::dsp::DelayEngine<float>> createDelayLine (const Interpolation interpolation) const;
+
+    /**
+     * @brief This method processes the input sample by sample and gets the content of the buffer.
+     *
+     * @param interpolation: interpolation of the delay line.
+     * @param input: runSamples samples.
+     * @param delayOf: delay of every sample.
+     * @return std::vector<double>: the buffer at the end of the run, the sample of time n at index n.
+     */
+    template <typename DelayFunction>
+    std::vector<double> run (const Interpolation interpolation, const std::vector<float>& input, DelayFunction&& delayOf) const;
+
+    /**
+     * @brief This method measures the position of the echo of an integer delay without interpolation.
+     * The echo lands a constant number of samples away from the delay, removed from every measurement.
+     *
+     * @return int
+     */
+    int measureEchoOffset() const;
+
+    /**
+     * @brief This method gets a sample of the test sine burst, exact at any time.
+     *
+     * @param time: time expressed in samples from the beginning of the burst.
+     * @return double
+     */
+    double getBurstSample (const double time) const;
+
+    /**
+     * @brief This method measures the response and the THD+N of a static fractional delay.
+     *
+     * @param interpolation: interpolation to measure.
+     * @param fraction: fractional part of the delay.
+     * @return StaticMeasurement
+     */
+    StaticMeasurement measureStatic (const Interpolation interpolation, const float fraction) const;
+
+    /**
+     * @brief This method measures the error of the test sine through a delay modulated by a sine.
+     *
+     * @param interpolation: interpolation to measure.
+     * @param rateHz: frequency of the modulation.
+     * @return ModulatedMeasurement
+     */
+    ModulatedMeasurement measureModulated (const Interpolation interpolation, const double rateHz) const;
+
+    /**
+     * @brief This method times the delay line with a static and a modulated delay, the fastest run is kept.
+     *
+     * @param result: result receiving the costs, its interpolation is the one timed.
+     */
+    void measureTiming (Result& result) const;
+
+    Settings settings;
+    int echoOffset = 0;
+}; // class InterpolationAnalyzer
+
+} // namespace analysis
+} // namespace cdrt
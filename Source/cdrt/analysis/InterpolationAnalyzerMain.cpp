@@ -0,0 +1,85 @@
+#include "./InterpolationAnalyzer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Quality against cost of the interpolations of the delay lines, see InterpolationAnalyzer.
+// Usage: cdrt-interpolation-analyzer [--sample-rate HZ] [--band-limit HZ] [--frequency HZ] [--depth SAMPLES]
+//                                    [--csv PATH] [--sweep-csv PATH] [--json PATH]
+// Without an output path the table of the interpolations is printed as CSV.
+
+namespace
+{
+void printUsage()
+{
+    std::cerr << "Usage: cdrt-interpolation-analyzer [--sample-rate HZ] [--band-limit HZ] [--frequency HZ] [--depth SAMPLES]"
+                 " [--csv PATH] [--sweep-csv PATH] [--json PATH]" << std::endl;
+}
+
+bool write (const char* path, const juce::String& content)
+{
+    if (juce::File (juce::File::getCurrentWorkingDirectory().getChildFile (path)).replaceWithText (content))
+        return true;
+
+    std::cerr << "cdrt analyzer: can't write " << path << std::endl;
+    return false;
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    cdrt::analysis::InterpolationAnalyzer::Settings settings;
+    const char* csvPath = nullptr;
+    const char* sweepCsvPath = nullptr;
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto hasValue = i + 1 < argc;
+
+        if (std::strcmp (argv[i], "--sample-rate") == 0 && hasValue)
+            settings.sampleRate = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--band-limit") == 0 && hasValue)
+            settings.bandLimitHz = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--frequency") == 0 && hasValue)
+            settings.testFrequencyHz = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--depth") == 0 && hasValue)
+            settings.modulationDepthSamples = static_cast<float> (std::atof (argv[++i]));
+        else if (std::strcmp (argv[i], "--csv") == 0 && hasValue)
+            csvPath = argv[++i];
+        else if (std::strcmp (argv[i], "--sweep-csv") == 0 && hasValue)
+            sweepCsvPath = argv[++i];
+        else if (std::strcmp (argv[i], "--json") == 0 && hasValue)
+            jsonPath = argv[++i];
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    if (settings.sampleRate <= 0.0 || settings.testFrequencyHz <= 0.0 || settings.modulationDepthSamples < 0.0f)
+    {
+        printUsage();
+        return 2;
+    }
+
+    cdrt::analysis::InterpolationAnalyzer analyzer (settings);
+    const auto results = analyzer.analyzeAll();
+    auto succeeded = true;
+
+    if (csvPath == nullptr && sweepCsvPath == nullptr && jsonPath == nullptr)
+        std::cout << cdrt::analysis::InterpolationAnalyzer::toCsv (results);
+
+    if (csvPath != nullptr)
+        succeeded = write (csvPath, cdrt::analysis::InterpolationAnalyzer::toCsv (results)) && succeeded;
+
+    if (sweepCsvPath != nullptr)
+        succeeded = write (sweepCsvPath, cdrt::analysis::InterpolationAnalyzer::toSweepCsv (results)) && succeeded;
+
+    if (jsonPath != nullptr)
+        succeeded = write (jsonPath, cdrt::analysis::InterpolationAnalyzer::toJson (results, settings)) && succeeded;
+
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include "./PerfCounters.h"
+
+#if defined(__linux__)
+ #include <linux/perf_event.h>
+ #include <sys/ioctl.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace cdrt
+{
+namespace analysis
+{
+//==============================================================================
+// class PerfCounters
+
+namespace
+{
+#if defined(__linux__)
+// Read misses of a cache, encoded as perf_event_open expects them.
+constexpr uint64_t getCacheReadMisses (const uint64_t cache) noexcept
+{
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+int openCounter (const uint32_t type, const uint64_t config) noexcept
+{
+    perf_event_attr attributes {};
+    attributes.size = sizeof (attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    return static_cast<int> (::syscall (SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+}
+#endif
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+    descriptors.fill (-1);
+
+   #if defined(__linux__)
+    descriptors[dtlbLoadMisses] = openCounter (PERF_TYPE_HW_CACHE, getCacheReadMisses (PERF_COUNT_HW_CACHE_DTLB));
+    descriptors[cacheMisses] = openCounter (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    descriptors[llcLoadMisses] = openCounter (PERF_TYPE_HW_CACHE, getCacheReadMisses (PERF_COUNT_HW_CACHE_LL));
+   #endif
+}
+
+PerfCounters::~PerfCounters()
+{
+   #if defined(__linux__)
+    for (const auto descriptor: descriptors)
+        if (descriptor >= 0)
+            ::close (descriptor);
+   #endif
+}
+
+//==============================================================================
+// Counting.
+
+void PerfCounters::start() noexcept
+{
+    values.fill (0);
+
+   #if defined(__linux__)
+    for (const auto descriptor: descriptors)
+    {
+        if (descriptor >= 0)
+        {
+            ::ioctl (descriptor, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl (descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+   #endif
+}
+
+void PerfCounters::stop() noexcept
+{
+   #if defined(__linux__)
+    for (size_t counter = 0; counter < descriptors.size(); ++counter)
+    {
+        if (descriptors[counter] < 0)
+            continue;
+
+        ::ioctl (descriptors[counter], PERF_EVENT_IOC_DISABLE, 0);
+
+        if (::read (descriptors[counter], &values[counter], sizeof (uint64_t)) != static_cast<ssize_t> (sizeof (uint64_t)))
+            values[counter] = 0;
+    }
+   #endif
+}
+
+//==============================================================================
+// Getters.
+
+bool PerfCounters::isAvailable (const Counter counter) const noexcept
+{
+    return descriptors[static_cast<size_t> (counter)] >= 0;
+}
+
+uint64_t PerfCounters::getValue (const Counter counter) const noexcept
+{
+    return values[static_cast<size_t> (counter)];
+}
+
+const char* PerfCounters::getName (const Counter counter) noexcept
+{
+    switch (counter)
+    {
+        case dtlbLoadMisses: return "dTLB-load-misses";
+        case cacheMisses:    return "cache-misses";
+        case llcLoadMisses:  return "LLC-load-misses";
+        case numCounters:    break;
+    }
+
+    return "";
+}
+
+} // namespace analysis
+} // namespace cdrt
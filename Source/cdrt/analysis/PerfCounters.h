@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace cdrt
+{
+namespace analysis
+{
+
+// Hardware counters of the calling thread (user space only) for the benchmarks, through
+// perf_event_open on Linux. A counter the system doesn't allow (see perf_event_paranoid)
+// or doesn't have is unavailable, on the other platforms every counter is.
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        dtlbLoadMisses,
+        cacheMisses,
+        llcLoadMisses,
+        numCounters
+    };
+
+    //==========================================================================
+    // Constructor.
+
+    /**
+     * @brief Construct a new PerfCounters object, opens the counters stopped.
+     */
+    PerfCounters();
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * PerfCounters destructor, closes the counters.
+     */
+    ~PerfCounters();
+
+    PerfCounters (const PerfCounters&) = delete;
+    PerfCounters& operator= (const PerfCounters&) = delete;
+
+    //==========================================================================
+    // Counting.
+
+    /**
+     * @brief This method resets the counters and starts counting.
+     */
+    void start() noexcept;
+
+    /**
+     * @brief This method stops counting, the values are kept until the next start.
+     */
+    void stop() noexcept;
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method tells if a counter could be opened.
+     *
+     * @param counter: counter.
+     * @return bool
+     */
+    bool isAvailable (const Counter counter) const noexcept;
+
+    /**
+     * @brief This method gets the events counted between the last start and stop.
+     *
+     * @param counter: counter.
+     * @return uint64_t: 0 when the counter is unavailable.
+     */
+    uint64_t getValue (const Counter counter) const noexcept;
+
+    /**
+     * @brief This function gets the name of a counter, as in the perf tool.
+     *
+     * @param counter: counter.
+     * @return const char*
+     */
+    static const char* getName (const Counter counter) noexcept;
+
+private:
+    std::array<int, numCounters> descriptors;
+    std::array<uint64_t, numCounters> values {};
+}; // class PerfCounters
+
+} // namespace analysis
+} // namespace cdrt
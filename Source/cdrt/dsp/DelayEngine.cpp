@@ -0,0 +1,411 @@
+#include "./DelayEngine.h"
+#include "../utility/Interpolation.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// struct DelayEngine
+
+template <typename SampleType>
+std::unique_ptr<DelayEngine<SampleType>> DelayEngine<SampleType>::create (const Interpolation interpolation, const juce::dsp::ProcessSpec& spec, const int maxDelaySamples, const bool monoInput)
+{
+    auto engine = std::make_unique<DelayEngine>();
+    engine->interpolation = interpolation;
+
+    // Every delay line stores one channel.
+    auto delayLineSpec = spec;
+    delayLineSpec.numChannels = 1;
+
+    for (int i = 0; i < (monoInput ? 1 : 2); ++i)
+    {
+        std::shared_ptr<DelayLineBase<SampleType>> delayLine;
+
+        switch (interpolation)
+        {
+            case Interpolation::none:        delayLine = std::make_shared<DelayLineNone<SampleType>>(); break;
+            case Interpolation::linear:      delayLine = std::make_shared<DelayLineLinear<SampleType>>(); break;
+            case Interpolation::lagrange3rd: delayLine = std::make_shared<DelayLineLagrange3rd<SampleType>>(); break;
+            case Interpolation::thiran:      delayLine = std::make_shared<DelayLineThiran<SampleType>>(); break;
+            case Interpolation::thiran2nd:   delayLine = std::make_shared<DelayLineThiran<SampleType>> (2); break;
+            case Interpolation::thiran3rd:   delayLine = std::make_shared<DelayLineThiran<SampleType>> (3); break;
+            case Interpolation::thiran4th:   delayLine = std::make_shared<DelayLineThiran<SampleType>> (4); break;
+        }
+
+        delayLine->setMaxDelaySamples (maxDelaySamples);
+        delayLine->prepare (delayLineSpec);
+        engine->delayLines.push_back (delayLine);
+    }
+
+    if (monoInput)
+        engine->router = std::make_unique<DelayLineRoutingMonoToStereo<SampleType>>();
+    else
+        engine->router = std::make_unique<DelayLineRoutingStraight<SampleType>>();
+
+    engine->router->prepare (engine->delayLines);
+
+    return engine;
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::copyFrom (const DelayEngine& other, const int startIndex, const int numSamples)
+{
+    jassert (other.delayLines.size() == delayLines.size());
+
+    for (size_t i = 0; i < delayLines.size(); ++i)
+        delayLines[i]->copyFrom (*other.delayLines[i], startIndex, numSamples);
+}
+
+template <typename SampleType>
+void DelayEngine<SampleType>::resampleFrom (const DelayEngine& other, const double ratio)
+{
+    jassert (other.delayLines.size() == delayLines.size() && ratio > 0.0);
+
+    for (size_t i = 0; i < delayLines.size(); ++i)
+    {
+        const auto sourceSize = other.delayLines[i]->getMaximumDelaySamples();
+        std::vector<SampleType> source (static_cast<size_t> (sourceSize));
+        other.delayLines[i]->copyHistory (0, source.data());
+
+        // The newest sample of the source is kept as the newest of the destination.
+        const auto destinationSize = juce::jmin (static_cast<int> (static_cast<double> (sourceSize) * ratio), delayLines[i]->getMaximumDelaySamples());
+        std::vector<SampleType> destination (static_cast<size_t> (destinationSize));
+
+        for (int j = 0; j < destinationSize; ++j)
+        {
+            const auto position = static_cast<double> (sourceSize - 1) - static_cast<double> (destinationSize - 1 - j) / ratio;
+            const auto index = juce::jlimit (0, sourceSize - 1, static_cast<int> (position));
+            const auto next = juce::jmin (index + 1, sourceSize - 1);
+            const auto frac = static_cast<float> (position - static_cast<double> (index));
+
+            destination[static_cast<size_t> (j)] = cdrt::utility::interpolation::linear (source[static_cast<size_t> (index)], source[static_cast<size_t> (next)], frac);
+        }
+
+        delayLines[i]->setHistory (0, destination.data(), destinationSize);
+    }
+}
+
+template struct DelayEngine<float>;
+template struct DelayEngine<double>;
+
+
+//==============================================================================
+// class DelayEngineManager
+
+template <typename SampleType>
+DelayEngineManager<SampleType>::DelayEngineManager()
+    : juce::Thread ("cdrt delay engine builder")
+{
+}
+
+template <typename SampleType>
+DelayEngineManager<SampleType>::~DelayEngineManager()
+{
+    stopThread (1000);
+
+    for (auto* engine: { &active, &pending, &retired })
+        delete engine->exchange (nullptr);
+
+    delete fading;
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+typename DelayEngineManager<SampleType>::Preparation DelayEngineManager<SampleType>::prepare (const juce::dsp::ProcessSpec& newSpec, const int newMaxDelaySamples, const bool newMonoInput, const Interpolation interpolation)
+{
+    auto preparation = Preparation::rebuilt;
+
+    {
+        const juce::ScopedLock sl (buildLock);
+
+        // A swap in progress is dropped, the background thread builds the requested engine again.
+        delete pending.exchange (nullptr);
+        delete retired.exchange (nullptr);
+        delete fading;
+        fading = nullptr;
+        swapCrossfadeRemaining = 0;
+        priming = nullptr;
+
+        std::unique_ptr<DelayEngine<SampleType>> current (active.exchange (nullptr));
+
+        const auto sameLayout = current != nullptr
+                             && newMaxDelaySamples == maxDelaySamples
+                             && newMonoInput == monoInput
+                             && newSpec.numChannels == spec.numChannels;
+
+        const auto sameSampleRate = juce::approximatelyEqual (newSpec.sampleRate, spec.sampleRate);
+
+        if (sameLayout && sameSampleRate)
+        {
+            // Only the block size can differ, it is used just to count the samples to copy on a swap.
+            // A different interpolation is built in background keeping the content.
+            preparation = Preparation::reused;
+        }
+        else
+        {
+            auto next = DelayEngine<SampleType>::create (interpolation, newSpec, newMaxDelaySamples, newMonoInput);
+
+            if (current != nullptr && ! sameSampleRate && resampleOnSampleRateChange
+                && newMonoInput == monoInput && spec.sampleRate > 0.0)
+            {
+                next->resampleFrom (*current, newSpec.sampleRate / spec.sampleRate);
+                preparation = Preparation::resampled;
+            }
+
+            current = std::move (next);
+        }
+
+        spec = newSpec;
+        maxDelaySamples = newMaxDelaySamples;
+        monoInput = newMonoInput;
+
+        requestedInterpolation = static_cast<int> (interpolation);
+
+        active.store (current.release());
+    }
+
+    if (! isThreadRunning())
+        startThread (juce::Thread::Priority::background);
+
+    return preparation;
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::reset() noexcept
+{
+    for (auto& delayLine: active.load (std::memory_order_relaxed)->delayLines)
+        delayLine->reset();
+
+    // The old engine is released by the next block, the copy to a pending engine starts over.
+    swapCrossfadeRemaining = 0;
+    priming = nullptr;
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::requestInterpolation (const Interpolation interpolation) noexcept
+{
+    requestedInterpolation = static_cast<int> (interpolation);
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::setSwapCrossfadeSamples (const int newSwapCrossfadeSamples) noexcept
+{
+    jassert (newSwapCrossfadeSamples >= 0);
+
+    swapCrossfadeSamples = newSwapCrossfadeSamples;
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::setResampleOnSampleRateChange (const bool shouldResample) noexcept
+{
+    resampleOnSampleRateChange = shouldResample;
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::setDelayTime (const int output, const float delayTime)
+{
+    active.load (std::memory_order_relaxed)->router->setDelayTime (output, delayTime);
+
+    if (fading != nullptr)
+        fading->router->setDelayTime (output, delayTime);
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::setFeedback (const int output, const float feedback)
+{
+    active.load (std::memory_order_relaxed)->router->setFeedback (output, feedback);
+
+    if (fading != nullptr)
+        fading->router->setFeedback (output, feedback);
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::setFeedbackFilter (const float lowCut, const float highCut, const float tilt)
+{
+    for (auto* engine: { active.load (std::memory_order_relaxed), fading })
+        if (engine != nullptr)
+            for (auto& delayLine: engine->delayLines)
+                delayLine->setFeedbackFilter (lowCut, highCut, tilt);
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::setFeedbackSaturation (const typename Saturation<SampleType>::Shape shape, const float drive)
+{
+    for (auto* engine: { active.load (std::memory_order_relaxed), fading })
+        if (engine != nullptr)
+            for (auto& delayLine: engine->delayLines)
+                delayLine->setFeedbackSaturation (shape, drive);
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+DelayEngine<SampleType>* DelayEngineManager<SampleType>::getActiveEngine() noexcept
+{
+    return active.load (std::memory_order_acquire);
+}
+
+template <typename SampleType>
+bool DelayEngineManager<SampleType>::isCrossfading() const noexcept
+{
+    return fading != nullptr && swapCrossfadeRemaining > 0;
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+DelayEngine<SampleType>& DelayEngineManager<SampleType>::beginBlock (const int numSamples) noexcept
+{
+    auto* current = active.load (std::memory_order_relaxed);
+
+    // The old engine can be released only when the previous one has been deleted.
+    if (fading != nullptr && swapCrossfadeRemaining <= 0 && retired.load (std::memory_order_acquire) == nullptr)
+    {
+        retired.store (fading, std::memory_order_release);
+        fading = nullptr;
+    }
+
+    if (fading == nullptr && retired.load (std::memory_order_acquire) == nullptr)
+    {
+        // The pending engine stays published until the swap, the background thread builds nothing meanwhile.
+        auto* next = pending.load (std::memory_order_acquire);
+
+        if (next != nullptr && primeEngine (*current, *next, numSamples))
+        {
+            // Active first, the background thread finding no pending engine sees the new active one.
+            active.store (next, std::memory_order_release);
+            pending.store (nullptr, std::memory_order_release);
+
+            if (swapCrossfadeSamples > 0)
+            {
+                fading = current;
+                swapCrossfadeRemaining = swapCrossfadeSamples;
+            }
+            else
+            {
+                retired.store (current, std::memory_order_release);
+            }
+
+            current = next;
+        }
+    }
+
+    for (auto* engine: { current, fading })
+        if (engine != nullptr)
+            for (auto& delayLine: engine->delayLines)
+                delayLine->updateFeedbackFilter (numSamples);
+
+    return *current;
+}
+
+template <typename SampleType>
+bool DelayEngineManager<SampleType>::primeEngine (DelayEngine<SampleType>& current, DelayEngine<SampleType>& next, const int numSamples) noexcept
+{
+    if (priming != &next)
+    {
+        priming = &next;
+        primingStartIndex = current.delayLines[0]->getWriteIndex (0);
+        primingCopied = 0;
+        primingWritten = 0;
+    }
+
+    // Everything up to the write head, one lap after the start. The slice is longer than the block,
+    // the copy gains on the head at every block. Every copy takes the pointers and the settings too.
+    const auto size = static_cast<juce::int64> (maxDelaySamples);
+    const auto slice = juce::jmin (primingWritten + size - primingCopied, static_cast<juce::int64> (numSamples + primingSliceSamples));
+    const auto startIndex = static_cast<int> ((primingStartIndex + primingCopied) % juce::jmax (size, static_cast<juce::int64> (1)));
+
+    next.copyFrom (current, startIndex, static_cast<int> (slice));
+    primingCopied += slice;
+
+    if (primingCopied < primingWritten + size)
+    {
+        primingWritten += numSamples;
+        return false;
+    }
+
+    priming = nullptr;
+    return true;
+}
+
+template <typename SampleType>
+SampleType* DelayEngineManager<SampleType>::processSamples (SampleType* samples)
+{
+    auto* current = active.load (std::memory_order_relaxed);
+
+    if (fading == nullptr || swapCrossfadeRemaining <= 0)
+        return current->router->processSamples (samples);
+
+    // The old engine keeps processing the same input until the end of the crossfade.
+    SampleType fadingSamples[2] = { samples[0], samples[1] };
+
+    current->router->processSamples (samples);
+    fading->router->processSamples (fadingSamples);
+
+    // The engines output almost the same signal, the gains must sum to 1.
+    const auto gain = static_cast<SampleType> (swapCrossfadeRemaining) / static_cast<SampleType> (swapCrossfadeSamples);
+    --swapCrossfadeRemaining;
+
+    for (int channel = 0; channel < 2; ++channel)
+        samples[channel] += gain * (fadingSamples[channel] - samples[channel]);
+
+    return samples;
+}
+
+//==============================================================================
+// Background thread.
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::run()
+{
+    while (! threadShouldExit())
+    {
+        collectGarbage();
+        buildRequestedEngine();
+
+        wait (50);
+    }
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::buildRequestedEngine()
+{
+    const juce::ScopedLock sl (buildLock);
+
+    // While an engine is waiting to be swapped or deleted the active one can't change.
+    if (pending.load (std::memory_order_acquire) != nullptr || retired.load (std::memory_order_acquire) != nullptr)
+        return;
+
+    auto* current = active.load (std::memory_order_acquire);
+
+    if (current == nullptr)
+        return;
+
+    const auto interpolation = static_cast<Interpolation> (requestedInterpolation.load());
+
+    if (interpolation == current->interpolation)
+        return;
+
+    // Empty, the audio thread copies the content of the active engine.
+    auto next = DelayEngine<SampleType>::create (interpolation, spec, maxDelaySamples, monoInput);
+    pending.store (next.release(), std::memory_order_release);
+}
+
+template <typename SampleType>
+void DelayEngineManager<SampleType>::collectGarbage()
+{
+    delete retired.exchange (nullptr, std::memory_order_acq_rel);
+}
+
+template class DelayEngineManager<float>;
+template class DelayEngineManager<double>;
+} // namespace dsp
+} // namespace cdrt
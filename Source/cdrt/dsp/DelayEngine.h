@@ -0,0 +1,285 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include "./DelayLine.h"
+#include "./DelayLineRouting.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Delay lines and the router using them, built together for one interpolation type.
+template <typename SampleType>
+struct DelayEngine
+{
+    // Interpolation types, same order of the "interpolation" parameter choices.
+    enum class Interpolation
+    {
+        none,
+        linear,
+        lagrange3rd,
+        thiran,
+        thiran2nd,
+        thiran3rd,
+        thiran4th
+    };
+
+    /**
+     * @brief This function builds and prepares a new engine.
+     *
+     * @param interpolation: interpolation used by every delay line.
+     * @param spec: context informations for processor, the delay lines use one channel each.
+     * @param maxDelaySamples: maximum delay of the delay lines.
+     * @param monoInput: true to use one delay line with two taps (mono to stereo routing), false for two delay lines.
+     * @return std::unique_ptr<DelayEngine>
+     */
+    static std::unique_ptr<DelayEngine> create (const Interpolation interpolation, const juce::dsp::ProcessSpec& spec, const int maxDelaySamples, const bool monoInput);
+
+    /**
+     * @brief This method copies a section of the delay lines content and all their settings from another engine with the same layout.
+     *
+     * @param other: engine to copy from.
+     * @param startIndex: index of the first sample to copy in every delay line.
+     * @param numSamples: number of samples to copy.
+     */
+    void copyFrom (const DelayEngine& other, const int startIndex, const int numSamples);
+
+    /**
+     * @brief This method fills the delay lines with the content of an engine running at another sample rate.
+     * The history is resampled with linear interpolation, it allocates and must not be called while processing.
+     *
+     * @param other: engine to copy from, with the same number of delay lines.
+     * @param ratio: sample rate of this engine divided by the sample rate of the other one.
+     */
+    void resampleFrom (const DelayEngine& other, const double ratio);
+
+    Interpolation interpolation = Interpolation::linear;
+    std::vector<std::shared_ptr<cdrt::dsp::DelayLineBase<SampleType>>> delayLines;
+    std::unique_ptr<cdrt::dsp::DelayLineRoutingBase<SampleType>> router;
+}; // struct DelayEngine
+
+// Owner of the active delay engine allowing to change interpolation while processing.
+// A background thread builds the new engine, empty, and publishes it through an atomic
+// pointer: it never reads the delay lines the audio thread is writing. At the beginning
+// of every block the audio thread copies a slice of the active engine into the new one,
+// at most primingSliceSamples more than the block writes, then swaps the engines without
+// locks once the copy caught up with the write head. The old engine is deleted by the
+// background thread. If a swap crossfade is set the old engine keeps running until the crossfade ends.
+template <typename SampleType>
+class DelayEngineManager : private juce::Thread
+{
+public:
+    using Interpolation = typename DelayEngine<SampleType>::Interpolation;
+
+    // Samples copied to a new engine by every block on top of the samples the block writes.
+    static constexpr int primingSliceSamples = 8192;
+
+    // What prepare did with the active engine.
+    enum class Preparation
+    {
+        rebuilt,   // New engine with empty delay lines.
+        reused,    // Same sample rate and layout, the engine and its content are kept.
+        resampled  // New engine filled with the old content resampled to the new sample rate.
+    };
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new DelayEngineManager object.
+     */
+    DelayEngineManager();
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * DelayEngineManager destructor, stops the background thread and deletes every engine.
+     */
+    ~DelayEngineManager() override;
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief This method prepares the active engine, it must not be called while processing.
+     * The new settings are compared with the current ones: when only the block size changed the
+     * engine is kept as it is, without allocating and without clearing the echo tail. A different
+     * interpolation is then built in background like any other request.
+     *
+     * @param spec: context informations for processor.
+     * @param maxDelaySamples: maximum delay of the delay lines.
+     * @param monoInput: true to use the mono to stereo routing.
+     * @param interpolation: interpolation of the delay lines.
+     * @return Preparation
+     */
+    Preparation prepare (const juce::dsp::ProcessSpec& spec, const int maxDelaySamples, const bool monoInput, const Interpolation interpolation);
+
+    /**
+     * @brief This method clears the delay lines of the active engine and stops a swap crossfade, the settings are kept.
+     * Call it from the audio thread or while the audio thread is not processing, a pending engine is copied again.
+     */
+    void reset() noexcept;
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method asks for a different interpolation, the engine is built in background.
+     * It can be called from any thread, the audio thread included, requests are checked every 50 ms.
+     *
+     * @param interpolation: new interpolation.
+     */
+    void requestInterpolation (const Interpolation interpolation) noexcept;
+
+    /**
+     * @brief This method sets the length of the crossfade between the old and the new engine after a swap.
+     * Call it from the audio thread or while it is not processing.
+     *
+     * @param newSwapCrossfadeSamples: length of the crossfade in samples, 0 to swap instantly.
+     */
+    void setSwapCrossfadeSamples (const int newSwapCrossfadeSamples) noexcept;
+
+    /**
+     * @brief This method sets whether the content of the delay lines survives a sample rate change.
+     * The new engine is filled with the old content resampled, otherwise it starts empty.
+     *
+     * @param shouldResample: true to resample the content on the next prepare with a different sample rate.
+     */
+    void setResampleOnSampleRateChange (const bool shouldResample) noexcept;
+
+    /**
+     * @brief This method sets the delay time of one output of the active engine, and of the old one during a swap crossfade.
+     *
+     * @param output: index of the output channel.
+     * @param delayTime: delay expressed in milliseconds.
+     */
+    void setDelayTime (const int output, const float delayTime);
+
+    /**
+     * @brief This method sets the feedback of one output of the active engine, and of the old one during a swap crossfade.
+     *
+     * @param output: index of the output channel.
+     * @param feedback: amount of feedback.
+     */
+    void setFeedback (const int output, const float feedback);
+
+    /**
+     * @brief This method sets the tone of the repeats of every delay line, see DelayLineBase::setFeedbackFilter.
+     * The smoothing moves forward in beginBlock.
+     *
+     * @param lowCut: cutoff of the highpass expressed in Hz.
+     * @param highCut: cutoff of the lowpass expressed in Hz.
+     * @param tilt: gain of the high frequencies over the low ones expressed in dB.
+     */
+    void setFeedbackFilter (const float lowCut, const float highCut, const float tilt);
+
+    /**
+     * @brief This method sets the saturation of the repeats of every delay line, see DelayLineBase::setFeedbackSaturation.
+     *
+     * @param shape: shaping function.
+     * @param drive: drive normalised in [0, 1], 0 disables the saturation.
+     */
+    void setFeedbackSaturation (const typename Saturation<SampleType>::Shape shape, const float drive);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the active engine.
+     * It is safe to call it from the audio thread, or from other threads while the audio thread is not processing.
+     *
+     * @return DelayEngine<SampleType>*
+     */
+    DelayEngine<SampleType>* getActiveEngine() noexcept;
+
+    /**
+     * @brief This method tells whether the old engine is still processing after a swap.
+     * While it is, the delay lines must be processed through processSamples. Call it from the audio thread.
+     *
+     * @return bool
+     */
+    bool isCrossfading() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief Call this method from the audio thread at the beginning of every block.
+     * It swaps in a new engine if one is ready, updates the feedback filters and returns the engine to use for the block.
+     *
+     * @param numSamples: number of samples the block is going to process.
+     * @return DelayEngine<SampleType>&
+     */
+    DelayEngine<SampleType>& beginBlock (const int numSamples) noexcept;
+
+    /**
+     * @brief This method processes two samples (one for each output) in place with the active engine,
+     * crossfading with the old one after a swap. Call it from the audio thread after beginBlock.
+     *
+     * @param samples: input samples, replaced by the output ones.
+     * @return SampleType*
+     */
+    SampleType* processSamples (SampleType* samples);
+
+private:
+    //==========================================================================
+    // Background thread.
+
+    void run() override;
+
+    /**
+     * @brief This method builds a new engine if the requested interpolation differs from the active one.
+     */
+    void buildRequestedEngine();
+
+    //==========================================================================
+    // Audio thread.
+
+    /**
+     * @brief This method copies the next slice of the active engine into the pending one.
+     *
+     * @param current: active engine.
+     * @param next: pending engine.
+     * @param numSamples: number of samples the block is going to process.
+     * @return bool: true when the pending engine has the whole content of the active one.
+     */
+    bool primeEngine (DelayEngine<SampleType>& current, DelayEngine<SampleType>& next, const int numSamples) noexcept;
+
+    /**
+     * @brief This method deletes the engines released by the audio thread.
+     */
+    void collectGarbage();
+
+    //==========================================================================
+    // Engines, active is replaced only by the audio thread. The background thread reads only its interpolation.
+    std::atomic<DelayEngine<SampleType>*> active { nullptr };
+    std::atomic<DelayEngine<SampleType>*> pending { nullptr };
+    std::atomic<DelayEngine<SampleType>*> retired { nullptr };
+
+    std::atomic<int> requestedInterpolation { static_cast<int> (Interpolation::linear) };
+
+    // Copy of the active engine into the pending one, used by the audio thread only. The copy starts at
+    // the oldest sample and must reach the write head one lap later, the head moving meanwhile.
+    DelayEngine<SampleType>* priming = nullptr;
+    int primingStartIndex = 0;
+    juce::int64 primingCopied = 0;
+    juce::int64 primingWritten = 0;
+
+    // Swap crossfade, used by the audio thread only.
+    DelayEngine<SampleType>* fading = nullptr;
+    int swapCrossfadeSamples = 0;
+    int swapCrossfadeRemaining = 0;
+
+    // Layout of the engines, protected by buildLock.
+    juce::CriticalSection buildLock;
+    juce::dsp::ProcessSpec spec {};
+    int maxDelaySamples = 0;
+    bool monoInput = false;
+    bool resampleOnSampleRateChange = true;
+}; // class DelayEngineManager
+
+} // namespace dsp
+} // namespace cdrt
@@ -1,5 +1,6 @@
 #include "./DelayLine.h"
 #include "../utility/Conversion.h"
+#include "../utility/Trace.h"
 
 namespace cdrt
 {
@@ -29,12 +30,17 @@ void DelayLineBase<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
     jassert (spec.numChannels > 0);
     numChannels = spec.numChannels;
 
-    buffer.setSize (static_cast<int> (numChannels), maxBufferSize, false, false, true);
+    allocateBuffer (static_cast<int> (numChannels));
 
     writePointer.resize (spec.numChannels);
     readPointer.resize (spec.numChannels);
+    crossfadeCounter.resize (spec.numChannels);
+    headDelayInt.resize (spec.numChannels);
+    previousDelayInt.resize (spec.numChannels);
 
     sampleRate = spec.sampleRate;
+    feedbackFilter.prepare (sampleRate, static_cast<int> (numChannels));
+    saturation.prepare (static_cast<int> (numChannels));
 
     reset();
 }
@@ -45,7 +51,13 @@ void DelayLineBase<SampleType>::reset()
     for (auto vec: { &writePointer, &readPointer })
         std::fill (vec->begin(), vec->end(), 0);
 
+    // Any running crossfade is considered completed.
+    std::fill (crossfadeCounter.begin(), crossfadeCounter.end(), crossfadeSamples);
+    std::fill (headDelayInt.begin(), headDelayInt.end(), delayInt);
+
     buffer.clear();
+    feedbackFilter.reset();
+    saturation.reset();
 }
 
 //==============================================================================
@@ -57,7 +69,7 @@ void DelayLineBase<SampleType>::setMaxDelaySamples (const int newMaxBufferSize)
     jassert (newMaxBufferSize >= 0);
 
     maxBufferSize = newMaxBufferSize;
-    buffer.setSize (buffer.getNumChannels(), maxBufferSize, false, false, true);
+    allocateBuffer (buffer.getNumChannels());
 }
 
 template<typename SampleType>
@@ -65,9 +77,31 @@ void DelayLineBase<SampleType>::setDelaySamples (const float newDelaySamples)
 {
     jassert (juce::isPositiveAndNotGreaterThan (newDelaySamples, maxBufferSize));
 
-    delaySamples = newDelaySamples;
+    // A delay of the whole buffer would read the sample just written by processSample and the oldest one in
+    // processBlock: the last slot is left to the write head.
+    requestedDelaySamples = juce::jmin (newDelaySamples, static_cast<float> (juce::jmax (0, maxBufferSize - 1)));
+
+    // The feedback stages delay every repeat by their latency, while they are active the feedback is read that much
+    // earlier. The output keeps the requested delay.
+    const auto readDelaySamples = juce::jmax (0.f, requestedDelaySamples - getFeedbackLatency());
+
+    if (crossfadeSamples > 0)
+    {
+        // Every channel moves its read head to the latest delay as soon as its running crossfade ends,
+        // going back to the current head cancels the change.
+        delayInt = static_cast<int> (std::round (readDelaySamples));
+        delaySamples = static_cast<float> (delayInt);
+        delayFrac = 0.f;
+        outputDelayOffset = static_cast<int> (std::round (requestedDelaySamples)) - delayInt;
+
+        updateInternalVariables();
+        return;
+    }
+
+    delaySamples = readDelaySamples;
     delayInt = static_cast<int> (std::floor (delaySamples));
     delayFrac = delaySamples - delayInt;
+    outputDelayOffset = static_cast<int> (std::floor (requestedDelaySamples)) - delayInt;
     
     updateInternalVariables();
 }
@@ -85,6 +119,80 @@ void DelayLineBase<SampleType>::setFeedback (const float newFeedback)
     feedback = newFeedback;
 }
 
+template<typename SampleType>
+void DelayLineBase<SampleType>::setCrossfadeSamples (const int newCrossfadeSamples)
+{
+    jassert (newCrossfadeSamples >= 0);
+
+    crossfadeSamples = newCrossfadeSamples;
+    std::fill (crossfadeCounter.begin(), crossfadeCounter.end(), crossfadeSamples);
+
+    // The crossfade mode works with integer delays only.
+    setDelaySamples (requestedDelaySamples);
+    std::fill (headDelayInt.begin(), headDelayInt.end(), delayInt);
+}
+
+template<typename SampleType>
+void DelayLineBase<SampleType>::setFeedbackFilter (const float lowCut, const float highCut, const float tilt)
+{
+    feedbackFilter.setParameters (lowCut, highCut, tilt);
+}
+
+template<typename SampleType>
+void DelayLineBase<SampleType>::setFeedbackSaturation (const typename Saturation<SampleType>::Shape shape, const float drive)
+{
+    const auto wasActive = saturation.isActive();
+
+    saturation.setShape (shape);
+    saturation.setDrive (drive);
+
+    // The feedback read head moves by the half sample of the antialiasing.
+    if (saturation.isActive() != wasActive)
+        setDelaySamples (requestedDelaySamples);
+}
+
+template<typename SampleType>
+void DelayLineBase<SampleType>::setHistory (const int channel, const SampleType* source, const int numSamples)
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+    const auto toCopy = juce::jmin (numSamples, maxBufferSize);
+    auto* destination = buffer.getWritePointer (channel);
+
+    // The oldest part of the buffer is left silent when the history is shorter.
+    juce::FloatVectorOperations::copy (destination, source + numSamples - toCopy, toCopy);
+    juce::FloatVectorOperations::clear (destination + toCopy, maxBufferSize - toCopy);
+
+    writePointer[static_cast<size_t> (channel)] = toCopy % maxBufferSize;
+    readPointer[static_cast<size_t> (channel)] = writePointer[static_cast<size_t> (channel)];
+}
+
+template<typename SampleType>
+void DelayLineBase<SampleType>::copyFrom (const DelayLineBase& other, const int startIndex, const int numSamples)
+{
+    jassert (other.numChannels == numChannels && other.maxBufferSize == maxBufferSize);
+
+    const auto toCopy = juce::jmin (numSamples, maxBufferSize);
+    const auto firstPart = juce::jmin (toCopy, maxBufferSize - startIndex);
+
+    for (int channel = 0; channel < static_cast<int> (numChannels); ++channel)
+    {
+        buffer.copyFrom (channel, startIndex, other.buffer, channel, startIndex, firstPart);
+        buffer.copyFrom (channel, 0, other.buffer, channel, 0, toCopy - firstPart);
+    }
+
+    writePointer = other.writePointer;
+    readPointer = other.readPointer;
+    feedback = other.feedback;
+    feedbackFilter.copyFrom (other.feedbackFilter);
+    saturation.copyFrom (other.saturation);
+
+    // The delay goes through setDelaySamples, every interpolation has its own internal variables.
+    setCrossfadeSamples (0);
+    setDelaySamples (other.requestedDelaySamples);
+    setCrossfadeSamples (other.crossfadeSamples);
+}
+
 //==============================================================================
 // Getters.
 
@@ -100,6 +208,18 @@ SampleType DelayLineBase<SampleType>::getSample (const int channel, const int in
     return buffer.getSample(channel, index);
 }
 
+template<typename SampleType>
+const SampleType* DelayLineBase<SampleType>::getReadPointer (const int channel) const noexcept
+{
+    return buffer.getReadPointer (channel);
+}
+
+template <typename SampleType>
+bool DelayLineBase<SampleType>::isBufferHugePageAdvised() const noexcept
+{
+    return storage.isHugePageAdvised();
+}
+
 template <typename SampleType>
 int DelayLineBase<SampleType>::getReadIndex(const int channel) const
 {
@@ -112,16 +232,92 @@ juce::uint32 DelayLineBase<SampleType>::getMaxBlocks() const
     return maxBlocks;
 }
 
+template <typename SampleType>
+float DelayLineBase<SampleType>::getDelaySamples() const noexcept
+{
+    return requestedDelaySamples;
+}
+
+template <typename SampleType>
+int DelayLineBase<SampleType>::getWriteIndex (const int channel) const
+{
+    return writePointer[static_cast<size_t> (channel)];
+}
+
+template <typename SampleType>
+double DelayLineBase<SampleType>::getSampleRate() const noexcept
+{
+    return sampleRate;
+}
+
+template <typename SampleType>
+int DelayLineBase<SampleType>::getCrossfadeSamples() const noexcept
+{
+    return crossfadeSamples;
+}
+
+template <typename SampleType>
+float DelayLineBase<SampleType>::getFeedbackLatency() const noexcept
+{
+    // The antialiasing of the saturation averages two consecutive samples, half a sample of delay.
+    return saturation.isActive() ? 0.5f : 0.f;
+}
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::copyHistory (const int channel, SampleType* destination) const
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+    // The write pointer is on the oldest sample.
+    const auto* source = buffer.getReadPointer (channel);
+    const auto oldest = writePointer[static_cast<size_t> (channel)];
+
+    juce::FloatVectorOperations::copy (destination, source + oldest, maxBufferSize - oldest);
+    juce::FloatVectorOperations::copy (destination + maxBufferSize - oldest, source, oldest);
+}
+
 //==============================================================================
 // Processing.
 
 template <typename SampleType>
-void DelayLineBase<SampleType>::putSample (const int channel, const SampleType sample)
+void DelayLineBase<SampleType>::updateFeedbackFilter (const int numSamples)
+{
+    feedbackFilter.update (numSamples);
+}
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::putSample (const int channel, const SampleType sample, const SampleType tapFeedback)
 {
     jassert (juce::isPositiveAndBelow (channel, numChannels));
     
-    auto interpolation = interpolateSample(channel);
-    auto toWriteSample = sample + interpolation * feedback;
+    SampleType interpolation;
+
+    if (crossfadeSamples > 0)
+    {
+        // Integer delays, the heads of the channel are read as they are.
+        startCrossfade (channel);
+        interpolation = getHeadSample (channel, headDelayInt[static_cast<size_t> (channel)]);
+
+        if (crossfadeCounter[static_cast<size_t> (channel)] < crossfadeSamples)
+        {
+            const auto gain = getCrossfadeGain (channel);
+            interpolation = gain * interpolation + (1 - gain) * getHeadSample (channel, previousDelayInt[static_cast<size_t> (channel)]);
+        }
+    }
+    else
+    {
+        interpolation = interpolateSample(channel);
+    }
+
+    auto feedbackSample = interpolation * feedback + tapFeedback;
+
+    if (feedbackFilter.isActive())
+        feedbackSample = feedbackFilter.processSample (channel, feedbackSample);
+
+    if (saturation.isActive())
+        feedbackSample = saturation.processSample (channel, feedbackSample);
+
+    auto toWriteSample = sample + feedbackSample;
     
     buffer.setSample (channel, writePointer[static_cast<size_t> (channel)], toWriteSample);
     writePointer[static_cast<size_t> (channel)] = (writePointer[static_cast<size_t> (channel)] + 1) % getMaximumDelaySamples();
@@ -134,8 +330,16 @@ SampleType DelayLineBase<SampleType>::popSample (const int channel, const bool u
 
     // Calculate the delayed delay index.
     // This calulation is required because it will calculate the module of negative values.
-    const auto readIndex = ((readPointer[static_cast<size_t> (channel)] - delayInt) % getMaximumDelaySamples() + getMaximumDelaySamples()) % getMaximumDelaySamples();
+    const auto readIndex = ((readPointer[static_cast<size_t> (channel)] - getHeadDelay (channel) - outputDelayOffset) % getMaximumDelaySamples() + getMaximumDelaySamples()) % getMaximumDelaySamples();
     auto result = buffer.getSample(channel, readIndex);
+
+    const auto crossfading = crossfadeCounter[static_cast<size_t> (channel)] < crossfadeSamples;
+
+    if (crossfading)
+    {
+        const auto gain = getCrossfadeGain (channel);
+        result = gain * result + (1 - gain) * getHeadSample (channel, previousDelayInt[static_cast<size_t> (channel)] + outputDelayOffset);
+    }
     
     // Baranchelss code of:
     // if (updatePointer)
@@ -144,17 +348,289 @@ SampleType DelayLineBase<SampleType>::popSample (const int channel, const bool u
     // }
     readPointer[static_cast<size_t> (channel)] = (updatePointer * ((readPointer[static_cast<size_t> (channel)] + 1) % getMaximumDelaySamples())) + (!updatePointer * readPointer[static_cast<size_t> (channel)]);
 
+    if (crossfading && updatePointer)
+        advanceCrossfade (channel);
+
     return result;
 }
 
 template <typename SampleType>
-SampleType DelayLineBase<SampleType>::processSample (const int channel, const float sample)
+SampleType DelayLineBase<SampleType>::readTap (const int channel, const float tapDelaySamples) const
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+    const auto clamped = juce::jlimit (1.0f, static_cast<float> (maxBufferSize - 2), tapDelaySamples);
+    const auto tapInt = static_cast<int> (clamped);
+
+    return interpolateTap (channel, tapInt, clamped - static_cast<float> (tapInt));
+}
+
+template <typename SampleType>
+SampleType DelayLineBase<SampleType>::readLinearTap (const int channel, const float tapDelaySamples) const
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+    const auto clamped = juce::jlimit (1.0f, static_cast<float> (maxBufferSize - 2), tapDelaySamples);
+    const auto tapInt = static_cast<int> (clamped);
+
+    return DelayLineBase<SampleType>::interpolateTap (channel, tapInt, clamped - static_cast<float> (tapInt));
+}
+
+template <typename SampleType>
+SampleType DelayLineBase<SampleType>::interpolateTap (const int channel, const int tapInt, const float tapFrac) const
 {
-    putSample (channel, sample);
+    // The second sample is one step older, the delay grows with the fractional part.
+    const auto index1 = ((readPointer[static_cast<size_t> (channel)] - tapInt) % maxBufferSize + maxBufferSize) % maxBufferSize;
+    const auto index2 = index1 == 0 ? maxBufferSize - 1 : index1 - 1;
+
+    return cdrt::utility::interpolation::linear<SampleType> (buffer.getSample (channel, index1), buffer.getSample (channel, index2), tapFrac);
+}
+
+template <typename SampleType>
+template <std::size_t NumPhases>
+SampleType DelayLineBase<SampleType>::readLagrange3rd (const int channel, const int readInt, const float readFrac) const
+{
+    // The four samples straddle the delay, two older and two newer: the position from the oldest one
+    // is in (1, 2], where the interpolation is centred. For the shortest and the longest delays the
+    // points stay on the samples written.
+    const auto size = maxBufferSize;
+    const auto oldest = juce::jmin (juce::jmax (readInt + 2, 4), size);
+    const auto position = static_cast<float> (oldest - readInt) - readFrac;
+
+    // Retriving index to read from.
+    auto index1 = ((readPointer[static_cast<size_t> (channel)] - oldest) % size + size) % size;
+    auto index2 = (index1 + 1) % size;
+    auto index3 = (index2 + 1) % size;
+    auto index4 = (index3 + 1) % size;
+    
+    // Retriving samples from indexes retrived in previous step.
+    auto sample1 = buffer.getSample(channel, index1);
+    auto sample2 = buffer.getSample(channel, index2);
+    auto sample3 = buffer.getSample(channel, index3);
+    auto sample4 = buffer.getSample(channel, index4);
+
+    // The table covers the centred positions only.
+    if constexpr (NumPhases > 0)
+        if (position >= 1.f && position <= 2.f)
+            return cdrt::utility::interpolation::lagrange3rdTabulated<SampleType, NumPhases>(sample1, sample2, sample3, sample4, position);
+    
+    return cdrt::utility::interpolation::lagrange3rd<SampleType>(sample1, sample2, sample3, sample4, position);
+}
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::writeSample (const int channel, const SampleType sample)
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels));
+
+    const auto index = static_cast<size_t> (channel);
+    buffer.setSample (channel, writePointer[index], sample);
+    writePointer[index] = (writePointer[index] + 1) % maxBufferSize;
+    readPointer[index] = (readPointer[index] + 1) % maxBufferSize;
+}
+
+template <typename SampleType>
+SampleType DelayLineBase<SampleType>::processSample (const int channel, const float sample, const SampleType tapFeedback)
+{
+    putSample (channel, sample, tapFeedback);
     auto result = popSample (channel);
     return result;
 }
 
+template <typename SampleType>
+void DelayLineBase<SampleType>::processBlock (const int channel, const SampleType* input, SampleType* output, const int numSamples)
+{
+    processBlock (channel, input, output, nullptr, 0.f, 0, numSamples);
+}
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::processBlock (const int channel, const SampleType* input, SampleType* output, SampleType* tapOutput,
+                                              const float tapDelaySamples, const SampleType tapFeedback, const int numSamples)
+{
+    jassert (juce::isPositiveAndBelow (channel, numChannels) && input != output && input != tapOutput);
+
+    // Traced per block, a marker per sample would cost more than the sample itself.
+    CDRT_TRACE_SCOPE ("DelayLine::processBlock");
+
+    prefetchBlock (channel, numSamples);
+
+    // Without a tap its delay doesn't limit the chunks.
+    const auto tapInt = tapOutput != nullptr ? static_cast<int> (tapDelaySamples) : delayInt;
+    const auto staticTap = tapOutput == nullptr
+                        || (static_cast<float> (tapInt) == tapDelaySamples && tapInt >= 1 && tapInt <= maxBufferSize - 2);
+
+    const auto staticDelay = delayInt >= 1 && isInterpolationExact() && staticTap
+                          && crossfadeCounter[static_cast<size_t> (channel)] >= crossfadeSamples && getHeadDelay (channel) == delayInt
+                          && ! feedbackFilter.isActive() && ! saturation.isActive();
+
+    if (! staticDelay)
+    {
+        if (tapOutput == nullptr)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+                output[sample] = processSample (channel, input[sample]);
+
+            return;
+        }
+
+        // The tap fed back is read earlier by the latency of the feedback stages, as the line does.
+        const auto latency = getFeedbackLatency();
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            tapOutput[sample] = readTap (channel, tapDelaySamples);
+            const auto feedbackTap = latency > 0.f ? readTap (channel, tapDelaySamples - latency) : tapOutput[sample];
+            output[sample] = processSample (channel, input[sample], tapFeedback * feedbackTap);
+        }
+
+        return;
+    }
+
+    auto* samples = buffer.getWritePointer (channel);
+    auto& writeIndex = writePointer[static_cast<size_t> (channel)];
+    auto& readIndex = readPointer[static_cast<size_t> (channel)];
+    const auto size = maxBufferSize;
+    const auto gain = static_cast<SampleType> (feedback);
+
+    // Output (or tap) and feedback source are the segment read at a delay, two spans at most.
+    const auto readSegment = [&] (SampleType* destination, const int delay, const int count)
+    {
+        const auto start = ((readIndex - delay) % size + size) % size;
+        const auto first = juce::jmin (count, size - start);
+        juce::FloatVectorOperations::copy (destination, samples + start, first);
+        juce::FloatVectorOperations::copy (destination + first, samples, count - first);
+    };
+
+    // The input plus the feedback of the segment is written at the write head, two spans at most.
+    const auto writeSegment = [&] (const int offset, const int start, const int count)
+    {
+        juce::FloatVectorOperations::copy (samples + start, input + offset, count);
+        juce::FloatVectorOperations::addWithMultiply (samples + start, output + offset, gain, count);
+
+        if (tapOutput != nullptr)
+            juce::FloatVectorOperations::addWithMultiply (samples + start, tapOutput + offset, tapFeedback, count);
+    };
+
+    // A chunk never reads what it writes: at most the shortest delay is written before the first of them is read.
+    for (int position = 0; position < numSamples;)
+    {
+        const auto count = juce::jmin (numSamples - position, delayInt, tapInt);
+
+        readSegment (output + position, delayInt, count);
+
+        if (tapOutput != nullptr)
+            readSegment (tapOutput + position, tapInt, count);
+
+        const auto writeFirst = juce::jmin (count, size - writeIndex);
+        writeSegment (position, writeIndex, writeFirst);
+        writeSegment (position + writeFirst, 0, count - writeFirst);
+
+        writeIndex = (writeIndex + count) % size;
+        readIndex = (readIndex + count) % size;
+        position += count;
+    }
+
+    interpolationSkipped (channel);
+}
+
+template <typename SampleType>
+bool DelayLineBase<SampleType>::isInterpolationExact() const noexcept
+{
+    return delayFrac == 0.f;
+}
+
+//==============================================================================
+// Crossfade.
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::startCrossfade (const int channel)
+{
+    const auto index = static_cast<size_t> (channel);
+
+    if (crossfadeCounter[index] < crossfadeSamples || headDelayInt[index] == delayInt)
+        return;
+
+    previousDelayInt[index] = headDelayInt[index];
+    headDelayInt[index] = delayInt;
+    crossfadeCounter[index] = 0;
+}
+
+template <typename SampleType>
+int DelayLineBase<SampleType>::getHeadDelay (const int channel) const noexcept
+{
+    return crossfadeSamples > 0 ? headDelayInt[static_cast<size_t> (channel)] : delayInt;
+}
+
+template <typename SampleType>
+SampleType DelayLineBase<SampleType>::getCrossfadeGain (const int channel) const
+{
+    return static_cast<SampleType> (crossfadeCounter[static_cast<size_t> (channel)]) / static_cast<SampleType> (crossfadeSamples);
+}
+
+template <typename SampleType>
+SampleType DelayLineBase<SampleType>::getHeadSample (const int channel, const int headDelay) const
+{
+    const auto index = ((readPointer[static_cast<size_t> (channel)] - headDelay) % getMaximumDelaySamples() + getMaximumDelaySamples()) % getMaximumDelaySamples();
+    return buffer.getSample (channel, index);
+}
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::advanceCrossfade (const int channel)
+{
+    // A change queued meanwhile starts with the next sample of the channel.
+    ++crossfadeCounter[static_cast<size_t> (channel)];
+}
+
+//==============================================================================
+// Buffer.
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::allocateBuffer (const int channels)
+{
+    // Channels start on their own cache line.
+    constexpr auto lineSamples = static_cast<int> (cdrt::utility::AlignedStorage::cacheLineBytes / sizeof (SampleType));
+    const auto stride = (maxBufferSize + lineSamples - 1) / lineSamples * lineSamples;
+
+    if (channels == 0 || stride == 0 || ! storage.allocate (static_cast<size_t> (channels * stride) * sizeof (SampleType)))
+    {
+        jassert (channels == 0 || stride == 0);
+        storage.release();
+        buffer.setSize (channels, 0);
+        return;
+    }
+
+    channelPointers.resize (static_cast<size_t> (channels));
+
+    for (int channel = 0; channel < channels; ++channel)
+        channelPointers[static_cast<size_t> (channel)] = static_cast<SampleType*> (storage.getData()) + channel * stride;
+
+    buffer.setDataToReferTo (channelPointers.data(), channels, maxBufferSize);
+}
+
+template <typename SampleType>
+void DelayLineBase<SampleType>::prefetchBlock (const int channel, const int numSamples) const noexcept
+{
+    if (maxBufferSize == 0)
+        return;
+
+    // A few samples around the read head for the interpolators, the previous head too while crossfading.
+    constexpr int margin = 4;
+    const auto* samples = buffer.getReadPointer (channel);
+    const auto count = juce::jmin (numSamples + 2 * margin, maxBufferSize);
+    const auto crossfading = crossfadeCounter[static_cast<size_t> (channel)] < crossfadeSamples;
+
+    for (const auto delay: { getHeadDelay (channel), crossfading ? previousDelayInt[static_cast<size_t> (channel)] : -1 })
+    {
+        if (delay < 0)
+            continue;
+
+        const auto start = ((readPointer[static_cast<size_t> (channel)] - delay - margin) % maxBufferSize + maxBufferSize) % maxBufferSize;
+        const auto first = juce::jmin (count, maxBufferSize - start);
+
+        cdrt::utility::AlignedStorage::prefetch (samples + start, static_cast<size_t> (first) * sizeof (SampleType));
+        cdrt::utility::AlignedStorage::prefetch (samples, static_cast<size_t> (count - first) * sizeof (SampleType));
+    }
+}
+
 template class DelayLineBase<float>;
 template class DelayLineBase<double>;
 
@@ -171,6 +647,15 @@ SampleType DelayLineNone<SampleType>::interpolateSample (const int channel)
     return this->buffer.getSample(channel, index);
 }
 
+template <typename SampleType>
+SampleType DelayLineNone<SampleType>::interpolateTap (const int channel, const int tapInt, const float tapFrac) const
+{
+    juce::ignoreUnused (tapFrac);
+
+    const auto size = this->maxBufferSize;
+    return this->buffer.getSample (channel, ((this->readPointer[static_cast<size_t> (channel)] - tapInt) % size + size) % size);
+}
+
 template class DelayLineNone<float>;
 template class DelayLineNone<double>;
 
@@ -181,8 +666,9 @@ template <typename SampleType>
 SampleType DelayLineLinear<SampleType>::interpolateSample (const int channel)
 {
     // Retriving index to read from.
+    // The second sample is one step older, the delay grows with the fractional part as in readTap.
     auto index1 = DelayLineBase<SampleType>::getReadIndex(channel);
-    auto index2 = (index1 + 1) % this->maxBufferSize;
+    auto index2 = index1 == 0 ? this->maxBufferSize - 1 : index1 - 1;
     
     // Retriving samples from indexes retrived in previous step.
     auto sample1 = this->buffer.getSample(channel, index1);
@@ -198,107 +684,144 @@ template class DelayLineLinear<double>;
 
 //===============================================================================
 // class DelayLineLagrange3rd
-template <typename SampleType>
-SampleType DelayLineLagrange3rd<SampleType>::interpolateSample (const int channel)
+template <typename SampleType, std::size_t NumPhases>
+SampleType DelayLineLagrange3rd<SampleType, NumPhases>::interpolateSample (const int channel)
 {
-    // Retriving index to read from.
-    auto index1 = DelayLineBase<SampleType>::getReadIndex(channel);
-    auto index2 = (index1 + 1) % this->maxBufferSize;
-    auto index3 = (index2 + 1) % this->maxBufferSize;
-    auto index4 = (index3 + 1) % this->maxBufferSize;
-    
-    // Retriving samples from indexes retrived in previous step.
-    auto sample1 = this->buffer.getSample(channel, index1);
-    auto sample2 = this->buffer.getSample(channel, index2);
-    auto sample3 = this->buffer.getSample(channel, index3);
-    auto sample4 = this->buffer.getSample(channel, index4);
-    
-    auto res = cdrt::utility::interpolation::lagrange3rd<SampleType>(sample1, sample2, sample3, sample4, this->delayFrac);
-    
-    updateInternalVariables();
-        
-    return res;
+    // Nothing is stored, the delay holds until the next setDelaySamples.
+    return this->template readLagrange3rd<NumPhases> (channel, this->delayInt, this->delayFrac);
 }
 
-template <typename SampleType>
-void DelayLineLagrange3rd<SampleType>::updateInternalVariables()
+template <typename SampleType, std::size_t NumPhases>
+SampleType DelayLineLagrange3rd<SampleType, NumPhases>::interpolateTap (const int channel, const int tapInt, const float tapFrac) const
 {
-    if (this->delayInt >= 1)
-    {
-        this->delayFrac++;
-        this->delayInt--;
-    }
+    return this->template readLagrange3rd<NumPhases> (channel, tapInt, tapFrac);
 }
 
 template class DelayLineLagrange3rd<float>;
 template class DelayLineLagrange3rd<double>;
+template class DelayLineLagrange3rd<float, 256>;
+template class DelayLineLagrange3rd<double, 256>;
 
 
 //===============================================================================
 // class DelayLineThiran
 
+// Constructor.
+template <typename SampleType>
+DelayLineThiran<SampleType>::DelayLineThiran (const int newOrder)
+    : order (juce::jlimit (1, maxOrder, newOrder))
+{
+}
+
 // Allocation/Deallocation.
 template <typename SampleType>
 void DelayLineThiran<SampleType>::prepare (const juce::dsp::ProcessSpec &spec)
 {
-    jassert (spec.numChannels > 0);
-    this->numChannels = spec.numChannels;
-
-    this->buffer.setSize (static_cast<int> (this->numChannels), this->maxBufferSize, false, false, true);
-
-    this->writePointer.resize (spec.numChannels);
-    this->readPointer.resize (spec.numChannels);
-
-    prev.resize (spec.numChannels);
-    this->sampleRate = spec.sampleRate;
+    states.resize (spec.numChannels);
 
-    reset();
+    DelayLineBase<SampleType>::prepare (spec);
 }
 
 
 template <typename SampleType>
 void DelayLineThiran<SampleType>::reset()
 {
-    for (auto vec: { &this->writePointer, &this->readPointer })
-        std::fill (vec->begin(), vec->end(), 0);
+    DelayLineBase<SampleType>::reset();
 
-     std::fill (prev.begin(), prev.end(), static_cast<SampleType> (0));
-
-    this->buffer.clear();
+    std::fill (states.begin(), states.end(), State {});
 }
 
 // Processing
 template <typename SampleType>
 SampleType DelayLineThiran<SampleType>::interpolateSample (const int channel)
 {
-    // Retriving index to read from.
-    auto index1 = DelayLineBase<SampleType>::getReadIndex(channel);
-    auto index2 = (index1 + 1) % this->maxBufferSize;
-    
-    // Retriving samples from indexes retrived in previous step.
-    auto sample1 = this->buffer.getSample(channel, index1);
-    auto sample2 = this->buffer.getSample(channel, index2);
-    
-    // Calculating result and updating prev[channel] variable.
-    auto result = cdrt::utility::interpolation::thiran<SampleType>(sample1, sample2, this->delayFrac, alpha, prev[static_cast<size_t> (channel)]);
-    
-    this->prev[static_cast<size_t>(channel)] = result;
-    
-    updateInternalVariables();
-    
+    const auto size = this->maxBufferSize;
+    const auto newest = ((this->readPointer[static_cast<size_t> (channel)] - allpassOffset) % size + size) % size;
+    const auto* samples = this->buffer.getReadPointer (channel);
+
+    // Input taps, one sample older each.
+    alignas (Register::SIMDRegisterSize) Taps inputs {};
+
+    for (int k = 0, index = newest; k < order; ++k)
+    {
+        index = index == 0 ? size - 1 : index - 1;
+        inputs[static_cast<size_t> (k)] = samples[index];
+    }
+
+    auto& outputs = states[static_cast<size_t> (channel)].outputs;
+    auto taps = Register::expand (0);
+
+    for (size_t i = 0; i < numRegisters; ++i)
+    {
+        taps += Register::fromRawArray (inputCoefficients.data() + i * numLanes) * Register::fromRawArray (inputs.data() + i * numLanes);
+        taps -= Register::fromRawArray (outputCoefficients.data() + i * numLanes) * Register::fromRawArray (outputs.data() + i * numLanes);
+    }
+
+    const auto result = directCoefficient * samples[newest] + taps.sum();
+
+    std::copy_backward (outputs.begin(), outputs.end() - 1, outputs.end());
+    outputs[0] = result;
+
     return result;
 }
 
 template <typename SampleType>
-void DelayLineThiran<SampleType>::updateInternalVariables()
+SampleType DelayLineThiran<SampleType>::interpolateTap (const int channel, const int tapInt, const float tapFrac) const
+{
+    return this->readLagrange3rd (channel, tapInt, tapFrac);
+}
+
+template <typename SampleType>
+bool DelayLineThiran<SampleType>::isInterpolationExact() const noexcept
 {
-    if (this->delayFrac < (SampleType) 0.618 && this->delayInt >= 1)
+    return allpassDelay == static_cast<double> (order);
+}
+
+template <typename SampleType>
+void DelayLineThiran<SampleType>::interpolationSkipped (const int channel)
+{
+    // The outputs were the samples at the delay of the line, the newest first.
+    const auto size = this->maxBufferSize;
+    const auto delay = allpassOffset + order;
+    auto& outputs = states[static_cast<size_t> (channel)].outputs;
+
+    for (int k = 0; k < order; ++k)
     {
-        this->delayFrac++;
-        this->delayInt--;
+        const auto index = ((this->readPointer[static_cast<size_t> (channel)] - 1 - k - delay) % size + size) % size;
+        outputs[static_cast<size_t> (k)] = this->buffer.getSample (channel, index);
     }
+}
 
-    alpha = (1 - this->delayFrac) / (1 + this->delayFrac);
+template <typename SampleType>
+void DelayLineThiran<SampleType>::updateInternalVariables()
+{
+    // One sample at least comes from the buffer, the current input is written after the interpolation.
+    const auto delay = static_cast<double> (this->delaySamples);
+    const auto offset = juce::jmax (1, static_cast<int> (std::floor (delay - order + 0.5)));
+    const auto newAllpassDelay = juce::jmax (order - 0.5, delay - offset);
+
+    // The outputs stored in the states approximate the input delayed by the total delay, whatever
+    // the split between buffer and allpass: when the split moves with a continuous delay they are kept as they are.
+    allpassOffset = offset;
+
+    if (newAllpassDelay == allpassDelay)
+        return;
+
+    allpassDelay = newAllpassDelay;
+
+    std::array<SampleType, maxOrder> coefficients {};
+    cdrt::utility::interpolation::thiranCoefficients (order, allpassDelay, coefficients.data());
+
+    // y[n] = aN x[n] + aN-1 x[n-1] + ... + x[n-N] - a1 y[n-1] - ... - aN y[n-N].
+    directCoefficient = coefficients[static_cast<size_t> (order - 1)];
+    inputCoefficients.fill (0);
+    outputCoefficients.fill (0);
+
+    for (int k = 1; k <= order; ++k)
+    {
+        inputCoefficients[static_cast<size_t> (k - 1)] = k == order ? static_cast<SampleType> (1) : coefficients[static_cast<size_t> (order - k - 1)];
+        outputCoefficients[static_cast<size_t> (k - 1)] = coefficients[static_cast<size_t> (k - 1)];
+    }
 }
 
 template class DelayLineThiran<float>;
@@ -2,6 +2,9 @@
 
 #include <juce_dsp/juce_dsp.h>
 #include <juce_core/juce_core.h>
+#include "./FeedbackFilter.h"
+#include "./Saturation.h"
+#include "../utility/AlignedStorage.h"
 #include "../utility/Interpolation.h"
 
 namespace cdrt
@@ -80,6 +83,56 @@ public:
      */
     void setFeedback (const float newFeedback);
 
+    /**
+     * @brief This method enables the crossfading delay time change mode.
+     * When enabled the delay is rounded to an integer number of samples and every change of it
+     * starts a second read head at the new delay, the old and the new heads are crossfaded over the given length.
+     * Changes arriving while a crossfade is running are applied as soon as it ends (only the latest one is kept).
+     * Every channel crossfades on its own, a channel that is not processed does not hold back the others.
+     *
+     * @param newCrossfadeSamples: length of the crossfade in samples, 0 disables the mode.
+     */
+    void setCrossfadeSamples (const int newCrossfadeSamples);
+
+    /**
+     * @brief This method sets the tone of the repeats, the filters are applied to the feedback only.
+     * The values are smoothed and applied by updateFeedbackFilter.
+     *
+     * @param lowCut: cutoff of the highpass expressed in Hz.
+     * @param highCut: cutoff of the lowpass expressed in Hz.
+     * @param tilt: gain of the high frequencies over the low ones expressed in dB.
+     */
+    void setFeedbackFilter (const float lowCut, const float highCut, const float tilt);
+
+    /**
+     * @brief This method sets the saturation of the repeats, applied to the feedback after the filters.
+     *
+     * @param shape: shaping function.
+     * @param drive: drive normalised in [0, 1], 0 disables the saturation.
+     */
+    void setFeedbackSaturation (const typename Saturation<SampleType>::Shape shape, const float drive);
+
+    /**
+     * @brief This method copies a section of the circular buffers of another delay line, then takes its pointers and settings
+     * (delay, feedback and crossfade length). Both delay lines must have the same number of channels and maximum delay.
+     * Use it to move the state to a delay line with a different interpolation.
+     *
+     * @param other: delay line to copy from.
+     * @param startIndex: index of the first sample to copy.
+     * @param numSamples: number of samples to copy, wrapping around the end of the buffer.
+     */
+    void copyFrom (const DelayLineBase& other, const int startIndex, const int numSamples);
+
+    /**
+     * @brief This method fills the circular buffer of a channel as if the given samples were written in order.
+     * Only the newest samples are kept when they don't fit in the buffer, use it to restore a snapshot.
+     *
+     * @param channel: channel to fill.
+     * @param source: samples from the oldest to the newest.
+     * @param numSamples: number of samples in source.
+     */
+    void setHistory (const int channel, const SampleType* source, const int numSamples);
+
     //==========================================================================
     // Getters.
 
@@ -101,6 +154,22 @@ public:
      */
     SampleType getSample (const int channel, const int index) const;
 
+    /**
+     * @brief This method gets the circular buffer of a channel, getMaximumDelaySamples() samples long.
+     * Read it between blocks, use getWriteIndex to find the newest sample.
+     *
+     * @param channel: channel of the buffer.
+     * @return const SampleType*
+     */
+    const SampleType* getReadPointer (const int channel) const noexcept;
+
+    /**
+     * @brief This method tells if the circular buffers were advised for transparent huge pages (Linux, long delays).
+     *
+     * @return bool
+     */
+    bool isBufferHugePageAdvised() const noexcept;
+
     /**
      * @brief This method get the index where to read at given the setted delay in sapmles.
      *
@@ -114,17 +183,67 @@ public:
      * @return juce::uint32
      */
     juce::uint32 getMaxBlocks() const;
+
+    /**
+     * @brief This method gets the delay in samples set with the last call to setDelaySamples or setDelayTime.
+     * @return float
+     */
+    float getDelaySamples() const noexcept;
+
+    /**
+     * @brief This method gets the index where the next sample will be written.
+     *
+     * @param channel: channel where to get the write index from.
+     * @return int
+     */
+    int getWriteIndex (const int channel) const;
+
+    /**
+     * @brief This method gets the sample rate given at prepare time.
+     * @return double
+     */
+    double getSampleRate() const noexcept;
+
+    /**
+     * @brief This method gets the length of the delay time crossfade, 0 when the crossfade mode is disabled.
+     * @return int
+     */
+    int getCrossfadeSamples() const noexcept;
+
+    /**
+     * @brief This method gets the delay the feedback stages add to every repeat, the feedback is read that much earlier.
+     * Only the saturation adds some, half a sample, in crossfade mode the read delay is rounded to the nearest sample.
+     * @return float
+     */
+    float getFeedbackLatency() const noexcept;
+
+    /**
+     * @brief This method copies the whole content of the circular buffer of a channel, from the oldest to the newest sample.
+     *
+     * @param channel: channel to copy.
+     * @param destination: buffer receiving getMaximumDelaySamples() samples.
+     */
+    void copyHistory (const int channel, SampleType* destination) const;
     
     //==========================================================================
     // Processing.
 
+    /**
+     * @brief Call this method once per block, it moves the smoothing of the feedback filter forward.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void updateFeedbackFilter (const int numSamples);
+
     /**
      * @brief This method puts a sample into the selected channel.
      *
      * @param sample: value to store in circular buffer.
      * @param channel: channel where to store the sample.
+     * @param tapFeedback: feedback of taps read outside (readTap), added to the feedback of the line
+     * before the feedback filters and saturation.
      */
-    void putSample (const int channel, const SampleType sample);
+    void putSample (const int channel, const SampleType sample, const SampleType tapFeedback = 0);
 
     /**
      * @brief This method pops a sample from the given channel.
@@ -136,18 +255,98 @@ public:
     SampleType popSample (const int channel, const bool updatePointer = true);
 
     /**
-     * @brief TODO: Descritpion.
+     * @brief This method reads an additional tap at any delay with the interpolation of the line, the read pointer is not moved.
+     * Call it before putSample, the result is consistent with the sample popSample returns for the same delay.
+     * The delay is clamped to [1, maximum delay - 2] samples.
+     *
+     * @param channel: channel where to read the tap from.
+     * @param tapDelaySamples: delay of the tap expressed in samples.
+     * @return SampleType
+     */
+    SampleType readTap (const int channel, const float tapDelaySamples) const;
+
+    /**
+     * @brief This method reads an additional tap as readTap, with linear interpolation whatever the line uses and no virtual call.
+     *
+     * @param channel: channel where to read the tap from.
+     * @param tapDelaySamples: delay of the tap expressed in samples.
+     * @return SampleType
+     */
+    SampleType readLinearTap (const int channel, const float tapDelaySamples) const;
+
+    /**
+     * @brief This method writes a sample as it is and moves the heads forward, the delay and the feedback are not applied.
+     * With readTap it makes a delay read at any number of taps, the taps are read before the write.
+     *
+     * @param channel: channel where to store the sample.
+     * @param sample: value to store in circular buffer.
+     */
+    void writeSample (const int channel, const SampleType sample);
+
+    /**
+     * @brief This method puts a sample into the selected channel and pops the delayed one.
      *
-     * @param channel
-     * @param sample
+     * @param channel: channel to process.
+     * @param sample: input sample.
+     * @param tapFeedback: feedback of taps read outside (readTap), it goes through the same feedback stages of the line.
      * @return SampleType
      */
-    SampleType processSample (const int channel, const float sample);
+    SampleType processSample (const int channel, const float sample, const SampleType tapFeedback = 0);
+
+    /**
+     * @brief This method processes a block of samples with the current delay and feedback, same result as processSample on every sample.
+     * When the delay is an integer, no crossfade is running and the feedback filters and saturation are off,
+     * the interpolation is skipped: the read segment is copied (two spans at most) and the feedback applied with vector operations.
+     *
+     * @param channel: channel to process.
+     * @param input: samples to write.
+     * @param output: delayed samples, it can't be the input.
+     * @param numSamples: number of samples of the block.
+     */
+    void processBlock (const int channel, const SampleType* input, SampleType* output, const int numSamples);
+
+    /**
+     * @brief This method processes a block as processBlock, with an additional tap read and fed back as readTap and processSample do
+     * on every sample. When the tap delay is an integer too, its segment is copied and its feedback added with vector operations.
+     *
+     * @param channel: channel to process.
+     * @param input: samples to write.
+     * @param output: delayed samples, it can't be the input.
+     * @param tapOutput: samples of the tap, it can't be the input.
+     * @param tapDelaySamples: delay of the tap expressed in samples.
+     * @param tapFeedback: gain of the tap fed back, before the feedback filters and saturation.
+     * @param numSamples: number of samples of the block.
+     */
+    void processBlock (const int channel, const SampleType* input, SampleType* output, SampleType* tapOutput,
+                       const float tapDelaySamples, const SampleType tapFeedback, const int numSamples);
+
+    /**
+     * @brief This method prefetches the samples the next block reads at the current delay, far from the
+     * write head they are rarely in the cache. processBlock calls it, call it before processing a block sample by sample.
+     *
+     * @param channel: channel to prefetch.
+     * @param numSamples: number of samples of the block.
+     */
+    void prefetchBlock (const int channel, const int numSamples) const noexcept;
+
 protected:
     
     //==========================================================================
     // Processing
 
+    /**
+     * @brief This method tells if the interpolation reads the sample at delayInt as it is, so it can be skipped.
+     * @return bool
+     */
+    virtual bool isInterpolationExact() const noexcept;
+
+    /**
+     * @brief This method is called after a block skipped the interpolation of the given channel, to bring its state up to date.
+     *
+     * @param channel: channel of the block.
+     */
+    virtual void interpolationSkipped (const int channel) { juce::ignoreUnused (channel); }
+
     /**
      * @brief This method applies interpolation to the samples in the selected channel.
      *
@@ -155,31 +354,118 @@ protected:
      * @return SampleType
      */
     virtual SampleType interpolateSample(const int channel) = 0;
+
+    /**
+     * @brief This method interpolates a tap of the selected channel, linear unless the line overrides it.
+     * Taps are read at any delay, the interpolation keeps no state.
+     *
+     * @param channel: Channel from which the tap must be interpolated.
+     * @param tapInt: integer part of the delay of the tap, at least 1.
+     * @param tapFrac: fractional part of the delay of the tap.
+     * @return SampleType
+     */
+    virtual SampleType interpolateTap (const int channel, const int tapInt, const float tapFrac) const;
+
+    /**
+     * @brief This method reads the selected channel at a delay with a 3rd order Lagrange interpolation.
+     * With NumPhases > 0 the coefficients come from the compile time table (see lagrange3rdTabulated)
+     * while the position is in [1, 2], otherwise they are computed.
+     *
+     * @param channel: Channel to read.
+     * @param readInt: integer part of the delay.
+     * @param readFrac: fractional part of the delay.
+     * @return SampleType
+     */
+    template <std::size_t NumPhases = 0>
+    SampleType readLagrange3rd (const int channel, const int readInt, const float readFrac) const;
     
     /**
      * @brief This method is used to update internal variables after the sample interpolation process.
      */
     virtual void updateInternalVariables() = 0;
+
+    //==========================================================================
+    // Crossfade.
+
+    /**
+     * @brief This method moves the read head of the given channel to the delay of the line, crossfading from the
+     * current one. Nothing happens while the channel is crossfading or when the head is already there.
+     *
+     * @param channel: channel to update.
+     */
+    void startCrossfade (const int channel);
+
+    /**
+     * @brief This method gets the integer delay of the current read head of the given channel.
+     * In crossfade mode every channel has its own head, otherwise it is the delay of the line.
+     *
+     * @param channel: channel of the head.
+     * @return int
+     */
+    int getHeadDelay (const int channel) const noexcept;
+
+    /**
+     * @brief This method gets the gain of the new read head for the given channel, the old head uses the complement.
+     *
+     * @param channel: channel to get the gain for.
+     * @return SampleType
+     */
+    SampleType getCrossfadeGain (const int channel) const;
+
+    /**
+     * @brief This method gets the sample under a read head at the given integer delay, no interpolation is applied.
+     *
+     * @param channel: channel to get the sample from.
+     * @param headDelay: delay of the head in samples.
+     * @return SampleType
+     */
+    SampleType getHeadSample (const int channel, const int headDelay) const;
+
+    /**
+     * @brief This method moves the crossfade of the given channel one sample forward.
+     *
+     * @param channel: channel to update.
+     */
+    void advanceCrossfade (const int channel);
     
+    /**
+     * @brief This method allocates the circular buffers in the storage, one channel every few cache lines.
+     *
+     * @param channels: number of channels.
+     */
+    void allocateBuffer (const int channels);
+
     //==========================================================================
-    // Buffer.
+    // Buffer, referring to the storage (huge pages for the long delays).
     juce::AudioBuffer <SampleType> buffer;
-    int maxBufferSize;
+    cdrt::utility::AlignedStorage storage;
+    std::vector<SampleType*> channelPointers;
+    int maxBufferSize = 0;
     
     // Spec.
     double sampleRate;
     juce::uint32 numChannels;
     juce::uint32 maxBlocks;
     
-    // Delay.
+    // Delay, the feedback is read at delaySamples and the output outputDelayOffset samples later.
+    float requestedDelaySamples = 0.f;
     float delaySamples = 0.f;
     float delayFrac = 0.f; // Depends on delay samples.
     int delayInt = 0; // Depends on delay samples.
+    int outputDelayOffset = 0; // Latency of the feedback stages while they are active.
     std::vector <int> writePointer;
     std::vector <int> readPointer;
     
     // Feedback.
     float feedback;
+    FeedbackFilter<SampleType> feedbackFilter;
+    Saturation<SampleType> saturation;
+
+    // Crossfade.
+    int crossfadeSamples = 0; // 0 means delay changes are applied as they come.
+    std::vector <int> headDelayInt; // Delay of the current head of every channel, it follows delayInt.
+    std::vector <int> previousDelayInt; // Delay of the old head of every channel while crossfading.
+    std::vector <int> crossfadeCounter;
 }; // class DelayLineBase
     
 
@@ -214,6 +500,11 @@ private:
     
     SampleType interpolateSample(const int channel) override;
 
+    /**
+     * @brief This method reads a tap without interpolation, at the integer part of its delay.
+     */
+    SampleType interpolateTap (const int channel, const int tapInt, const float tapFrac) const override;
+
     /**
      * @brief This method is used to update internal variables after the sample None interpolation process.
      */
@@ -262,7 +553,9 @@ private:
 
 
 // Derived class from DelayLineBase implementing Lagrange3rd interpolation for samples interpolation.
-template <typename SampleType>
+// With NumPhases > 0 the coefficients are read from the compile time table, shared by every instance,
+// and the fractional delay is rounded to 1 / NumPhases samples. With 0 they are computed at every sample.
+template <typename SampleType, std::size_t NumPhases = 0>
 class DelayLineLagrange3rd : public DelayLineBase<SampleType>
 {
 public:
@@ -292,21 +585,38 @@ private:
     
     SampleType interpolateSample(const int channel) override;
 
+    /**
+     * @brief This method reads a tap with the same Lagrange interpolation of the line.
+     */
+    SampleType interpolateTap (const int channel, const int tapInt, const float tapFrac) const override;
+
     /**
      * @brief This method is used to update internal variables after the sample None interpolation process.
+     * The interpolation points are found from the delay at every sample, nothing to update.
      */
-    void updateInternalVariables() override;
+    void updateInternalVariables() override {}
     
 }; // class DelayLineLagrange3rd
 
 // Derived class from DelayLineBase implementing Thiran interpolation for samples interpolation.
+// The allpass of order N delays by M + d samples: M samples are read from the buffer and
+// d in [N - 0.5, N + 0.5) is the allpass delay. The coefficients are recomputed only when d
+// changes. The input and output taps of the allpass are dot products over SIMDRegisters.
 template <typename SampleType>
 class DelayLineThiran : public DelayLineBase<SampleType>
 {
 public:
+    static constexpr int maxOrder = 4;
+
     //==========================================================================
-    // Default constructor.
-    // Calling directly DelayLineBase, no constructor definition required.
+    // Constructor.
+
+    /**
+     * @brief Construct a new DelayLineThiran object.
+     *
+     * @param newOrder: order of the allpass, from 1 to maxOrder.
+     */
+    explicit DelayLineThiran (const int newOrder = 1);
     
     //==========================================================================
     // Destructor.
@@ -346,13 +656,51 @@ private:
     
     SampleType interpolateSample(const int channel) override;
 
+    /**
+     * @brief The allpass state follows the delay of the line only, taps are read with the Lagrange interpolation,
+     * stateless with the closest flat response.
+     */
+    SampleType interpolateTap (const int channel, const int tapInt, const float tapFrac) const override;
+
     /**
      * @brief This method is used to update internal variables after the sample None interpolation process.
      */
     void updateInternalVariables() override;
-    
-    SampleType alpha;
-    std::vector <SampleType> prev;
+
+    /**
+     * @brief The allpass is a plain delay when its delay is the order, its coefficients are all 0.
+     * @return bool
+     */
+    bool isInterpolationExact() const noexcept override;
+
+    /**
+     * @brief This method rebuilds the outputs of the allpass, the delayed samples, after a skipped block.
+     *
+     * @param channel: channel of the block.
+     */
+    void interpolationSkipped (const int channel) override;
+
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t numLanes = Register::SIMDNumElements;
+    static constexpr size_t numRegisters = (maxOrder + numLanes - 1) / numLanes;
+
+    // Taps 1...N of the input and of the output, unused ones are 0.
+    using Taps = std::array<SampleType, numRegisters * numLanes>;
+
+    int order = 1;
+    int allpassOffset = -1; // M, samples read from the buffer before the allpass.
+    double allpassDelay = -1.0; // d, delay of the allpass.
+    SampleType directCoefficient = 0;
+    alignas (Register::SIMDRegisterSize) Taps inputCoefficients {};
+    alignas (Register::SIMDRegisterSize) Taps outputCoefficients {};
+
+    // Outputs of every channel, the newest first.
+    struct State
+    {
+        alignas (Register::SIMDRegisterSize) Taps outputs {};
+    };
+
+    std::vector <State> states;
     
 }; // class Thiran
 } // namespace dsp
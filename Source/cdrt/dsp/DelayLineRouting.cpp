@@ -1,4 +1,5 @@
 #include "./DelayLineRouting.h"
+#include "../utility/Conversion.h"
 
 namespace cdrt
 {
@@ -30,6 +31,34 @@ void DelayLineRoutingBase<SampleType>::reset() noexcept
     delayLines.erase(delayLines.begin(), delayLines.end());
 }
 
+template <typename SampleType>
+void DelayLineRoutingBase<SampleType>::setDelayTime (const int output, const float delayTime)
+{
+    delayLines[static_cast<size_t> (output)].lock()->setDelayTime (delayTime);
+}
+
+template <typename SampleType>
+void DelayLineRoutingBase<SampleType>::setFeedback (const int output, const float feedback)
+{
+    delayLines[static_cast<size_t> (output)].lock()->setFeedback (feedback);
+}
+
+template <typename SampleType>
+void DelayLineRoutingBase<SampleType>::processBlock (const SampleType* input, SampleType* left, SampleType* right, const int numSamples)
+{
+    SampleType samples[2];
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        samples[0] = input[sample];
+        samples[1] = 0;
+        processSamples (samples);
+
+        left[sample] = samples[0];
+        right[sample] = samples[1];
+    }
+}
+
 template class DelayLineRoutingBase<float>;
 template class DelayLineRoutingBase<double>;
 
@@ -50,6 +79,108 @@ SampleType* DelayLineRoutingStraight<SampleType>::processSamples(SampleType* sam
 
 template class DelayLineRoutingStraight<float>;
 template class DelayLineRoutingStraight<double>;
+
+
+template <typename SampleType>
+void DelayLineRoutingMonoToStereo<SampleType>::prepare(std::vector<std::shared_ptr<cdrt::dsp::DelayLineBase<SampleType>>> newDelayLines) noexcept
+{
+    jassert (newDelayLines.size() == 1);
+
+    DelayLineRoutingBase<SampleType>::prepare (newDelayLines);
+
+    tapDelaySamples = 0.f;
+    previousTapDelaySamples = 0.f;
+    tapCrossfadeCounter = std::numeric_limits<int>::max();
+    tapFeedbackGain = 0.f;
+}
+
+template <typename SampleType>
+void DelayLineRoutingMonoToStereo<SampleType>::setDelayTime (const int output, const float delayTime)
+{
+    auto line = this->delayLines[0].lock();
+
+    if (output == 0)
+    {
+        line->setDelayTime (delayTime);
+        return;
+    }
+
+    const auto newDelaySamples = cdrt::utility::conversion::msToSamples<float> (delayTime, static_cast<float> (line->getSampleRate()));
+    const auto crossfadeSamples = line->getCrossfadeSamples();
+
+    if (crossfadeSamples == 0)
+    {
+        // Any running crossfade is considered completed.
+        tapDelaySamples = newDelaySamples;
+        tapCrossfadeCounter = std::numeric_limits<int>::max();
+        return;
+    }
+
+    // Same behaviour of the delay line crossfade, changes arriving during a crossfade wait for its end.
+    const auto rounded = std::round (newDelaySamples);
+
+    if (juce::approximatelyEqual (rounded, tapDelaySamples) || tapCrossfadeCounter < crossfadeSamples)
+        return;
+
+    previousTapDelaySamples = tapDelaySamples;
+    tapDelaySamples = rounded;
+    tapCrossfadeCounter = 0;
+}
+
+template <typename SampleType>
+void DelayLineRoutingMonoToStereo<SampleType>::setFeedback (const int output, const float feedback)
+{
+    // Both taps feed the same buffer, each with half its gain: the loop gain is the mean of the two
+    // feedbacks and equal taps repeat as two straight delay lines fed with the same input.
+    if (output == 0)
+        this->delayLines[0].lock()->setFeedback (0.5f * feedback);
+    else
+        tapFeedbackGain = 0.5f * feedback;
+}
+
+template <typename SampleType>
+SampleType* DelayLineRoutingMonoToStereo<SampleType>::processSamples(SampleType* samples)
+{
+    auto line = this->delayLines[0].lock();
+    const auto crossfadeSamples = line->getCrossfadeSamples();
+
+    // The tap fed back is read earlier by the latency of the feedback stages, as the line does.
+    const auto latency = line->getFeedbackLatency();
+    auto right = line->readTap (0, tapDelaySamples);
+    auto feedbackRight = latency > 0.0f ? line->readTap (0, tapDelaySamples - latency) : right;
+
+    if (tapCrossfadeCounter < crossfadeSamples)
+    {
+        const auto gain = static_cast<SampleType> (tapCrossfadeCounter) / static_cast<SampleType> (crossfadeSamples);
+        right = gain * right + (1 - gain) * line->readTap (0, previousTapDelaySamples);
+        feedbackRight = latency > 0.0f ? gain * feedbackRight + (1 - gain) * line->readTap (0, previousTapDelaySamples - latency) : right;
+        ++tapCrossfadeCounter;
+    }
+
+    // Single write, the right tap feedback goes through the feedback stages of the line.
+    samples[0] = line->processSample (0, static_cast<float> (samples[0]), static_cast<SampleType> (tapFeedbackGain) * feedbackRight);
+    samples[1] = right;
+
+    return samples;
+}
+
+template <typename SampleType>
+void DelayLineRoutingMonoToStereo<SampleType>::processBlock (const SampleType* input, SampleType* left, SampleType* right, const int numSamples)
+{
+    auto line = this->delayLines[0].lock();
+
+    // The tap crossfade runs sample by sample.
+    if (tapCrossfadeCounter < line->getCrossfadeSamples())
+    {
+        DelayLineRoutingBase<SampleType>::processBlock (input, left, right, numSamples);
+        return;
+    }
+
+    line->processBlock (0, input, left, right, tapDelaySamples, static_cast<SampleType> (tapFeedbackGain), numSamples);
+}
+
+template class DelayLineRoutingMonoToStereo<float>;
+template class DelayLineRoutingMonoToStereo<double>;
 } // namespace dsp
 } // namespace cdrt
 
@@ -43,6 +43,23 @@ public:
      */
     virtual void reset() noexcept;
     
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the delay time of one output, by default it is the time of the delay line with the same index.
+     * @param output: index of the output channel.
+     * @param delayTime: delay expressed in milliseconds.
+     */
+    virtual void setDelayTime (const int output, const float delayTime);
+
+    /**
+     * @brief This method sets the feedback of one output, by default it is the feedback of the delay line with the same index.
+     * @param output: index of the output channel.
+     * @param feedback: amount of feedback.
+     */
+    virtual void setFeedback (const int output, const float feedback);
+
     //==========================================================================
     // Processing.
     
@@ -54,6 +71,17 @@ public:
      * @return std::vector<SampleType>
      */
     virtual SampleType* processSamples(SampleType* samples) = 0;
+
+    /**
+     * @brief This method processes a block with the current times and feedbacks, same result as processSamples on every sample.
+     * By default the samples go through processSamples one at a time.
+     *
+     * @param input: input samples, the first input of processSamples.
+     * @param left: samples of the first output.
+     * @param right: samples of the second output.
+     * @param numSamples: number of samples of the block.
+     */
+    virtual void processBlock (const SampleType* input, SampleType* left, SampleType* right, const int numSamples);
     
 protected:
     std::vector<std::weak_ptr<cdrt::dsp::DelayLineBase<SampleType>>> delayLines;
@@ -77,5 +105,55 @@ public:
     SampleType* processSamples(SampleType* samples) override;
 }; // class DelayLineStraight
 
+// Mono input to stereo output routing using a single delay line.
+// The input is written once, the left output is the delay line itself and the
+// right output is an additional tap on the same buffer with its own time and feedback, read with
+// the interpolation of the line (Lagrange for the Thiran lines, their allpass follows one delay only).
+// Each tap feeds the buffer back with half its feedback gain, both go through the feedback filters
+// and saturation of the line: equal times and feedbacks repeat as the straight routing.
+template <typename SampleType>
+class DelayLineRoutingMonoToStereo: public DelayLineRoutingBase<SampleType>
+{
+public:
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * DelayLineRoutingMonoToStereo destructor.
+     */
+    ~DelayLineRoutingMonoToStereo() override {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    void prepare(std::vector<std::shared_ptr<cdrt::dsp::DelayLineBase<SampleType>>> newDelayLines) noexcept override;
+
+    //==========================================================================
+    // Setters.
+
+    void setDelayTime (const int output, const float delayTime) override;
+    void setFeedback (const int output, const float feedback) override;
+
+    //==========================================================================
+    // Processing.
+
+    SampleType* processSamples(SampleType* samples) override;
+
+    /**
+     * @brief This method processes a block, the delay line reads the right tap with it: out of a tap crossfade and
+     * with integer delays the read segments are copied and both feedbacks applied with vector operations.
+     */
+    void processBlock (const SampleType* input, SampleType* left, SampleType* right, const int numSamples) override;
+
+private:
+    // Right tap, it follows the crossfade mode of the delay line.
+    float tapDelaySamples = 0.f;
+    float previousTapDelaySamples = 0.f;
+    int tapCrossfadeCounter = std::numeric_limits<int>::max(); // Completed crossfade.
+
+    // Gain applied to the right tap fed back, half its feedback.
+    float tapFeedbackGain = 0.f;
+}; // class DelayLineRoutingMonoToStereo
+
 } // namespace dsp
 } // namespace cdrt
@@ -0,0 +1,177 @@
+#include "./FeedbackFilter.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class FeedbackFilter
+
+namespace
+{
+constexpr double filterQ = 0.7071067811865476; // Butterworth.
+constexpr double tiltFrequency = 1000.0;
+constexpr double smoothingTimeInSeconds = 0.05;
+} // namespace
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::prepare (const double newSampleRate, const int numChannels)
+{
+    jassert (numChannels > 0);
+
+    sampleRate = newSampleRate;
+    channels.resize (static_cast<size_t> (numChannels));
+
+    lowCut.reset (sampleRate, smoothingTimeInSeconds);
+    highCut.reset (sampleRate, smoothingTimeInSeconds);
+    tilt.reset (sampleRate, smoothingTimeInSeconds);
+
+    updateCoefficients();
+    reset();
+}
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::reset()
+{
+    for (auto& channel: channels)
+        channel = Channel {};
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::setParameters (const float newLowCut, const float newHighCut, const float newTilt)
+{
+    lowCut.setTargetValue (juce::jmax (minLowCut, newLowCut));
+    highCut.setTargetValue (juce::jmin (maxHighCut, newHighCut));
+    tilt.setTargetValue (newTilt);
+}
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::copyFrom (const FeedbackFilter& other)
+{
+    jassert (other.channels.size() == channels.size());
+
+    b0 = other.b0; b1 = other.b1; b2 = other.b2;
+    a1 = other.a1; a2 = other.a2;
+    channels = other.channels;
+
+    lowCut = other.lowCut;
+    highCut = other.highCut;
+    tilt = other.tilt;
+    active = other.active;
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+bool FeedbackFilter<SampleType>::isActive() const noexcept
+{
+    return active;
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::update (const int numSamples)
+{
+    const auto flat = [] (const float low, const float high, const float gain)
+    {
+        return low <= minLowCut && high >= maxHighCut && juce::approximatelyEqual (gain, 0.0f);
+    };
+
+    const auto smoothing = lowCut.isSmoothing() || highCut.isSmoothing() || tilt.isSmoothing();
+    const auto settingsChanged = smoothing
+                              || ! juce::approximatelyEqual (lowCut.getCurrentValue(), lowCut.getTargetValue())
+                              || ! juce::approximatelyEqual (highCut.getCurrentValue(), highCut.getTargetValue())
+                              || ! juce::approximatelyEqual (tilt.getCurrentValue(), tilt.getTargetValue());
+
+    // The whole block uses the values reached at its end.
+    lowCut.skip (numSamples);
+    highCut.skip (numSamples);
+    tilt.skip (numSamples);
+
+    const auto wasActive = active;
+    active = ! flat (lowCut.getCurrentValue(), highCut.getCurrentValue(), tilt.getCurrentValue()) || lowCut.isSmoothing() || highCut.isSmoothing() || tilt.isSmoothing();
+
+    // Coming from bypass the state holds old audio.
+    if (active && ! wasActive)
+        reset();
+
+    if (settingsChanged || (active && ! wasActive))
+        updateCoefficients();
+}
+
+//==============================================================================
+// Coefficients.
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::updateCoefficients()
+{
+    const auto nyquistGuard = 0.45 * sampleRate;
+
+    // Stage 0: low cut.
+    if (lowCut.getCurrentValue() <= minLowCut)
+    {
+        setStage (0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+    }
+    else
+    {
+        const auto w0 = juce::MathConstants<double>::twoPi * juce::jmin (static_cast<double> (lowCut.getCurrentValue()), nyquistGuard) / sampleRate;
+        const auto cosw = std::cos (w0);
+        const auto alpha = std::sin (w0) / (2.0 * filterQ);
+
+        setStage (0, (1.0 + cosw) / 2.0, -(1.0 + cosw), (1.0 + cosw) / 2.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+    }
+
+    // Stage 1: high cut.
+    if (highCut.getCurrentValue() >= maxHighCut || highCut.getCurrentValue() >= nyquistGuard)
+    {
+        setStage (1, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+    }
+    else
+    {
+        const auto w0 = juce::MathConstants<double>::twoPi * static_cast<double> (highCut.getCurrentValue()) / sampleRate;
+        const auto cosw = std::cos (w0);
+        const auto alpha = std::sin (w0) / (2.0 * filterQ);
+
+        setStage (1, (1.0 - cosw) / 2.0, 1.0 - cosw, (1.0 - cosw) / 2.0, 1.0 + alpha, -2.0 * cosw, 1.0 - alpha);
+    }
+
+    // Stage 2: tilt, a high shelf with half of the gain taken back on the whole band.
+    {
+        const auto A = std::pow (10.0, static_cast<double> (tilt.getCurrentValue()) / 40.0);
+        const auto w0 = juce::MathConstants<double>::twoPi * tiltFrequency / sampleRate;
+        const auto cosw = std::cos (w0);
+        const auto twoSqrtAAlpha = 2.0 * std::sqrt (A) * std::sin (w0) / std::sqrt (2.0);
+
+        setStage (2,
+                  (A + 1.0) + (A - 1.0) * cosw + twoSqrtAAlpha,
+                  -2.0 * ((A - 1.0) + (A + 1.0) * cosw),
+                  (A + 1.0) + (A - 1.0) * cosw - twoSqrtAAlpha,
+                  (A + 1.0) - (A - 1.0) * cosw + twoSqrtAAlpha,
+                  2.0 * ((A - 1.0) - (A + 1.0) * cosw),
+                  (A + 1.0) - (A - 1.0) * cosw - twoSqrtAAlpha);
+    }
+}
+
+template <typename SampleType>
+void FeedbackFilter<SampleType>::setStage (const size_t stage, const double nb0, const double nb1, const double nb2, const double na0, const double na1, const double na2)
+{
+    b0[stage] = static_cast<SampleType> (nb0 / na0);
+    b1[stage] = static_cast<SampleType> (nb1 / na0);
+    b2[stage] = static_cast<SampleType> (nb2 / na0);
+    a1[stage] = static_cast<SampleType> (na1 / na0);
+    a2[stage] = static_cast<SampleType> (na2 / na0);
+}
+
+template class FeedbackFilter<float>;
+template class FeedbackFilter<double>;
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Tone stage of the delay line feedback path: low cut, high cut and tilt biquads in cascade.
+// The stages run in order on every sample, so the stage adds no delay to the repeats.
+// Parameters are smoothed and the coefficients recomputed at block rate by update().
+// While the settings are flat the stage is bypassed and costs nothing.
+template <typename SampleType>
+class FeedbackFilter
+{
+public:
+    static constexpr size_t numStages = 3;
+
+    // Settings leaving the signal unchanged.
+    static constexpr float minLowCut = 20.0f;
+    static constexpr float maxHighCut = 20000.0f;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new FeedbackFilter object.
+     */
+    FeedbackFilter() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param sampleRate: sample rate of the delay line.
+     * @param numChannels: number of channels of the delay line.
+     */
+    void prepare (const double sampleRate, const int numChannels);
+
+    /**
+     * @brief This method clears the state of the biquads.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the target values of the filters, reached by the following calls to update.
+     *
+     * @param newLowCut: cutoff of the highpass expressed in Hz, minLowCut disables it.
+     * @param newHighCut: cutoff of the lowpass expressed in Hz, maxHighCut disables it.
+     * @param newTilt: gain of the high frequencies over the low ones expressed in dB, around 1 kHz.
+     */
+    void setParameters (const float newLowCut, const float newHighCut, const float newTilt);
+
+    /**
+     * @brief This method copies settings, smoothing and state from another filter with the same number of channels.
+     *
+     * @param other: filter to copy from.
+     */
+    void copyFrom (const FeedbackFilter& other);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method tells whether the filter processes the signal, false when the settings are flat.
+     * @return bool
+     */
+    bool isActive() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief Call this method once per block, it moves the smoothing forward and updates the coefficients.
+     *
+     * @param numSamples: number of samples of the block.
+     */
+    void update (const int numSamples);
+
+    /**
+     * @brief This method filters a sample of the given channel.
+     *
+     * @param channel: channel of the sample.
+     * @param sample: input sample.
+     * @return SampleType
+     */
+    SampleType processSample (const int channel, const SampleType sample) noexcept
+    {
+        auto& state = channels[static_cast<size_t> (channel)];
+        auto x = sample;
+
+        for (size_t stage = 0; stage < numStages; ++stage)
+        {
+            // Transposed direct form II.
+            const auto y = b0[stage] * x + state.s1[stage];
+
+            state.s1[stage] = b1[stage] * x - a1[stage] * y + state.s2[stage];
+            state.s2[stage] = b2[stage] * x - a2[stage] * y;
+
+            x = y;
+        }
+
+        return x;
+    }
+
+private:
+    //==========================================================================
+    // Coefficients.
+
+    /**
+     * @brief This method computes the coefficients of every stage from the current smoothed values.
+     */
+    void updateCoefficients();
+
+    /**
+     * @brief This method stores the normalised coefficients of a stage.
+     */
+    void setStage (const size_t stage, const double nb0, const double nb1, const double nb2, const double na0, const double na1, const double na2);
+
+    // Biquad state of a channel.
+    struct Channel
+    {
+        std::array<SampleType, numStages> s1 {};
+        std::array<SampleType, numStages> s2 {};
+    };
+
+    std::array<SampleType, numStages> b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+    std::vector<Channel> channels;
+
+    // Smoothed settings.
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCut { minLowCut };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> highCut { maxHighCut };
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> tilt { 0.0f };
+    bool active = false;
+
+    // Spec.
+    double sampleRate = 44100.0;
+}; // class FeedbackFilter
+
+} // namespace dsp
+} // namespace cdrt
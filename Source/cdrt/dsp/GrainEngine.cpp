@@ -0,0 +1,174 @@
+#include "./GrainEngine.h"
+#include "../utility/Interpolation.h"
+#include "../utility/Tables.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class GrainEngine
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void GrainEngine<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, const int newMaxGrainSamples)
+{
+    jassert (newMaxGrainSamples > 1);
+
+    maxGrainSamples = newMaxGrainSamples;
+
+    // The scratch holds a whole block.
+    scratch.resize (static_cast<size_t> (spec.maximumBlockSize));
+
+    grainSamples = juce::jlimit (2, maxGrainSamples, grainSamples > 0 ? grainSamples : maxGrainSamples);
+    reset();
+}
+
+template <typename SampleType>
+void GrainEngine<SampleType>::reset()
+{
+    for (auto& grain: grains)
+        grain.active = false;
+
+    samplesToNextGrain = 0;
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void GrainEngine<SampleType>::setMode (const Mode newMode)
+{
+    mode = newMode;
+}
+
+template <typename SampleType>
+void GrainEngine<SampleType>::setPitch (const float semitones)
+{
+    ratio = std::pow (2.0, static_cast<double> (semitones) / 12.0);
+}
+
+template <typename SampleType>
+void GrainEngine<SampleType>::setGrainSamples (const int newGrainSamples)
+{
+    // The playing grains end with their own window, only the next ones are longer or shorter.
+    grainSamples = juce::jlimit (2, maxGrainSamples, newGrainSamples);
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+int GrainEngine<SampleType>::getNumActiveGrains() const noexcept
+{
+    return static_cast<int> (std::count_if (grains.begin(), grains.end(), [] (const Grain& grain) { return grain.active; }));
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void GrainEngine<SampleType>::startGrain (const double newest, const double delaySamples, const int bufferSize) noexcept
+{
+    auto* grain = std::find_if (grains.begin(), grains.end(), [] (const Grain& g) { return ! g.active; });
+
+    if (grain == grains.end())
+        grain = std::max_element (grains.begin(), grains.end(), [] (const Grain& a, const Grain& b) { return a.age < b.age; });
+
+    grain->length = grainSamples;
+    grain->age = 0;
+    grain->active = true;
+
+    auto start = newest - delaySamples;
+
+    if (mode == Mode::reverse)
+    {
+        grain->step = -1.0;
+    }
+    else
+    {
+        // Faster grains start further back, the read head must not pass the write head.
+        grain->step = ratio;
+        start -= juce::jmax (0.0, (ratio - 1.0) * static_cast<double> (grainSamples));
+    }
+
+    grain->position = std::fmod (start + 2.0 * static_cast<double> (bufferSize), static_cast<double> (bufferSize));
+}
+
+template <typename SampleType>
+void GrainEngine<SampleType>::process (const DelayLineBase<SampleType>& delayLine, const int channel, SampleType* output, const int numSamples) noexcept
+{
+    const auto* buffer = delayLine.getReadPointer (channel);
+    const auto bufferSize = delayLine.getMaximumDelaySamples();
+    const auto size = static_cast<double> (bufferSize);
+
+    // The longest reach of a grain must stay inside the buffer.
+    const auto delaySamples = juce::jlimit (1.0, size - 2.0 - juce::jmax (2.0, ratio + 1.0) * grainSamples, static_cast<double> (delayLine.getDelaySamples()));
+
+    // Absolute index of the sample written at the start of the block.
+    const auto blockStart = delayLine.getWriteIndex (channel) - numSamples;
+
+    juce::FloatVectorOperations::clear (output, numSamples);
+
+    for (int position = 0; position < numSamples;)
+    {
+        if (samplesToNextGrain <= 0)
+        {
+            startGrain (static_cast<double> (blockStart + position), delaySamples, bufferSize);
+            samplesToNextGrain = juce::jmax (1, grainSamples / 2);
+        }
+
+        // The set of grains doesn't change until the next one starts, longer blocks than the
+        // prepared one are gathered a scratch at a time.
+        const auto segment = juce::jmin (numSamples - position, samplesToNextGrain, static_cast<int> (scratch.size()));
+
+        for (auto& grain: grains)
+        {
+            if (! grain.active)
+                continue;
+
+            const auto count = juce::jmin (segment, grain.length - grain.age);
+            const auto scale = static_cast<SampleType> (1) / static_cast<SampleType> (grain.length);
+
+            // Gather, linear interpolation between the two neighbours.
+            auto readPosition = grain.position;
+
+            for (int i = 0; i < count; ++i)
+            {
+                const auto index = static_cast<int> (readPosition);
+                const auto frac = static_cast<float> (readPosition - static_cast<double> (index));
+                const auto next = index + 1 == bufferSize ? 0 : index + 1;
+
+                // sin^2 (pi x) is the Hann fade in over the first half, read backward over the second one.
+                const auto age = static_cast<SampleType> (grain.age + i) * scale;
+                const auto fade = age < static_cast<SampleType> (0.5) ? 2 * age : 2 - 2 * age;
+                const auto gain = cdrt::utility::tables::getWindowGain<cdrt::utility::tables::Window::hann> (fade);
+
+                scratch[static_cast<size_t> (i)] = gain * cdrt::utility::interpolation::linear<SampleType> (buffer[index], buffer[next], frac);
+
+                readPosition += grain.step;
+
+                if (readPosition >= size)
+                    readPosition -= size;
+                else if (readPosition < 0.0)
+                    readPosition += size;
+            }
+
+            juce::FloatVectorOperations::add (output + position, scratch.data(), count);
+
+            grain.position = readPosition;
+            grain.age += count;
+            grain.active = grain.age < grain.length;
+        }
+
+        position += segment;
+        samplesToNextGrain -= segment;
+    }
+}
+
+template class GrainEngine<float>;
+template class GrainEngine<double>;
+} // namespace dsp
+} // namespace cdrt
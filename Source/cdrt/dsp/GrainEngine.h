@@ -0,0 +1,134 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include "./DelayLine.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Grain based read engine on top of the circular buffer of a delay line, for reverse
+// and pitch shifted echoes. Hann windowed grains start every half grain (the windows
+// sum to 1) at the delay of the line, and read the buffer backward or at a pitch ratio.
+// Grains come from a fixed pool allocated at prepare time: when it is full the oldest
+// grain is replaced, so the work of a block never exceeds maxGrains grains.
+// Each grain gathers its windowed samples in a scratch buffer, the Hann gain is read from the
+// compile time table at the age of the grain over its own length, then the grain is mixed into
+// the output with one vectorized add. A grain keeps the length it started with until it ends.
+// Call process after the delay line wrote the block, it reads what was just written.
+template <typename SampleType>
+class GrainEngine
+{
+public:
+    enum class Mode
+    {
+        reverse,
+        pitch
+    };
+
+    static constexpr int maxGrains = 8;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new GrainEngine object.
+     */
+    GrainEngine() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor, one engine reads one channel.
+     * @param maxGrainSamples: longest grain expressed in samples.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec, const int maxGrainSamples);
+
+    /**
+     * @brief This method stops every grain.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method selects how the grains read the buffer, used by the next grains.
+     *
+     * @param newMode: reverse or pitch.
+     */
+    void setMode (const Mode newMode);
+
+    /**
+     * @brief This method sets the pitch ratio used by the next grains in pitch mode.
+     *
+     * @param semitones: pitch shift expressed in semitones.
+     */
+    void setPitch (const float semitones);
+
+    /**
+     * @brief This method sets the length of the next grains, the playing ones keep theirs.
+     *
+     * @param newGrainSamples: length expressed in samples, limited to the one given at prepare time.
+     */
+    void setGrainSamples (const int newGrainSamples);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the number of grains playing.
+     * @return int
+     */
+    int getNumActiveGrains() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method writes the grains of the block just written in the delay line.
+     *
+     * @param delayLine: delay line to read, the grains start at its delay.
+     * @param channel: channel of the delay line.
+     * @param output: destination of the block, overwritten.
+     * @param numSamples: number of samples of the block, any length.
+     */
+    void process (const DelayLineBase<SampleType>& delayLine, const int channel, SampleType* output, const int numSamples) noexcept;
+
+private:
+    struct Grain
+    {
+        double position = 0.0; // Absolute index in the circular buffer.
+        double step = 1.0;
+        int length = 0;
+        int age = 0;
+        bool active = false;
+    };
+
+    /**
+     * @brief This method starts a grain, replacing the oldest one when the pool is full.
+     *
+     * @param newest: absolute index of the newest sample in the buffer at the start of the grain.
+     * @param delaySamples: delay of the start of the grain.
+     * @param bufferSize: size of the circular buffer.
+     */
+    void startGrain (const double newest, const double delaySamples, const int bufferSize) noexcept;
+
+    //==========================================================================
+    std::array<Grain, maxGrains> grains;
+    std::vector<SampleType> scratch; // Windowed samples read by a grain.
+
+    Mode mode = Mode::reverse;
+    double ratio = 2.0;
+    int grainSamples = 0;
+    int maxGrainSamples = 0;
+    int samplesToNextGrain = 0;
+}; // class GrainEngine
+
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,249 @@
+#include "./LfoBank.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class LfoBank
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void LfoBank<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, const int newNumLfos)
+{
+    jassert (newNumLfos > 0);
+
+    sampleRate = spec.sampleRate;
+    maxBlockSize = static_cast<int> (spec.maximumBlockSize);
+
+    const auto numLfos = static_cast<size_t> (newNumLfos);
+    registersPerLfo = (static_cast<size_t> (maxBlockSize) + SIMDType::size() - 1) / SIMDType::size();
+
+    modulation.assign (numLfos * registersPerLfo, SIMDType::expand (0));
+
+    phase.resize (numLfos);
+    phaseIncrement.resize (numLfos, 0);
+    phaseOffset.resize (numLfos, 0);
+    waveform.resize (numLfos, Waveform::sine);
+    randomStart.resize (numLfos);
+    randomEnd.resize (numLfos);
+
+    reset();
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::reset()
+{
+    std::copy (phaseOffset.begin(), phaseOffset.end(), phase.begin());
+
+    for (size_t lfo = 0; lfo < randomEnd.size(); ++lfo)
+    {
+        randomStart[lfo] = static_cast<SampleType> (0);
+        randomEnd[lfo] = static_cast<SampleType> (random.nextFloat() * 2.0f - 1.0f);
+    }
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void LfoBank<SampleType>::setFrequency (const int lfo, const float frequency)
+{
+    jassert (juce::isPositiveAndBelow (lfo, getNumLfos()));
+    jassert (frequency >= 0.0f && frequency < sampleRate / 4.0);
+
+    phaseIncrement[static_cast<size_t> (lfo)] = static_cast<SampleType> (frequency / sampleRate);
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::setWaveform (const int lfo, const Waveform newWaveform)
+{
+    jassert (juce::isPositiveAndBelow (lfo, getNumLfos()));
+
+    waveform[static_cast<size_t> (lfo)] = newWaveform;
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::setPhaseOffset (const int lfo, const float newPhaseOffset)
+{
+    jassert (juce::isPositiveAndBelow (lfo, getNumLfos()));
+    jassert (newPhaseOffset >= 0.0f && newPhaseOffset < 1.0f);
+
+    phaseOffset[static_cast<size_t> (lfo)] = static_cast<SampleType> (newPhaseOffset);
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+int LfoBank<SampleType>::getNumLfos() const noexcept
+{
+    return static_cast<int> (phase.size());
+}
+
+template <typename SampleType>
+const SampleType* LfoBank<SampleType>::getModulation (const int lfo) const noexcept
+{
+    return reinterpret_cast<const SampleType*> (modulation.data() + static_cast<size_t> (lfo) * registersPerLfo);
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void LfoBank<SampleType>::process (const int numSamples) noexcept
+{
+    jassert (numSamples <= maxBlockSize);
+
+    const auto numRegisters = static_cast<int> ((static_cast<size_t> (numSamples) + SIMDType::size() - 1) / SIMDType::size());
+
+    for (size_t lfo = 0; lfo < phase.size(); ++lfo)
+    {
+        switch (waveform[lfo])
+        {
+            case Waveform::sine:
+                generatePhase (lfo, numSamples);
+                shapeSine (lfo, numRegisters);
+                break;
+
+            case Waveform::triangle:
+                generatePhase (lfo, numSamples);
+                shapeTriangle (lfo, numRegisters);
+                break;
+
+            case Waveform::randomSmooth:
+                shapeRandomSmooth (lfo, numSamples);
+                break;
+        }
+    }
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::generatePhase (const size_t lfo, const int numSamples) noexcept
+{
+    const auto numRegisters = static_cast<int> ((static_cast<size_t> (numSamples) + SIMDType::size() - 1) / SIMDType::size());
+    auto* destination = modulation.data() + lfo * registersPerLfo;
+    const auto increment = phaseIncrement[lfo];
+    const auto one = SIMDType::expand (1);
+
+    // Phase of each lane relative to the first one.
+    SIMDType lanes;
+    for (size_t i = 0; i < SIMDType::size(); ++i)
+        lanes.set (i, static_cast<SampleType> (i) * increment);
+
+    const auto registerIncrement = SIMDType::expand (increment * static_cast<SampleType> (SIMDType::size()));
+    auto current = SIMDType::expand (phase[lfo]) + lanes;
+    current = current - (one & SIMDType::greaterThanOrEqual (current, one));
+
+    for (int i = 0; i < numRegisters; ++i)
+    {
+        destination[i] = current;
+
+        // The increment is below a quarter of a cycle per sample, one wrap is always enough.
+        current = current + registerIncrement;
+        current = current - (one & SIMDType::greaterThanOrEqual (current, one));
+    }
+
+    // The last register can go past the end of the block, the phase is computed from the block length.
+    phase[lfo] += increment * static_cast<SampleType> (numSamples);
+    phase[lfo] -= std::floor (phase[lfo]);
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::shapeSine (const size_t lfo, const int numRegisters) noexcept
+{
+    // Parabolic approximation of sin (2 pi phase) with one refinement step, max error ~0.001.
+    auto* destination = modulation.data() + lfo * registersPerLfo;
+    const auto one = SIMDType::expand (1);
+    const auto two = SIMDType::expand (2);
+    const auto four = SIMDType::expand (4);
+    const auto precision = SIMDType::expand (static_cast<SampleType> (0.225));
+
+    for (int i = 0; i < numRegisters; ++i)
+    {
+        // x in [-1, 1), sin (pi x) = -sin (2 pi phase).
+        const auto x = destination[i] * two - one;
+        const auto y = four * x * (one - SIMDType::abs (x));
+        const auto refined = precision * (y * SIMDType::abs (y) - y) + y;
+
+        destination[i] = SIMDType::expand (0) - refined;
+    }
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::shapeTriangle (const size_t lfo, const int numRegisters) noexcept
+{
+    auto* destination = modulation.data() + lfo * registersPerLfo;
+    const auto one = SIMDType::expand (1);
+    const auto half = SIMDType::expand (static_cast<SampleType> (0.5));
+    const auto four = SIMDType::expand (4);
+
+    for (int i = 0; i < numRegisters; ++i)
+        destination[i] = one - four * SIMDType::abs (destination[i] - half);
+}
+
+template <typename SampleType>
+void LfoBank<SampleType>::shapeRandomSmooth (const size_t lfo, const int numSamples) noexcept
+{
+    // The block is split at the phase wraps, a new random target is drawn at each of them.
+    // Between two wraps the segment is a smoothstep, computed one register at a time.
+    auto* destination = reinterpret_cast<SampleType*> (modulation.data() + lfo * registersPerLfo);
+    const auto increment = phaseIncrement[lfo];
+
+    int start = 0;
+    while (start < numSamples)
+    {
+        // Number of samples before the next wrap.
+        const auto available = static_cast<SampleType> (numSamples - start);
+        const auto remaining = increment > 0 ? juce::jmin (available, std::ceil ((1 - phase[lfo]) / increment)) : available;
+        const auto segmentLength = juce::jmax (1, static_cast<int> (remaining));
+
+        const auto a = randomStart[lfo];
+        const auto b = randomEnd[lfo];
+
+        // Aligned section of the segment vectorized, the unaligned head and tail scalar.
+        int n = start;
+        const auto end = start + segmentLength;
+        auto currentPhase = phase[lfo];
+
+        const auto smoothstep = [] (const auto p, const auto three, const auto two) { return p * p * (three - two * p); };
+
+        for (; n < end && (n % static_cast<int> (SIMDType::size())) != 0; ++n, currentPhase += increment)
+            destination[n] = a + (b - a) * smoothstep (currentPhase, static_cast<SampleType> (3), static_cast<SampleType> (2));
+
+        SIMDType lanes;
+        for (size_t i = 0; i < SIMDType::size(); ++i)
+            lanes.set (i, currentPhase + static_cast<SampleType> (i) * increment);
+
+        const auto registerIncrement = SIMDType::expand (increment * static_cast<SampleType> (SIMDType::size()));
+        for (; n + static_cast<int> (SIMDType::size()) <= end; n += static_cast<int> (SIMDType::size()))
+        {
+            auto shaped = SIMDType::expand (a) + SIMDType::expand (b - a) * smoothstep (lanes, SIMDType::expand (3), SIMDType::expand (2));
+            shaped.copyToRawArray (destination + n);
+
+            lanes = lanes + registerIncrement;
+            currentPhase += increment * static_cast<SampleType> (SIMDType::size());
+        }
+
+        for (; n < end; ++n, currentPhase += increment)
+            destination[n] = a + (b - a) * smoothstep (currentPhase, static_cast<SampleType> (3), static_cast<SampleType> (2));
+
+        phase[lfo] = currentPhase;
+
+        if (phase[lfo] >= 1)
+        {
+            phase[lfo] -= 1;
+            randomStart[lfo] = b;
+            randomEnd[lfo] = static_cast<SampleType> (random.nextFloat() * 2.0f - 1.0f);
+        }
+
+        start = end;
+    }
+}
+
+template class LfoBank<float>;
+template class LfoBank<double>;
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Bank of low frequency oscillators generated block-wise.
+// Each LFO owns a contiguous modulation buffer made of SIMD registers, all the
+// waveforms are computed one register at a time so a whole block of every LFO
+// costs one vectorized pass over the bank storage.
+// Output values are bipolar, in the range [-1, 1].
+template <typename SampleType>
+class LfoBank
+{
+public:
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+
+    // Waveforms available for each LFO.
+    enum class Waveform
+    {
+        sine,
+        triangle,
+        randomSmooth // Smoothstep between a new random value each cycle.
+    };
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new LfoBank object.
+     */
+    LfoBank() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor, only sampleRate and maximumBlockSize are used.
+     * @param newNumLfos: number of LFOs in the bank.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec, const int newNumLfos);
+
+    /**
+     * @brief This method brings every LFO back to its phase offset.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the frequency of an LFO.
+     *
+     * @param lfo: index of the LFO.
+     * @param frequency: frequency expressed in Hz, must be below a quarter of the sample rate.
+     */
+    void setFrequency (const int lfo, const float frequency);
+
+    /**
+     * @brief This method sets the waveform of an LFO.
+     *
+     * @param lfo: index of the LFO.
+     * @param newWaveform: waveform to generate.
+     */
+    void setWaveform (const int lfo, const Waveform newWaveform);
+
+    /**
+     * @brief This method sets the initial phase of an LFO, use it to spread the voices of a chorus.
+     * The phase is applied at the next reset.
+     *
+     * @param lfo: index of the LFO.
+     * @param newPhaseOffset: phase normalised in [0, 1).
+     */
+    void setPhaseOffset (const int lfo, const float newPhaseOffset);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the number of LFOs in the bank.
+     *
+     * @return int
+     */
+    int getNumLfos() const noexcept;
+
+    /**
+     * @brief This method gets the modulation generated by the last call to process.
+     * The pointer is aligned to the SIMD register size.
+     *
+     * @param lfo: index of the LFO.
+     * @return const SampleType*
+     */
+    const SampleType* getModulation (const int lfo) const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method generates the next block of every LFO into the modulation buffers.
+     *
+     * @param numSamples: number of samples to generate, not greater than the maximum block size.
+     */
+    void process (const int numSamples) noexcept;
+
+private:
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method writes the phase ramp of an LFO into its modulation buffer and advances the phase.
+     */
+    void generatePhase (const size_t lfo, const int numSamples) noexcept;
+
+    /**
+     * @brief This method shapes the phase ramp of an LFO in place.
+     */
+    void shapeSine (const size_t lfo, const int numRegisters) noexcept;
+    void shapeTriangle (const size_t lfo, const int numRegisters) noexcept;
+    void shapeRandomSmooth (const size_t lfo, const int numSamples) noexcept;
+
+    //==========================================================================
+    // Modulation storage, registersPerLfo registers for each LFO.
+    std::vector<SIMDType> modulation;
+    size_t registersPerLfo = 0;
+    int maxBlockSize = 0;
+
+    // Spec.
+    double sampleRate = 44100.0;
+
+    // LFO states.
+    std::vector<SampleType> phase;
+    std::vector<SampleType> phaseIncrement;
+    std::vector<SampleType> phaseOffset;
+    std::vector<Waveform> waveform;
+
+    // Random smooth states, segment goes from randomStart to randomEnd.
+    std::vector<SampleType> randomStart;
+    std::vector<SampleType> randomEnd;
+    juce::Random random;
+}; // class LfoBank
+
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,214 @@
+#include "./ModulatedDelay.h"
+#include "../utility/Conversion.h"
+#include "../utility/Trace.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class ModulatedDelay
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    numChannels = static_cast<int> (spec.numChannels);
+
+    lfos.prepare (spec, numChannels * maxVoices);
+    delays.setSize (numChannels * maxVoices, static_cast<int> (spec.maximumBlockSize), false, false, true);
+
+    // The longest mode (chorus) reaches 20 ms, a couple of samples are left for the interpolation.
+    line.prepare (spec);
+    line.setMaxDelaySamples (static_cast<int> (std::ceil (cdrt::utility::conversion::msToSamples<double> (30.0, sampleRate))) + 2);
+    line.setFeedback (0.0f);
+
+    updateVoices();
+    reset();
+}
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::reset()
+{
+    line.reset();
+    previousDepth = depth;
+
+    lfos.reset();
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::setMode (const Mode newMode)
+{
+    if (newMode == mode)
+        return;
+
+    mode = newMode;
+    updateVoices();
+    lfos.reset();
+}
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::setRate (const float newRate)
+{
+    if (juce::approximatelyEqual (rate, newRate))
+        return;
+
+    rate = newRate;
+    updateVoices();
+}
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::setDepth (const float newDepth)
+{
+    jassert (newDepth >= 0.0f && newDepth <= 1.0f);
+
+    depth = newDepth;
+}
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::updateVoices()
+{
+    using Waveform = typename LfoBank<SampleType>::Waveform;
+
+    switch (mode)
+    {
+        case Mode::chorus:
+            centreDelay = 15.0f;
+            maxDepth = 5.0f;
+            numVoices = 3;
+            feedback = static_cast<SampleType> (0);
+            mix = static_cast<SampleType> (0.5);
+            break;
+
+        case Mode::flanger:
+            centreDelay = 2.5f;
+            maxDepth = 2.0f;
+            numVoices = 1;
+            feedback = static_cast<SampleType> (0.6);
+            mix = static_cast<SampleType> (0.5);
+            break;
+
+        case Mode::vibrato:
+            centreDelay = 5.0f;
+            maxDepth = 3.0f;
+            numVoices = 1;
+            feedback = static_cast<SampleType> (0);
+            mix = static_cast<SampleType> (1);
+            break;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int voice = 0; voice < maxVoices; ++voice)
+        {
+            const auto lfo = channel * maxVoices + voice;
+
+            // Voices are spread in phase and slightly detuned, channels are a quarter of cycle apart.
+            const auto phaseOffset = static_cast<float> (voice) / static_cast<float> (numVoices) + 0.25f * static_cast<float> (channel);
+            const auto waveform = mode == Mode::flanger ? Waveform::triangle
+                                                        : (mode == Mode::chorus && voice > 0 ? Waveform::randomSmooth : Waveform::sine);
+
+            lfos.setWaveform (lfo, waveform);
+            lfos.setFrequency (lfo, rate * (1.0f + 0.1f * static_cast<float> (voice)));
+            lfos.setPhaseOffset (lfo, phaseOffset - std::floor (phaseOffset));
+        }
+    }
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::computeDelays (SampleType* destination, const int lfo, const int numSamples) noexcept
+{
+    const auto centreSamples = static_cast<SampleType> (cdrt::utility::conversion::msToSamples<double> (centreDelay, sampleRate));
+    const auto depthSamples = static_cast<SampleType> (cdrt::utility::conversion::msToSamples<double> (maxDepth, sampleRate));
+    const auto* modulation = lfos.getModulation (lfo);
+
+    if (juce::approximatelyEqual (depth, previousDepth))
+    {
+        juce::FloatVectorOperations::copyWithMultiply (destination, modulation, static_cast<SampleType> (depth) * depthSamples, numSamples);
+    }
+    else
+    {
+        // Depth ramp across the block to avoid steps in the delay time.
+        const auto start = static_cast<SampleType> (previousDepth) * depthSamples;
+        const auto step = (static_cast<SampleType> (depth) * depthSamples - start) / static_cast<SampleType> (numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            destination[i] = modulation[i] * (start + step * static_cast<SampleType> (i));
+    }
+
+    juce::FloatVectorOperations::add (destination, centreSamples, numSamples);
+}
+
+template <typename SampleType>
+void ModulatedDelay<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    CDRT_TRACE_SCOPE ("ModulatedDelay::process");
+
+    auto& block = context.getOutputBlock();
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    const auto channels = juce::jmin (static_cast<int> (block.getNumChannels()), numChannels);
+    const auto maxSamples = delays.getNumSamples();
+
+    // The delays of the voices are computed for at most the prepared block size, longer blocks go in parts.
+    if (numSamples > maxSamples)
+    {
+        for (int start = 0; maxSamples > 0 && start < numSamples; start += maxSamples)
+        {
+            auto part = block.getSubBlock (static_cast<size_t> (start), static_cast<size_t> (juce::jmin (maxSamples, numSamples - start)));
+            process (juce::dsp::ProcessContextReplacing<SampleType> (part));
+        }
+
+        return;
+    }
+
+    lfos.process (numSamples);
+
+    const auto voiceGain = static_cast<SampleType> (1) / static_cast<SampleType> (numVoices);
+    const auto dryGain = static_cast<SampleType> (1) - mix;
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        std::array<const SampleType*, maxVoices> voiceDelays {};
+
+        for (int voice = 0; voice < numVoices; ++voice)
+        {
+            const auto index = channel * maxVoices + voice;
+            computeDelays (delays.getWritePointer (index), index, numSamples);
+            voiceDelays[static_cast<size_t> (voice)] = delays.getReadPointer (index);
+        }
+
+        auto* samples = block.getChannelPointer (static_cast<size_t> (channel));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto input = samples[i];
+
+            // The voices are at least a sample long, they are read before the input is written.
+            SampleType wet = 0;
+            for (int voice = 0; voice < numVoices; ++voice)
+                wet += line.readLinearTap (channel, static_cast<float> (voiceDelays[static_cast<size_t> (voice)][i]));
+
+            wet *= voiceGain;
+            line.writeSample (channel, input + feedback * wet);
+            samples[i] = dryGain * input + mix * wet;
+        }
+    }
+
+    previousDepth = depth;
+}
+
+template class ModulatedDelay<float>;
+template class ModulatedDelay<double>;
+} // namespace dsp
+} // namespace cdrt
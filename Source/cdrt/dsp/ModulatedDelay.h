@@ -0,0 +1,134 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include "./DelayLine.h"
+#include "./LfoBank.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Short modulated delay used for chorus, flanger and vibrato effects.
+// The delay of every voice is driven by an LfoBank: the LFOs and the per-sample
+// delay in samples are generated for the whole block with vectorized operations,
+// then a single loop per channel reads all the voices as fractional taps of a
+// DelayLineBase (readLinearTap, no virtual call) and writes the input once.
+template <typename SampleType>
+class ModulatedDelay
+{
+public:
+    // Available effects, each one sets delay, depth, voices, feedback and mix.
+    enum class Mode
+    {
+        chorus,
+        flanger,
+        vibrato
+    };
+
+    static constexpr int maxVoices = 4;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new ModulatedDelay object.
+     */
+    ModulatedDelay() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /**
+     * @brief This method clears the delay buffer and resets the LFOs.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method selects the effect.
+     *
+     * @param newMode: effect to use.
+     */
+    void setMode (const Mode newMode);
+
+    /**
+     * @brief This method sets the frequency of the modulation.
+     *
+     * @param newRate: frequency expressed in Hz.
+     */
+    void setRate (const float newRate);
+
+    /**
+     * @brief This method sets the depth of the modulation.
+     *
+     * @param newDepth: depth normalised in [0, 1], 1 is the full depth of the selected mode.
+     */
+    void setDepth (const float newDepth);
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method processes a block of samples in place, blocks longer than the prepared size are processed in parts.
+     *
+     * @param context: context containing the block to process.
+     */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method converts the LFO output of a voice into delay expressed in samples, in place.
+     *
+     * @param destination: buffer receiving the delay of each sample.
+     * @param lfo: index of the LFO driving the voice.
+     * @param numSamples: number of samples to convert.
+     */
+    void computeDelays (SampleType* destination, const int lfo, const int numSamples) noexcept;
+
+    /**
+     * @brief This method updates the voices and the LFOs after a change of mode or rate.
+     */
+    void updateVoices();
+
+    //==========================================================================
+    // Modulation.
+    LfoBank<SampleType> lfos;
+    juce::AudioBuffer<SampleType> delays; // One channel for each voice of a channel.
+
+    // Delay line holding the input, the voices are its taps.
+    DelayLineNone<SampleType> line;
+
+    // Spec.
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+
+    // Parameters.
+    Mode mode = Mode::chorus;
+    float rate = 0.8f;
+    float depth = 0.5f;
+    float previousDepth = 0.5f;
+
+    // Depending on mode, delays expressed in milliseconds.
+    float centreDelay = 15.0f;
+    float maxDepth = 5.0f;
+    int numVoices = 3;
+    SampleType feedback = 0;
+    SampleType mix = static_cast<SampleType> (0.5);
+}; // class ModulatedDelay
+
+} // namespace dsp
+} // namespace cdrt
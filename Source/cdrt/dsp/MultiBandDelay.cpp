@@ -0,0 +1,245 @@
+#include "./MultiBandDelay.h"
+#include "../utility/Interpolation.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class MultiBandDelay
+
+namespace
+{
+constexpr double butterworthQ = 0.7071067811865476;
+
+enum class Section
+{
+    lowpass,
+    highpass,
+    allpass
+};
+} // namespace
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, const int maxDelaySamples)
+{
+    jassert (spec.numChannels > 0 && spec.numChannels <= maxChannels);
+
+    sampleRate = spec.sampleRate;
+    numChannels = juce::jmin (static_cast<int> (spec.numChannels), maxChannels);
+
+    // Every time index holds the lanes of all the bands, one allocation for all the delay lines.
+    bufferSize = maxDelaySamples + 2;
+    buffer.resize (static_cast<size_t> (bufferSize));
+
+    bandOutputs.setSize (static_cast<int> (frameSize), static_cast<int> (spec.maximumBlockSize), false, false, true);
+
+    updateCoefficients();
+    reset();
+}
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::reset()
+{
+    for (auto& frame: buffer)
+        frame.lanes.fill (0);
+    writeIndex = 0;
+
+    for (auto& stage: stages)
+    {
+        stage.s1.fill (0);
+        stage.s2.fill (0);
+    }
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::setNumBands (const int newNumBands)
+{
+    const auto clamped = juce::jlimit (minBands, maxBands, newNumBands);
+
+    if (clamped == numBands)
+        return;
+
+    numBands = clamped;
+    numActiveRegisters = (static_cast<size_t> (numBands * maxChannels) + numLanes - 1) / numLanes;
+    updateCoefficients();
+}
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::setCrossover (const int index, const float frequency)
+{
+    jassert (index >= 0 && index < maxBands - 1);
+
+    const auto clamped = juce::jlimit (20.0f, static_cast<float> (0.45 * sampleRate), frequency);
+
+    if (clamped == crossovers[static_cast<size_t> (index)])
+        return;
+
+    crossovers[static_cast<size_t> (index)] = clamped;
+    updateCoefficients();
+}
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::setBand (const int band, const float delaySamples, const float feedback)
+{
+    jassert (band >= 0 && band < maxBands);
+
+    for (int channel = 0; channel < maxChannels; ++channel)
+    {
+        const auto lane = static_cast<size_t> (band * maxChannels + channel);
+        delays[lane] = static_cast<SampleType> (juce::jlimit (1.0f, static_cast<float> (bufferSize - 2), delaySamples));
+        feedbacks[lane] = static_cast<SampleType> (feedback);
+    }
+}
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::updateCoefficients()
+{
+    for (int band = 0; band < maxBands; ++band)
+    {
+        for (int crossover = 0; crossover < maxBands - 1; ++crossover)
+        {
+            // Band b: highpass at the crossovers below it, lowpass at its own one, allpass above it.
+            // Crossovers of the inactive bands are unity.
+            const auto active = crossover < numBands - 1;
+            const auto section = crossover < band ? Section::highpass : (crossover == band ? Section::lowpass : Section::allpass);
+
+            const auto k = std::tan (juce::MathConstants<double>::pi * crossovers[static_cast<size_t> (crossover)] / sampleRate);
+            const auto norm = 1.0 / (1.0 + k / butterworthQ + k * k);
+            const auto a1 = 2.0 * (k * k - 1.0) * norm;
+            const auto a2 = (1.0 - k / butterworthQ + k * k) * norm;
+
+            // Linkwitz-Riley: two identical Butterworth biquads, their lowpass and highpass sum to a single allpass biquad.
+            std::array<std::array<double, 5>, 2> coefficients;
+
+            if (! active)
+                coefficients = {{ { 1.0, 0.0, 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0, 0.0, 0.0 } }};
+            else if (section == Section::lowpass)
+                coefficients[0] = coefficients[1] = { k * k * norm, 2.0 * k * k * norm, k * k * norm, a1, a2 };
+            else if (section == Section::highpass)
+                coefficients[0] = coefficients[1] = { norm, -2.0 * norm, norm, a1, a2 };
+            else
+                coefficients = {{ { a2, a1, 1.0, a1, a2 }, { 1.0, 0.0, 0.0, 0.0, 0.0 } }};
+
+            for (size_t i = 0; i < 2; ++i)
+            {
+                auto& stage = stages[static_cast<size_t> (2 * crossover) + i];
+
+                for (int channel = 0; channel < maxChannels; ++channel)
+                {
+                    const auto lane = static_cast<size_t> (band * maxChannels + channel);
+                    stage.b0[lane] = static_cast<SampleType> (coefficients[i][0]);
+                    stage.b1[lane] = static_cast<SampleType> (coefficients[i][1]);
+                    stage.b2[lane] = static_cast<SampleType> (coefficients[i][2]);
+                    stage.a1[lane] = static_cast<SampleType> (coefficients[i][3]);
+                    stage.a2[lane] = static_cast<SampleType> (coefficients[i][4]);
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+int MultiBandDelay<SampleType>::getNumBands() const noexcept
+{
+    return numBands;
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void MultiBandDelay<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    const auto channels = juce::jmin (numChannels, static_cast<int> (block.getNumChannels()));
+    const auto numActiveStages = static_cast<size_t> (2 * (numBands - 1));
+    const auto numActiveLanes = static_cast<size_t> (numBands * maxChannels);
+    const auto maxSamples = bandOutputs.getNumSamples();
+
+    // The bands are stored for at most the prepared block size, longer blocks go in parts.
+    if (numSamples > maxSamples)
+    {
+        for (int start = 0; maxSamples > 0 && start < numSamples; start += maxSamples)
+        {
+            auto part = block.getSubBlock (static_cast<size_t> (start), static_cast<size_t> (juce::jmin (maxSamples, numSamples - start)));
+            process (juce::dsp::ProcessContextReplacing<SampleType> (part));
+        }
+
+        return;
+    }
+
+    alignas (Register::SIMDRegisterSize) Lanes lanes {};
+    alignas (Register::SIMDRegisterSize) Lanes delayed {};
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // Every band of a channel starts from the input of the channel.
+        for (size_t lane = 0; lane < numActiveLanes; ++lane)
+            lanes[lane] = block.getSample (static_cast<int> (lane) % channels, sample);
+
+        // Delayed lanes, linear interpolation between the two samples around the delay of each one.
+        for (size_t lane = 0; lane < numActiveLanes; ++lane)
+        {
+            const auto position = static_cast<SampleType> (writeIndex) - delays[lane];
+            const auto wrapped = position < 0 ? position + static_cast<SampleType> (bufferSize) : position;
+            const auto index = static_cast<int> (wrapped);
+            const auto next = index + 1 == bufferSize ? 0 : index + 1;
+            const auto frac = static_cast<float> (wrapped - static_cast<SampleType> (index));
+
+            delayed[lane] = cdrt::utility::interpolation::linear<SampleType> (buffer[static_cast<size_t> (index)].lanes[lane],
+                                                                               buffer[static_cast<size_t> (next)].lanes[lane], frac);
+            bandOutputs.setSample (static_cast<int> (lane), sample, delayed[lane]);
+        }
+
+        auto* frame = buffer[static_cast<size_t> (writeIndex)].lanes.data();
+
+        for (size_t r = 0; r < numActiveRegisters; ++r)
+        {
+            const auto offset = r * numLanes;
+            auto x = Register::fromRawArray (lanes.data() + offset);
+
+            for (size_t s = 0; s < numActiveStages; ++s)
+            {
+                auto& stage = stages[s];
+                const auto s1 = Register::fromRawArray (stage.s1.data() + offset);
+                const auto s2 = Register::fromRawArray (stage.s2.data() + offset);
+
+                const auto y = Register::fromRawArray (stage.b0.data() + offset) * x + s1;
+                (Register::fromRawArray (stage.b1.data() + offset) * x - Register::fromRawArray (stage.a1.data() + offset) * y + s2).copyToRawArray (stage.s1.data() + offset);
+                (Register::fromRawArray (stage.b2.data() + offset) * x - Register::fromRawArray (stage.a2.data() + offset) * y).copyToRawArray (stage.s2.data() + offset);
+                x = y;
+            }
+
+            // One store writes the band and its repeats for every lane of the register.
+            (x + Register::fromRawArray (feedbacks.data() + offset) * Register::fromRawArray (delayed.data() + offset)).copyToRawArray (frame + offset);
+        }
+
+        writeIndex = writeIndex + 1 == bufferSize ? 0 : writeIndex + 1;
+    }
+
+    // Sum of the bands of every channel.
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        auto* output = block.getChannelPointer (static_cast<size_t> (channel));
+        juce::FloatVectorOperations::copy (output, bandOutputs.getReadPointer (channel), numSamples);
+
+        for (int band = 1; band < numBands; ++band)
+            juce::FloatVectorOperations::add (output, bandOutputs.getReadPointer (band * maxChannels + channel), numSamples);
+    }
+}
+
+template class MultiBandDelay<float>;
+template class MultiBandDelay<double>;
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Multi-band delay: the input is split in 2 to 4 bands by Linkwitz-Riley (4th order) crossovers
+// and every band has its own delay and feedback, the output is the sum of the delayed bands.
+// Every band of every channel is a lane of SIMDRegisters (lane = band * maxChannels + channel)
+// fed with the input of its channel: band b goes through a highpass at the crossovers below it,
+// the lowpass at its own crossover and the allpass of the crossovers above it, so the sum of
+// the bands is allpass. Each crossover is two biquads (the allpass is one biquad and a unity
+// one), the same cascade runs on all the lanes with per lane coefficients and only the
+// registers holding active bands are processed.
+// The delay lines of all the lanes share one interleaved buffer: the filtered lanes are
+// written with one store per register and every lane reads its own delay.
+template <typename SampleType>
+class MultiBandDelay
+{
+public:
+    using Register = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int minBands = 2;
+    static constexpr int maxBands = 4;
+    static constexpr int maxChannels = 2;
+    static constexpr int maxStages = 2 * (maxBands - 1); // Biquads of the cascade of a band.
+    static constexpr size_t numLanes = Register::SIMDNumElements;
+    static constexpr size_t numRegisters = (maxBands * maxChannels + numLanes - 1) / numLanes;
+    static constexpr size_t frameSize = numRegisters * numLanes; // Samples of a time index in the buffer.
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new MultiBandDelay object.
+     */
+    MultiBandDelay() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor, maxChannels at most.
+     * @param maxDelaySamples: longest delay of a band expressed in samples.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec, const int maxDelaySamples);
+
+    /**
+     * @brief This method clears the buffer and the state of the crossovers.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the number of bands, the crossover frequencies keep their values.
+     *
+     * @param newNumBands: number of bands in [minBands, maxBands].
+     */
+    void setNumBands (const int newNumBands);
+
+    /**
+     * @brief This method sets the frequency of a crossover, the crossovers must be in increasing order.
+     *
+     * @param index: index of the crossover, from 0 to numBands - 2.
+     * @param frequency: crossover frequency expressed in Hz.
+     */
+    void setCrossover (const int index, const float frequency);
+
+    /**
+     * @brief This method sets the delay and the feedback of a band.
+     *
+     * @param band: index of the band, 0 is the lowest.
+     * @param delaySamples: delay expressed in samples, linearly interpolated.
+     * @param feedback: feedback of the band.
+     */
+    void setBand (const int band, const float delaySamples, const float feedback);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the number of bands.
+     * @return int
+     */
+    int getNumBands() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method processes a block of samples in place, the output is the sum of the delayed bands.
+     * Blocks longer than the prepared size are processed in parts.
+     *
+     * @param context: context containing the block to process.
+     */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    using Lanes = std::array<SampleType, frameSize>;
+
+    /**
+     * @brief This method computes the coefficients of every lane after a change of bands or crossovers.
+     */
+    void updateCoefficients();
+
+    //==========================================================================
+    // Crossovers, transposed direct form II biquads, coefficients and state of every lane.
+    struct Stage
+    {
+        alignas (Register::SIMDRegisterSize) Lanes b0 {}, b1 {}, b2 {}, a1 {}, a2 {};
+        alignas (Register::SIMDRegisterSize) Lanes s1 {}, s2 {};
+    };
+
+    std::array<Stage, maxStages> stages;
+    std::array<float, maxBands - 1> crossovers { 200.0f, 1000.0f, 5000.0f };
+
+    // Delay, interleaved: one aligned frame holds the lanes of a time index.
+    struct alignas (Register::SIMDRegisterSize) Frame
+    {
+        Lanes lanes {};
+    };
+
+    std::vector<Frame> buffer;
+    int bufferSize = 0;
+    int writeIndex = 0;
+    alignas (Register::SIMDRegisterSize) Lanes delays {};
+    alignas (Register::SIMDRegisterSize) Lanes feedbacks {};
+
+    // Delayed samples of every lane for the block, summed per channel at the end.
+    juce::AudioBuffer<SampleType> bandOutputs;
+
+    double sampleRate = 44100.0;
+    int numChannels = 0;
+    int numBands = minBands;
+    size_t numActiveRegisters = 1;
+}; // class MultiBandDelay
+
+} // namespace dsp
+} // namespace cdrt
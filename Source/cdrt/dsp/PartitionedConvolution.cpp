@@ -0,0 +1,436 @@
+#include "./PartitionedConvolution.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class PartitionedConvolution
+
+namespace
+{
+constexpr int headFftOrder = 7;  // 2 * headBlockSize.
+constexpr int tailFftOrder = 11; // 2 * tailBlockSize.
+
+// Non negative bins of a real only forward transform, real and imaginary parts in separate arrays.
+void splitSpectrum (const float* fftData, float* real, float* imag, const int numBins) noexcept
+{
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        real[bin] = fftData[2 * bin];
+        imag[bin] = fftData[2 * bin + 1];
+    }
+}
+
+// Full spectrum for the real only inverse transform, the negative frequencies are the conjugates.
+void joinSpectrum (const float* real, const float* imag, float* fftData, const int numBins) noexcept
+{
+    const auto fftSize = 2 * (numBins - 1);
+
+    for (int bin = 0; bin < fftSize; ++bin)
+    {
+        const auto source = bin < numBins ? bin : fftSize - bin;
+        fftData[2 * bin] = real[source];
+        fftData[2 * bin + 1] = bin < numBins ? imag[source] : -imag[source];
+    }
+}
+
+// accumulator += a * b, complex, vectorized by the compiler over the bins.
+void multiplyAccumulate (float* accumulatorReal, float* accumulatorImag,
+                         const float* aReal, const float* aImag, const float* bReal, const float* bImag, const int numBins) noexcept
+{
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        accumulatorReal[bin] += aReal[bin] * bReal[bin] - aImag[bin] * bImag[bin];
+        accumulatorImag[bin] += aReal[bin] * bImag[bin] + aImag[bin] * bReal[bin];
+    }
+}
+
+// Spectra of the partitions of an impulse response, zero padded to twice the partition size.
+void makePartitions (juce::dsp::FFT& fft, const float* impulse, const int numSamples, const int partitionSize,
+                     const int numPartitions, float* real, float* imag)
+{
+    const auto numBins = partitionSize + 1;
+    std::vector<float> fftData (static_cast<size_t> (4 * partitionSize));
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const auto start = partition * partitionSize;
+        const auto count = juce::jlimit (0, partitionSize, numSamples - start);
+
+        std::fill (fftData.begin(), fftData.end(), 0.0f);
+        std::copy (impulse + start, impulse + start + count, fftData.begin());
+        fft.performRealOnlyForwardTransform (fftData.data(), true);
+        splitSpectrum (fftData.data(), real + partition * numBins, imag + partition * numBins, numBins);
+    }
+}
+} // namespace
+
+//==============================================================================
+// Default constructor.
+
+PartitionedConvolution::PartitionedConvolution()
+    : headFft (headFftOrder), tailFft (tailFftOrder)
+{
+    static_assert ((1 << headFftOrder) == 2 * headBlockSize && (1 << tailFftOrder) == 2 * tailBlockSize);
+    static_assert (tailBlockSize % headBlockSize == 0);
+}
+
+//==============================================================================
+// Destructor.
+
+PartitionedConvolution::~PartitionedConvolution()
+{
+    if (tailThread == nullptr)
+        return;
+
+    // The sleeping thread is woken by a new generation.
+    tailThread->signalThreadShouldExit();
+    tailGeneration.fetch_add (1, std::memory_order_release);
+    tailGeneration.notify_one();
+    tailThread->stopThread (1000);
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+void PartitionedConvolution::prepare (const juce::dsp::ProcessSpec& spec, const int maxImpulseSamples)
+{
+    jassert (spec.numChannels > 0);
+
+    // The running job reads the buffers reallocated below.
+    if (tailJobRunning)
+        finishTailJob();
+
+    tailJobRunning = false;
+
+    maxHeadPartitions = (tailOffset - headBlockSize) / headBlockSize;
+    maxTailPartitions = juce::jmax (0, (maxImpulseSamples - tailOffset + tailBlockSize - 1) / tailBlockSize);
+
+    channels.resize (spec.numChannels);
+
+    for (auto& channel: channels)
+    {
+        channel.direct.assign (static_cast<size_t> (headBlockSize), 0.0f);
+        channel.headFrame.resize (static_cast<size_t> (2 * headBlockSize));
+        channel.headOutput.resize (static_cast<size_t> (headBlockSize));
+        channel.headFilterReal.assign (static_cast<size_t> (maxHeadPartitions * headBins), 0.0f);
+        channel.headFilterImag.assign (static_cast<size_t> (maxHeadPartitions * headBins), 0.0f);
+        channel.headHistoryReal.resize (static_cast<size_t> (maxHeadPartitions * headBins));
+        channel.headHistoryImag.resize (static_cast<size_t> (maxHeadPartitions * headBins));
+
+        channel.tailFrame.resize (static_cast<size_t> (2 * tailBlockSize));
+        channel.tailFftData.resize (static_cast<size_t> (4 * tailBlockSize));
+        channel.tailFilterReal.assign (static_cast<size_t> (maxTailPartitions * tailBins), 0.0f);
+        channel.tailFilterImag.assign (static_cast<size_t> (maxTailPartitions * tailBins), 0.0f);
+        channel.tailHistoryReal.resize (static_cast<size_t> (maxTailPartitions * tailBins));
+        channel.tailHistoryImag.resize (static_cast<size_t> (maxTailPartitions * tailBins));
+        channel.tailAccumulatorReal.resize (static_cast<size_t> (tailBins));
+        channel.tailAccumulatorImag.resize (static_cast<size_t> (tailBins));
+
+        for (auto& output: channel.tailOutputs)
+            output.resize (static_cast<size_t> (tailBlockSize));
+    }
+
+    headFftData.resize (static_cast<size_t> (4 * headBlockSize));
+    headAccumulatorReal.resize (static_cast<size_t> (headBins));
+    headAccumulatorImag.resize (static_cast<size_t> (headBins));
+
+    numDirectTaps = 0;
+    numHeadPartitions = 0;
+    numTailPartitions = 0;
+    numTailTasks = 0;
+
+    // Below the audio thread, the tail has a whole block to be computed.
+    if (tailThread == nullptr)
+    {
+        tailThread = std::make_unique<TailThread> (*this);
+        tailThread->startThread (juce::Thread::Priority::high);
+    }
+
+    reset();
+}
+
+void PartitionedConvolution::reset() noexcept
+{
+    if (tailJobRunning)
+        finishTailJob();
+
+    for (auto& channel: channels)
+    {
+        for (auto* data: { &channel.headFrame, &channel.headOutput, &channel.headHistoryReal, &channel.headHistoryImag,
+                           &channel.tailFrame, &channel.tailHistoryReal, &channel.tailHistoryImag,
+                           &channel.tailOutputs[0], &channel.tailOutputs[1] })
+            std::fill (data->begin(), data->end(), 0.0f);
+    }
+
+    headPosition = 0;
+    tailPosition = 0;
+    headSlot = 0;
+    tailSlot = 0;
+    tailReadOutput = 0;
+    tailJobRunning = false;
+}
+
+//==============================================================================
+// Setters.
+
+void PartitionedConvolution::setImpulseResponse (const float* const* impulse, const int numImpulseChannels, const int numImpulseSamples)
+{
+    jassert (numImpulseChannels > 0);
+    jassert (numImpulseSamples <= tailOffset + maxTailPartitions * tailBlockSize);
+
+    reset();
+
+    const auto length = juce::jmin (numImpulseSamples, tailOffset + maxTailPartitions * tailBlockSize);
+    numDirectTaps = juce::jmin (length, headBlockSize);
+    numHeadPartitions = juce::jlimit (0, maxHeadPartitions, (length - headBlockSize + headBlockSize - 1) / headBlockSize);
+    numTailPartitions = juce::jlimit (0, maxTailPartitions, (length - tailOffset + tailBlockSize - 1) / tailBlockSize);
+
+    // Forward FFT, up to maxTailGroups groups of partitions, inverse FFT.
+    numTailTasks = numTailPartitions > 0 ? juce::jmin (numTailPartitions, maxTailGroups) + 2 : 0;
+
+    for (size_t index = 0; index < channels.size(); ++index)
+    {
+        auto& channel = channels[index];
+        const auto* samples = impulse[juce::jmin (static_cast<int> (index), numImpulseChannels - 1)];
+
+        std::fill (channel.direct.begin(), channel.direct.end(), 0.0f);
+        std::copy (samples, samples + numDirectTaps, channel.direct.begin());
+
+        makePartitions (headFft, samples + numDirectTaps, length - numDirectTaps, headBlockSize, numHeadPartitions,
+                        channel.headFilterReal.data(), channel.headFilterImag.data());
+
+        if (numTailPartitions > 0)
+            makePartitions (tailFft, samples + tailOffset, length - tailOffset, tailBlockSize, numTailPartitions,
+                            channel.tailFilterReal.data(), channel.tailFilterImag.data());
+    }
+}
+
+//==============================================================================
+// Getters.
+
+int PartitionedConvolution::getNumLateTasks() const noexcept
+{
+    return numLateTasks.load (std::memory_order_relaxed);
+}
+
+//==============================================================================
+// Processing.
+
+void PartitionedConvolution::process (const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), static_cast<int> (channels.size()));
+
+    for (int position = 0; position < numSamples;)
+    {
+        // Head blocks end together with the tail ones, one block boundary at most.
+        const auto count = juce::jmin (numSamples - position, headBlockSize - headPosition);
+
+        for (int index = 0; index < numChannels; ++index)
+        {
+            auto& channel = channels[static_cast<size_t> (index)];
+            auto* samples = block.getChannelPointer (static_cast<size_t> (index)) + position;
+            auto* input = channel.headFrame.data() + headBlockSize + headPosition;
+
+            // The block is replaced in place, the input is stored before the output overwrites it.
+            juce::FloatVectorOperations::copy (input, samples, count);
+            juce::FloatVectorOperations::copy (channel.tailFrame.data() + tailBlockSize + tailPosition, samples, count);
+
+            // Body and tail, computed at the previous block boundaries.
+            juce::FloatVectorOperations::copy (samples, channel.headOutput.data() + headPosition, count);
+            juce::FloatVectorOperations::add (samples, channel.tailOutputs[static_cast<size_t> (tailReadOutput)].data() + tailPosition, count);
+
+            // Head, one multiply-add over the samples for each tap, the previous block is in the frame.
+            for (int tap = 0; tap < numDirectTaps; ++tap)
+                juce::FloatVectorOperations::addWithMultiply (samples, input - tap, channel.direct[static_cast<size_t> (tap)], count);
+        }
+
+        headPosition += count;
+        tailPosition += count;
+        position += count;
+
+        if (headPosition == headBlockSize)
+            processHeadBlock();
+
+        if (tailPosition == tailBlockSize)
+            processTailBlock();
+    }
+}
+
+void PartitionedConvolution::processHeadBlock() noexcept
+{
+    headPosition = 0;
+    headSlot = numHeadPartitions > 0 ? (headSlot + 1) % numHeadPartitions : 0;
+
+    for (auto& channel: channels)
+    {
+        if (numHeadPartitions == 0)
+        {
+            // The head taps still read the previous block.
+            std::copy (channel.headFrame.begin() + headBlockSize, channel.headFrame.end(), channel.headFrame.begin());
+            continue;
+        }
+
+        // Overlap-save frame: previous and current block.
+        std::copy (channel.headFrame.begin(), channel.headFrame.end(), headFftData.begin());
+        headFft.performRealOnlyForwardTransform (headFftData.data(), true);
+        splitSpectrum (headFftData.data(), channel.headHistoryReal.data() + headSlot * headBins,
+                       channel.headHistoryImag.data() + headSlot * headBins, headBins);
+
+        // Partition k filters the block k blocks ago.
+        std::fill (headAccumulatorReal.begin(), headAccumulatorReal.end(), 0.0f);
+        std::fill (headAccumulatorImag.begin(), headAccumulatorImag.end(), 0.0f);
+
+        for (int partition = 0; partition < numHeadPartitions; ++partition)
+        {
+            const auto slot = (headSlot - partition + numHeadPartitions) % numHeadPartitions;
+            multiplyAccumulate (headAccumulatorReal.data(), headAccumulatorImag.data(),
+                                channel.headHistoryReal.data() + slot * headBins, channel.headHistoryImag.data() + slot * headBins,
+                                channel.headFilterReal.data() + partition * headBins, channel.headFilterImag.data() + partition * headBins, headBins);
+        }
+
+        // The second half is the valid one, it starts headBlockSize taps in: next block.
+        joinSpectrum (headAccumulatorReal.data(), headAccumulatorImag.data(), headFftData.data(), headBins);
+        headFft.performRealOnlyInverseTransform (headFftData.data());
+        std::copy (headFftData.begin() + headBlockSize, headFftData.begin() + 2 * headBlockSize, channel.headOutput.begin());
+
+        std::copy (channel.headFrame.begin() + headBlockSize, channel.headFrame.end(), channel.headFrame.begin());
+    }
+}
+
+void PartitionedConvolution::processTailBlock() noexcept
+{
+    tailPosition = 0;
+
+    // Deadline of the job started one block ago, its output starts now.
+    if (tailJobRunning)
+    {
+        finishTailJob();
+        tailReadOutput = 1 - tailReadOutput;
+    }
+
+    tailJobRunning = false;
+
+    for (auto& channel: channels)
+    {
+        if (numTailPartitions > 0)
+            std::copy (channel.tailFrame.begin(), channel.tailFrame.end(), channel.tailFftData.begin());
+
+        std::copy (channel.tailFrame.begin() + tailBlockSize, channel.tailFrame.end(), channel.tailFrame.begin());
+    }
+
+    if (numTailPartitions == 0)
+        return;
+
+    tailSlot = (tailSlot + 1) % numTailPartitions;
+    tailJobRunning = true;
+
+    // Published by the release store, tasks are claimed from 0 by both threads.
+    completedTailTasks.store (0, std::memory_order_relaxed);
+    nextTailTask.store (0, std::memory_order_release);
+    tailGeneration.fetch_add (1, std::memory_order_release);
+    tailGeneration.notify_one();
+}
+
+bool PartitionedConvolution::runNextTailTask() noexcept
+{
+    const auto task = nextTailTask.fetch_add (1, std::memory_order_acq_rel);
+
+    if (task >= numTailTasks)
+        return false;
+
+    // Tasks depend on the previous ones, the other thread may be running the last one.
+    while (completedTailTasks.load (std::memory_order_acquire) < task) {}
+
+    runTailTask (task);
+    completedTailTasks.store (task + 1, std::memory_order_release);
+    return true;
+}
+
+void PartitionedConvolution::finishTailJob() noexcept
+{
+    while (runNextTailTask())
+        numLateTasks.fetch_add (1, std::memory_order_relaxed);
+
+    while (completedTailTasks.load (std::memory_order_acquire) < numTailTasks) {}
+
+    // A late wake up of the background thread must not claim tasks until the next job.
+    nextTailTask.store (noTailJob, std::memory_order_relaxed);
+}
+
+void PartitionedConvolution::runTailTask (const int task) noexcept
+{
+    const auto numGroups = numTailTasks - 2;
+
+    if (task == 0)
+    {
+        for (auto& channel: channels)
+        {
+            tailFft.performRealOnlyForwardTransform (channel.tailFftData.data(), true);
+            splitSpectrum (channel.tailFftData.data(), channel.tailHistoryReal.data() + tailSlot * tailBins,
+                           channel.tailHistoryImag.data() + tailSlot * tailBins, tailBins);
+
+            std::fill (channel.tailAccumulatorReal.begin(), channel.tailAccumulatorReal.end(), 0.0f);
+            std::fill (channel.tailAccumulatorImag.begin(), channel.tailAccumulatorImag.end(), 0.0f);
+        }
+    }
+    else if (task <= numGroups)
+    {
+        const auto firstPartition = (task - 1) * numTailPartitions / numGroups;
+        const auto lastPartition = task * numTailPartitions / numGroups;
+
+        for (auto& channel: channels)
+        {
+            for (int partition = firstPartition; partition < lastPartition; ++partition)
+            {
+                const auto slot = (tailSlot - partition + numTailPartitions) % numTailPartitions;
+                multiplyAccumulate (channel.tailAccumulatorReal.data(), channel.tailAccumulatorImag.data(),
+                                    channel.tailHistoryReal.data() + slot * tailBins, channel.tailHistoryImag.data() + slot * tailBins,
+                                    channel.tailFilterReal.data() + partition * tailBins, channel.tailFilterImag.data() + partition * tailBins, tailBins);
+            }
+        }
+    }
+    else
+    {
+        for (auto& channel: channels)
+        {
+            // The second half is the valid one, it is played two blocks after its input block.
+            joinSpectrum (channel.tailAccumulatorReal.data(), channel.tailAccumulatorImag.data(), channel.tailFftData.data(), tailBins);
+            tailFft.performRealOnlyInverseTransform (channel.tailFftData.data());
+
+            auto& output = channel.tailOutputs[static_cast<size_t> (1 - tailReadOutput)];
+            std::copy (channel.tailFftData.begin() + tailBlockSize, channel.tailFftData.begin() + 2 * tailBlockSize, output.begin());
+        }
+    }
+}
+
+//==============================================================================
+// class PartitionedConvolution::TailThread
+
+PartitionedConvolution::TailThread::TailThread (PartitionedConvolution& owner)
+    : juce::Thread ("cdrt convolution"), convolution (owner)
+{
+}
+
+void PartitionedConvolution::TailThread::run()
+{
+    auto seen = convolution.tailGeneration.load (std::memory_order_acquire);
+
+    while (! threadShouldExit())
+    {
+        // The deadline is a whole block away, no spinning.
+        convolution.tailGeneration.wait (seen, std::memory_order_acquire);
+        seen = convolution.tailGeneration.load (std::memory_order_acquire);
+
+        if (threadShouldExit())
+            return;
+
+        while (convolution.runNextTailTask()) {}
+    }
+}
+
+} // namespace dsp
+} // namespace cdrt
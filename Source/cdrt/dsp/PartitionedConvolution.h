@@ -0,0 +1,190 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Zero latency convolution with non-uniform partitions.
+// The impulse response is split in three parts:
+// - head: the first headBlockSize taps, direct form, vectorized over the samples;
+// - body: taps up to tailOffset, uniform partitions of headBlockSize (FFT of twice the size,
+//   overlap-save, frequency domain delay line) computed on the audio thread at the end of
+//   every head block, its output is played during the next one;
+// - tail: the remaining taps, uniform partitions of tailBlockSize computed on a background
+//   thread. The job of an input block is started at its end and its output is needed one
+//   tail block later (the tail starts two blocks after the input), that is its deadline.
+// The tail job is split in ordered tasks (forward FFT, groups of partitions, inverse FFT):
+// the background thread runs them as soon as the job starts, at the deadline the audio
+// thread runs the tasks left, so a late background thread costs CPU but never a glitch.
+// The work of the audio thread is the same for every head block whatever the length of the
+// impulse response. juce::dsp::FFT is single precision, so the class is not a template.
+class PartitionedConvolution
+{
+public:
+    static constexpr int headBlockSize = 64;
+    static constexpr int tailBlockSize = 1024;
+    static constexpr int tailOffset = 2 * tailBlockSize;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new PartitionedConvolution object, the background thread is started by prepare.
+     */
+    PartitionedConvolution();
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * PartitionedConvolution destructor, stops the background thread.
+     */
+    ~PartitionedConvolution();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor.
+     * @param maxImpulseSamples: length of the longest impulse response.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec, const int maxImpulseSamples);
+
+    /**
+     * @brief This method clears the input history and the pending outputs, the impulse response is kept.
+     */
+    void reset() noexcept;
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the impulse response and resets the processor. Not real-time safe,
+     * call it after prepare and never while process is running.
+     *
+     * @param impulse: channels of the impulse response, the last one is used by the channels above it.
+     * @param numImpulseChannels: number of channels of the impulse response.
+     * @param numImpulseSamples: length of the impulse response, maxImpulseSamples at most.
+     */
+    void setImpulseResponse (const float* const* impulse, const int numImpulseChannels, const int numImpulseSamples);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the number of tail tasks run by the audio thread because their deadline came first.
+     * @return int
+     */
+    int getNumLateTasks() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method processes a block of samples in place, the output is the convolution only.
+     *
+     * @param context: context containing the block to process.
+     */
+    void process (const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+
+private:
+    static constexpr int headBins = headBlockSize + 1;
+    static constexpr int tailBins = tailBlockSize + 1;
+    static constexpr int maxTailGroups = 8;
+    static constexpr int noTailJob = 1 << 30; // Claimed tasks count from here between jobs.
+
+    struct Channel
+    {
+        std::vector<float> direct;                    // Head taps.
+        std::vector<float> headFrame;                 // Last two head blocks of input.
+        std::vector<float> headOutput;                // Body output played during the head block.
+        std::vector<float> headFilterReal, headFilterImag;   // Body partitions, numHeadPartitions of headBins.
+        std::vector<float> headHistoryReal, headHistoryImag; // Spectra of the last numHeadPartitions input blocks.
+
+        std::vector<float> tailFrame;                 // Last two tail blocks of input.
+        std::vector<float> tailFftData;               // Frame of the running job, 2 * tailFftSize.
+        std::vector<float> tailFilterReal, tailFilterImag;
+        std::vector<float> tailHistoryReal, tailHistoryImag;
+        std::vector<float> tailAccumulatorReal, tailAccumulatorImag;
+        std::array<std::vector<float>, 2> tailOutputs; // Played and being computed.
+    };
+
+    class TailThread : public juce::Thread
+    {
+    public:
+        explicit TailThread (PartitionedConvolution& owner);
+        void run() override;
+
+    private:
+        PartitionedConvolution& convolution;
+    };
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method computes the body output of the next head block.
+     */
+    void processHeadBlock() noexcept;
+
+    /**
+     * @brief This method finishes the running tail job, plays its output and starts the job of the last tail block.
+     */
+    void processTailBlock() noexcept;
+
+    /**
+     * @brief This method runs the next task of the tail job, waiting for the previous one when it runs on the other thread.
+     * @return bool: false when no task is left.
+     */
+    bool runNextTailTask() noexcept;
+
+    /**
+     * @brief This method runs the tasks of the tail job left and waits for the running one.
+     */
+    void finishTailJob() noexcept;
+
+    /**
+     * @brief This method runs one task of the tail job on every channel.
+     *
+     * @param task: index of the task.
+     */
+    void runTailTask (const int task) noexcept;
+
+    //==========================================================================
+    juce::dsp::FFT headFft;
+    juce::dsp::FFT tailFft;
+    std::vector<Channel> channels;
+    std::vector<float> headFftData;
+    std::vector<float> headAccumulatorReal, headAccumulatorImag;
+
+    int maxHeadPartitions = 0;
+    int maxTailPartitions = 0;
+    int numDirectTaps = 0;
+    int numHeadPartitions = 0;
+    int numTailPartitions = 0;
+    int numTailTasks = 0;
+
+    int headPosition = 0;
+    int tailPosition = 0;
+    int headSlot = 0;       // Slot of the head history written by the last head block.
+    int tailSlot = 0;       // Slot of the tail history written by the running job.
+    int tailReadOutput = 0; // Tail output played, the job writes the other one.
+    bool tailJobRunning = false;
+
+    // The job is published by the release store of nextTailTask and woken by the generation.
+    std::atomic<int> nextTailTask { noTailJob };
+    std::atomic<int> completedTailTasks { 0 };
+    std::atomic<juce::uint32> tailGeneration { 0 };
+    std::atomic<int> numLateTasks { 0 };
+    std::unique_ptr<TailThread> tailThread;
+}; // class PartitionedConvolution
+
+} // namespace dsp
+} // namespace cdrt
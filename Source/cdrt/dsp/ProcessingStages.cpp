@@ -0,0 +1,130 @@
+#include "./ProcessingStages.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class CallbackStage
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void CallbackStage<SampleType>::prepare (const juce::dsp::ProcessSpec& spec) noexcept
+{
+    juce::ignoreUnused (spec);
+}
+
+template <typename SampleType>
+void CallbackStage<SampleType>::reset() noexcept
+{
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void CallbackStage<SampleType>::setCallback (Callback newCallback, void* newContext) noexcept
+{
+    callback = newCallback;
+    callbackContext = newContext;
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void CallbackStage<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    if (callback != nullptr && ! context.isBypassed)
+        callback (callbackContext, context.getOutputBlock());
+}
+
+template class CallbackStage<float>;
+template class CallbackStage<double>;
+
+//==============================================================================
+// class MixStage
+
+//==============================================================================
+// Default constructor.
+
+template <typename SampleType>
+MixStage<SampleType>::MixStage()
+{
+    mixer.setMixingRule (juce::dsp::DryWetMixingRule::linear);
+    mixer.setWetMixProportion (wetProportion);
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void MixStage<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    mixer.prepare (spec);
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::reset()
+{
+    mixer.reset();
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void MixStage<SampleType>::setLevels (const SampleType newDry, const SampleType newWet) noexcept
+{
+    mixLevel = newDry + newWet;
+
+    // Both silent: any proportion, the level is 0.
+    if (mixLevel > 0)
+        wetProportion = newWet / mixLevel;
+
+    mixer.setWetMixProportion (wetProportion);
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::setWetLatency (const int latencySamples) noexcept
+{
+    jassert (latencySamples <= maxWetLatencySamples);
+    mixer.setWetLatency (static_cast<SampleType> (juce::jlimit (0, maxWetLatencySamples, latencySamples)));
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+SampleType MixStage<SampleType>::getMixLevel() const noexcept
+{
+    return mixLevel;
+}
+
+template <typename SampleType>
+SampleType MixStage<SampleType>::getWetProportion() const noexcept
+{
+    return wetProportion;
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+void MixStage<SampleType>::pushDrySamples (const juce::dsp::AudioBlock<const SampleType>& block)
+{
+    mixer.pushDrySamples (block);
+}
+
+template <typename SampleType>
+void MixStage<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    mixer.mixWetSamples (context.getOutputBlock());
+}
+
+template class MixStage<float>;
+template class MixStage<double>;
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Stages of the juce::dsp::ProcessorChain of the plugin, with juce::dsp::Gain for the input
+// and output gains. Every stage processes the whole block in place, one pass per channel.
+
+//==============================================================================
+// Stage running a function of its owner on the block, the delay lines and the effects of
+// the wet path live in the processor. Function and context as in utility::WorkerPool.
+template <typename SampleType>
+class CallbackStage
+{
+public:
+    using Callback = void (*) (void* context, const juce::dsp::AudioBlock<SampleType>& block);
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new CallbackStage object, the block is left untouched until a callback is set.
+     */
+    CallbackStage() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Nothing to prepare, the owner prepares what the callback uses.
+     *
+     * @param spec: context informations for processor.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec) noexcept;
+
+    /**
+     * @brief Nothing to reset, the owner resets what the callback uses.
+     */
+    void reset() noexcept;
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the function processing the block.
+     *
+     * @param newCallback: function called with the block.
+     * @param newContext: first argument of every call.
+     */
+    void setCallback (Callback newCallback, void* newContext) noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method processes a block of samples in place with the callback.
+     *
+     * @param context: context containing the block to process.
+     */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    Callback callback = nullptr;
+    void* callbackContext = nullptr;
+}; // class CallbackStage
+
+//==============================================================================
+// Dry/wet stage on juce::dsp::DryWetMixer, the dry block is pushed before the chain processes
+// the wet one. The independent dry and wet levels of the plugin are a linear mix of proportion
+// wet / (dry + wet) followed by a gain of dry + wet, applied by the output gain stage.
+template <typename SampleType>
+class MixStage
+{
+public:
+    static constexpr int maxWetLatencySamples = 4096;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new MixStage object, linear mixing rule.
+     */
+    MixStage();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /**
+     * @brief This method clears the dry samples and jumps to the target levels.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the dry and wet levels, the mix proportion is smoothed.
+     *
+     * @param newDry: gain of the dry signal.
+     * @param newWet: gain of the wet signal.
+     */
+    void setLevels (const SampleType newDry, const SampleType newWet) noexcept;
+
+    /**
+     * @brief This method sets the latency of the wet path, the dry signal is delayed to match.
+     *
+     * @param latencySamples: latency expressed in samples, maxWetLatencySamples at most.
+     */
+    void setWetLatency (const int latencySamples) noexcept;
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the gain to apply after the mix, dry + wet.
+     * @return SampleType
+     */
+    SampleType getMixLevel() const noexcept;
+
+    /**
+     * @brief This method gets the proportion of wet signal in the mix, wet / (dry + wet).
+     * @return SampleType
+     */
+    SampleType getWetProportion() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method stores the dry block, call it before the chain processes the block.
+     *
+     * @param block: dry block.
+     */
+    void pushDrySamples (const juce::dsp::AudioBlock<const SampleType>& block);
+
+    /**
+     * @brief This method mixes the stored dry block into the wet block.
+     *
+     * @param context: context containing the wet block.
+     */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    juce::dsp::DryWetMixer<SampleType> mixer { maxWetLatencySamples };
+    SampleType mixLevel = 1;
+    SampleType wetProportion = static_cast<SampleType> (0.5);
+}; // class MixStage
+
+} // namespace dsp
+} // namespace cdrt
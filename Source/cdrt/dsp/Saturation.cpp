@@ -0,0 +1,180 @@
+#include "./Saturation.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class Saturation
+
+namespace
+{
+// Knee at the highest drive.
+constexpr double minKnee = 0.1;
+
+// Below this difference between two inputs the quotient loses precision, the function is used directly.
+constexpr double epsilon = 1.0e-5;
+
+constexpr double ln2 = 0.6931471805599453;
+
+// log (cosh (x)) without overflow for large inputs.
+double logCosh (const double x) noexcept
+{
+    const auto ax = std::abs (x);
+    return ax + std::log1p (std::exp (-2.0 * ax)) - ln2;
+}
+} // namespace
+
+//==============================================================================
+// Allocation/Deallocation.
+
+template <typename SampleType>
+void Saturation<SampleType>::prepare (const int numChannels)
+{
+    jassert (numChannels > 0);
+
+    channels.resize (static_cast<size_t> (numChannels));
+    reset();
+}
+
+template <typename SampleType>
+void Saturation<SampleType>::reset()
+{
+    std::fill (channels.begin(), channels.end(), Channel {});
+}
+
+//==============================================================================
+// Setters.
+
+template <typename SampleType>
+void Saturation<SampleType>::setShape (const Shape newShape)
+{
+    if (newShape == shape)
+        return;
+
+    shape = newShape;
+
+    // The stored antiderivatives belong to the old shape.
+    for (auto& channel: channels)
+        channel.antiderivative = antiderivative (shape, channel.x, knee);
+}
+
+template <typename SampleType>
+void Saturation<SampleType>::setDrive (const float newDrive)
+{
+    const auto newKnee = getKnee (newDrive);
+    const auto wasActive = active;
+
+    active = newDrive > 0.0f;
+
+    // Coming from bypass the previous inputs are old.
+    if (active && ! wasActive)
+        reset();
+
+    if (juce::approximatelyEqual (newKnee, knee))
+        return;
+
+    knee = newKnee;
+
+    // The stored antiderivatives belong to the old knee.
+    for (auto& channel: channels)
+        channel.antiderivative = antiderivative (shape, channel.x, knee);
+}
+
+template <typename SampleType>
+void Saturation<SampleType>::copyFrom (const Saturation& other)
+{
+    jassert (other.channels.size() == channels.size());
+
+    channels = other.channels;
+    shape = other.shape;
+    knee = other.knee;
+    active = other.active;
+}
+
+//==============================================================================
+// Getters.
+
+template <typename SampleType>
+bool Saturation<SampleType>::isActive() const noexcept
+{
+    return active;
+}
+
+//==============================================================================
+// Processing.
+
+template <typename SampleType>
+SampleType Saturation<SampleType>::processSample (const int channel, const SampleType sample) noexcept
+{
+    auto& state = channels[static_cast<size_t> (channel)];
+
+    const auto x = static_cast<double> (sample);
+    const auto integral = antiderivative (shape, x, knee);
+    const auto dx = x - state.x;
+
+    const auto y = std::abs (dx) > epsilon ? (integral - state.antiderivative) / dx
+                                           : shapeFunction (shape, 0.5 * (x + state.x), knee);
+
+    state.x = x;
+    state.antiderivative = integral;
+
+    return static_cast<SampleType> (y);
+}
+
+template <typename SampleType>
+double Saturation<SampleType>::shapeFunction (const Shape shape, const double x, const double knee) noexcept
+{
+    const auto level = std::abs (x);
+
+    if (level <= knee)
+        return x;
+
+    // The part above the knee, u, goes through a curve with unit slope in 0 and a limit of 1 scaled to the rest of the range.
+    const auto range = juce::jmax (1.0 - knee, epsilon);
+    const auto u = (level - knee) / range;
+    double curve = 0.0;
+
+    switch (shape)
+    {
+        case Shape::tanh:       curve = std::tanh (u); break;
+        case Shape::hardClip:   curve = juce::jmin (0.5 * u, 1.0); break;
+        case Shape::asymmetric: curve = x >= 0.0 ? std::tanh (u) : u / (1.0 + u); break;
+    }
+
+    return std::copysign (knee + range * curve, x);
+}
+
+template <typename SampleType>
+double Saturation<SampleType>::antiderivative (const Shape shape, const double x, const double knee) noexcept
+{
+    const auto level = std::abs (x);
+
+    if (level <= knee)
+        return 0.5 * x * x;
+
+    // Both halves are integrated from 0 to the level, the shaping function being odd but for the asymmetric curve.
+    const auto range = juce::jmax (1.0 - knee, epsilon);
+    const auto u = (level - knee) / range;
+    double curve = 0.0;
+
+    switch (shape)
+    {
+        case Shape::tanh:       curve = logCosh (u); break;
+        case Shape::hardClip:   curve = u <= 2.0 ? 0.25 * u * u : u - 1.0; break;
+        case Shape::asymmetric: curve = x >= 0.0 ? logCosh (u) : u - std::log1p (u); break;
+    }
+
+    return 0.5 * knee * knee + knee * (level - knee) + range * range * curve;
+}
+
+template <typename SampleType>
+double Saturation<SampleType>::getKnee (const float drive) noexcept
+{
+    return 1.0 - (1.0 - minKnee) * static_cast<double> (juce::jlimit (0.0f, 1.0f, drive));
+}
+
+template class Saturation<float>;
+template class Saturation<double>;
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Waveshaper for the feedback path, antialiased without oversampling.
+// First order antiderivative antialiasing (ADAA): the output is the mean of the
+// shaping function between two consecutive inputs, computed as the difference of
+// its antiderivative divided by the difference of the inputs. It behaves like a
+// lowpass on the generated harmonics and adds half a sample of delay, the delay line
+// reads its feedback half a sample earlier to keep the repeats in time.
+// The antiderivative of the previous sample is kept, one evaluation per sample.
+// Small signals go through unchanged: below a knee the shaping function is the identity,
+// above it the shape bends the rest of the range up to full scale. The drive lowers the
+// knee, the loud repeats are rounded but keep their level.
+template <typename SampleType>
+class Saturation
+{
+public:
+    enum class Shape
+    {
+        tanh,
+        hardClip, // Half the slope above the knee, clipped at full scale.
+        asymmetric // tanh on the positive half, a softer curve on the negative one.
+    };
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new Saturation object.
+     */
+    Saturation() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param numChannels: number of channels to process.
+     */
+    void prepare (const int numChannels);
+
+    /**
+     * @brief This method clears the previous input of every channel.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the shaping function.
+     *
+     * @param newShape: shape to use.
+     */
+    void setShape (const Shape newShape);
+
+    /**
+     * @brief This method sets the amount of saturation.
+     *
+     * @param newDrive: drive normalised in [0, 1], 0 bypasses the stage.
+     */
+    void setDrive (const float newDrive);
+
+    /**
+     * @brief This method copies settings and state from another object with the same number of channels.
+     *
+     * @param other: object to copy from.
+     */
+    void copyFrom (const Saturation& other);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method tells whether the stage processes the signal, false when the drive is 0.
+     * @return bool
+     */
+    bool isActive() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method saturates a sample of the given channel.
+     *
+     * @param channel: channel of the sample.
+     * @param sample: input sample.
+     * @return SampleType
+     */
+    SampleType processSample (const int channel, const SampleType sample) noexcept;
+
+    /**
+     * @brief This function applies the shaping function, without antialiasing.
+     *
+     * @param shape: shape to use.
+     * @param x: input value.
+     * @param knee: level up to which the input goes through unchanged, in (0, 1].
+     * @return double
+     */
+    static double shapeFunction (const Shape shape, const double x, const double knee) noexcept;
+
+    /**
+     * @brief This function computes the antiderivative of the shaping function, 0 in 0.
+     *
+     * @param shape: shape to use.
+     * @param x: input value.
+     * @param knee: level up to which the input goes through unchanged, in (0, 1].
+     * @return double
+     */
+    static double antiderivative (const Shape shape, const double x, const double knee) noexcept;
+
+    /**
+     * @brief This function gets the knee of the shaping function for a drive.
+     *
+     * @param drive: drive normalised in [0, 1].
+     * @return double
+     */
+    static double getKnee (const float drive) noexcept;
+
+private:
+    // Previous input and its antiderivative.
+    struct Channel
+    {
+        double x = 0.0;
+        double antiderivative = 0.0;
+    };
+
+    std::vector<Channel> channels;
+
+    Shape shape = Shape::tanh;
+    double knee = 1.0;
+    bool active = false;
+}; // class Saturation
+
+} // namespace dsp
+} // namespace cdrt
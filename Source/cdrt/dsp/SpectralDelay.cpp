@@ -0,0 +1,239 @@
+#include "./SpectralDelay.h"
+
+namespace cdrt
+{
+namespace dsp
+{
+//==============================================================================
+// class SpectralDelay
+
+//==============================================================================
+// Default constructor.
+
+SpectralDelay::SpectralDelay()
+    : fft (fftOrder)
+{
+    // Periodic sqrt Hann window: its square, applied twice, sums to 2 at 4 times overlap.
+    window.resize (static_cast<size_t> (fftSize));
+
+    for (size_t i = 0; i < window.size(); ++i)
+        window[i] = static_cast<float> (std::sin (juce::MathConstants<double>::pi * static_cast<double> (i) / fftSize));
+
+    // Logarithmic band edges, numBins^(band / numBands), never two equal edges.
+    bandEdges[0] = 0;
+
+    for (int band = 1; band <= numBands; ++band)
+    {
+        const auto edge = static_cast<int> (std::round (std::pow (static_cast<double> (numBins), static_cast<double> (band) / numBands)));
+        bandEdges[static_cast<size_t> (band)] = juce::jmax (bandEdges[static_cast<size_t> (band - 1)] + 1, edge);
+    }
+
+    bandEdges[numBands] = numBins;
+    bandDelayFrames.fill (1);
+    bandFeedback.fill (0.0f);
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+void SpectralDelay::prepare (const juce::dsp::ProcessSpec& spec, const int maxDelaySamples)
+{
+    jassert (spec.numChannels > 0);
+
+    numFrames = maxDelaySamples / hopSize + 2;
+    channels.resize (spec.numChannels);
+
+    for (auto& channel: channels)
+    {
+        channel.input.resize (static_cast<size_t> (fftSize));
+        channel.accumulator.resize (static_cast<size_t> (fftSize));
+        channel.output.resize (static_cast<size_t> (hopSize));
+        channel.fftData.resize (static_cast<size_t> (2 * fftSize));
+        channel.real.resize (static_cast<size_t> (numBins));
+        channel.imag.resize (static_cast<size_t> (numBins));
+        channel.historyReal.resize (static_cast<size_t> (numFrames * numBins));
+        channel.historyImag.resize (static_cast<size_t> (numFrames * numBins));
+    }
+
+    for (auto& frames: bandDelayFrames)
+        frames = juce::jlimit (1, numFrames - 1, frames);
+
+    reset();
+}
+
+void SpectralDelay::reset()
+{
+    for (auto& channel: channels)
+        for (auto* data: { &channel.input, &channel.accumulator, &channel.output, &channel.fftData,
+                           &channel.real, &channel.imag, &channel.historyReal, &channel.historyImag })
+            std::fill (data->begin(), data->end(), 0.0f);
+
+    frameIndex = 0;
+    inputIndex = 0;
+    hopPosition = 0;
+    nextTask = numTasks; // Nothing to do until the first hop is captured.
+}
+
+//==============================================================================
+// Setters.
+
+void SpectralDelay::setBand (const int band, const float delaySamples, const float feedback)
+{
+    jassert (band >= 0 && band < numBands);
+
+    const auto frames = static_cast<int> (std::round (delaySamples / static_cast<float> (hopSize)));
+    bandDelayFrames[static_cast<size_t> (band)] = juce::jlimit (1, juce::jmax (1, numFrames - 1), frames);
+    bandFeedback[static_cast<size_t> (band)] = juce::jlimit (0.0f, 0.99f, feedback);
+}
+
+//==============================================================================
+// Getters.
+
+int SpectralDelay::getLatencySamples() const noexcept
+{
+    return fftSize + hopSize;
+}
+
+int SpectralDelay::getBandStartBin (const int band) const noexcept
+{
+    return bandEdges[static_cast<size_t> (band)];
+}
+
+//==============================================================================
+// Processing.
+
+void SpectralDelay::process (const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const auto numSamples = static_cast<int> (block.getNumSamples());
+    const auto numChannels = juce::jmin (static_cast<int> (block.getNumChannels()), static_cast<int> (channels.size()));
+
+    for (int position = 0; position < numSamples;)
+    {
+        if (hopPosition == hopSize)
+            startHop();
+
+        while (nextTask < numTasks && getTaskStart (nextTask) <= hopPosition)
+            runTask (nextTask++);
+
+        // Samples until the next task or the end of the hop, only copies in between.
+        const auto nextEvent = nextTask < numTasks ? getTaskStart (nextTask) : hopSize;
+        const auto count = juce::jmin (numSamples - position, nextEvent - hopPosition);
+        const auto firstPart = juce::jmin (count, fftSize - inputIndex);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto& state = channels[static_cast<size_t> (channel)];
+            auto* samples = block.getChannelPointer (static_cast<size_t> (channel)) + position;
+
+            // The block is replaced in place, the input is stored before the output overwrites it.
+            juce::FloatVectorOperations::copy (state.input.data() + inputIndex, samples, firstPart);
+            juce::FloatVectorOperations::copy (state.input.data(), samples + firstPart, count - firstPart);
+            juce::FloatVectorOperations::copy (samples, state.output.data() + hopPosition, count);
+        }
+
+        inputIndex = (inputIndex + count) % fftSize;
+        hopPosition += count;
+        position += count;
+    }
+}
+
+void SpectralDelay::startHop() noexcept
+{
+    // A task left behind (not possible with the fixed schedule) would be lost, run it now.
+    while (nextTask < numTasks)
+        runTask (nextTask++);
+
+    for (auto& state: channels)
+    {
+        // The first hop of the overlap-add received every frame, it is played during this hop.
+        juce::FloatVectorOperations::copy (state.output.data(), state.accumulator.data(), hopSize);
+        std::copy (state.accumulator.begin() + hopSize, state.accumulator.end(), state.accumulator.begin());
+        std::fill (state.accumulator.end() - hopSize, state.accumulator.end(), 0.0f);
+
+        // Windowed frame of the last fftSize samples, oldest first.
+        const auto firstPart = fftSize - inputIndex;
+        juce::FloatVectorOperations::multiply (state.fftData.data(), state.input.data() + inputIndex, window.data(), firstPart);
+        juce::FloatVectorOperations::multiply (state.fftData.data() + firstPart, state.input.data(), window.data() + firstPart, inputIndex);
+    }
+
+    frameIndex = (frameIndex + 1) % numFrames;
+    hopPosition = 0;
+    nextTask = 0;
+}
+
+void SpectralDelay::runTask (const int task) noexcept
+{
+    if (task == 0)
+    {
+        for (auto& state: channels)
+        {
+            fft.performRealOnlyForwardTransform (state.fftData.data(), true);
+
+            for (int bin = 0; bin < numBins; ++bin)
+            {
+                state.real[static_cast<size_t> (bin)] = state.fftData[static_cast<size_t> (2 * bin)];
+                state.imag[static_cast<size_t> (bin)] = state.fftData[static_cast<size_t> (2 * bin + 1)];
+            }
+        }
+    }
+    else if (task <= numBinTasks)
+    {
+        const auto firstBin = (task - 1) * numBins / numBinTasks;
+        const auto lastBin = task * numBins / numBinTasks;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto start = juce::jmax (firstBin, bandEdges[static_cast<size_t> (band)]);
+            const auto end = juce::jmin (lastBin, bandEdges[static_cast<size_t> (band + 1)]);
+
+            if (start >= end)
+                continue;
+
+            const auto count = end - start;
+            const auto feedback = bandFeedback[static_cast<size_t> (band)];
+            const auto readFrame = (frameIndex - bandDelayFrames[static_cast<size_t> (band)] + numFrames) % numFrames;
+            const auto readOffset = static_cast<size_t> (readFrame * numBins + start);
+            const auto writeOffset = static_cast<size_t> (frameIndex * numBins + start);
+
+            for (auto& state: channels)
+            {
+                // history[now] = input + feedback * history[now - delay], output = history[now - delay].
+                for (auto [history, spectrum]: { std::pair { &state.historyReal, &state.real }, std::pair { &state.historyImag, &state.imag } })
+                {
+                    auto* written = history->data() + writeOffset;
+                    const auto* delayed = history->data() + readOffset;
+                    auto* bins = spectrum->data() + start;
+
+                    juce::FloatVectorOperations::copy (written, bins, count);
+                    juce::FloatVectorOperations::addWithMultiply (written, delayed, feedback, count);
+                    juce::FloatVectorOperations::copy (bins, delayed, count);
+                }
+            }
+        }
+    }
+    else
+    {
+        for (auto& state: channels)
+        {
+            // The negative frequencies are the conjugates, written for the FFT engines reading them.
+            for (int bin = 0; bin < fftSize; ++bin)
+            {
+                const auto source = static_cast<size_t> (bin < numBins ? bin : fftSize - bin);
+                const auto sign = bin < numBins ? 1.0f : -1.0f;
+
+                state.fftData[static_cast<size_t> (2 * bin)] = state.real[source];
+                state.fftData[static_cast<size_t> (2 * bin + 1)] = sign * state.imag[source];
+            }
+
+            fft.performRealOnlyInverseTransform (state.fftData.data());
+
+            // Synthesis window, the squared windows sum to 2.
+            juce::FloatVectorOperations::multiply (state.fftData.data(), window.data(), fftSize);
+            juce::FloatVectorOperations::addWithMultiply (state.accumulator.data(), state.fftData.data(), 0.5f, fftSize);
+        }
+    }
+}
+
+} // namespace dsp
+} // namespace cdrt
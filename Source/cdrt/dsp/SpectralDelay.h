@@ -0,0 +1,149 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+#include <juce_core/juce_core.h>
+
+namespace cdrt
+{
+namespace dsp
+{
+
+// Spectral delay: every frequency band has its own delay time and feedback.
+// The input is analysed with a short time Fourier transform (sqrt Hann windows, 4 times
+// overlap) and the spectrum of every frame is stored in a history of frames, real and
+// imaginary parts in separate contiguous arrays (bins inner), so the delay and feedback
+// of a band are vectorized multiply-adds over a contiguous range of bins.
+// The work of a hop (forward FFT, bands, inverse FFT) is split in tasks run at fixed
+// points of the next hop, so the CPU is spread over the hop instead of a spike every
+// hopSize samples. This costs one hop of latency on top of the FFT size.
+// The delay of a band is a whole number of hops, measured after getLatencySamples().
+// juce::dsp::FFT is single precision, so the class is not a template.
+class SpectralDelay
+{
+public:
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+    static constexpr int numBins = fftSize / 2 + 1;
+    static constexpr int numBands = 8;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new SpectralDelay object.
+     */
+    SpectralDelay();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the processor.
+     *
+     * @param spec: context informations for processor.
+     * @param maxDelaySamples: longest delay of a band expressed in samples.
+     */
+    void prepare (const juce::dsp::ProcessSpec& spec, const int maxDelaySamples);
+
+    /**
+     * @brief This method clears the frames and the overlap-add buffers.
+     */
+    void reset();
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the delay and the feedback of a band, used from the next frame.
+     *
+     * @param band: index of the band, the bands are spaced logarithmically from the lowest bin.
+     * @param delaySamples: delay expressed in samples, rounded to a whole number of hops, at least one.
+     * @param feedback: feedback of the band in [0, 1).
+     */
+    void setBand (const int band, const float delaySamples, const float feedback);
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the latency of the analysis and resynthesis, to report to the host.
+     * @return int
+     */
+    int getLatencySamples() const noexcept;
+
+    /**
+     * @brief This method gets the first bin of a band, getBandStartBin (numBands) is numBins.
+     *
+     * @param band: index of the band.
+     * @return int
+     */
+    int getBandStartBin (const int band) const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method processes a block of samples in place, the output is the delayed signal only.
+     *
+     * @param context: context containing the block to process.
+     */
+    void process (const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+
+private:
+    // Forward FFT, one task for each group of bins, inverse FFT.
+    static constexpr int numBinTasks = 4;
+    static constexpr int numTasks = numBinTasks + 2;
+
+    struct Channel
+    {
+        std::vector<float> input;        // Last fftSize input samples, circular.
+        std::vector<float> accumulator;  // Overlap-add of the resynthesised frames.
+        std::vector<float> output;       // Finished samples played during the hop.
+        std::vector<float> fftData;      // Frame being transformed, 2 * fftSize.
+        std::vector<float> real, imag;   // Spectrum of the frame, numBins.
+        std::vector<float> historyReal;  // numFrames frames of numBins bins.
+        std::vector<float> historyImag;
+    };
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method finishes the previous hop and captures the frame of the next one.
+     */
+    void startHop() noexcept;
+
+    /**
+     * @brief This method runs one task of the hop on every channel.
+     *
+     * @param task: index of the task.
+     */
+    void runTask (const int task) noexcept;
+
+    /**
+     * @brief This method gets the position in the hop where a task starts.
+     *
+     * @param task: index of the task.
+     * @return int
+     */
+    static constexpr int getTaskStart (const int task) noexcept { return task * hopSize / numTasks; }
+
+    //==========================================================================
+    juce::dsp::FFT fft;
+    std::vector<float> window; // sqrt Hann, analysis and synthesis.
+    std::vector<Channel> channels;
+
+    std::array<int, numBands + 1> bandEdges {};
+    std::array<int, numBands> bandDelayFrames {};
+    std::array<float, numBands> bandFeedback {};
+
+    int numFrames = 0;
+    int frameIndex = 0;     // Frame of the history written by the current hop.
+    int inputIndex = 0;     // Oldest sample of the input, next to overwrite.
+    int hopPosition = 0;
+    int nextTask = numTasks;
+}; // class SpectralDelay
+
+} // namespace dsp
+} // namespace cdrt
@@ -0,0 +1,46 @@
+#include "MidiControl.h"
+
+namespace cdrt
+{
+namespace helper
+{
+namespace midi
+{
+
+int getChanges (const juce::MidiMessage& message, const Mapping& mapping, Changes& changes)
+{
+    if (mapping.channel != 0 && ! message.isForChannel (mapping.channel))
+        return 0;
+
+    if (message.isController())
+    {
+        const auto controller = message.getControllerNumber();
+        const auto value = static_cast<float> (message.getControllerValue()) / 127.0f;
+
+        if (controller == mapping.timeController)
+            changes[0] = { Target::time, value * value * mapping.maxTimeInMilliseconds };
+        else if (controller == mapping.feedbackController)
+            changes[0] = { Target::feedback, value };
+        else if (controller == mapping.mixController)
+            changes[0] = { Target::mix, value };
+        else
+            return 0;
+
+        return 1;
+    }
+
+    if (message.isNoteOn() && mapping.notesSetTime)
+    {
+        const auto period = 1000.0 / juce::MidiMessage::getMidiNoteInHertz (message.getNoteNumber());
+
+        changes[0] = { Target::time, juce::jmin (mapping.maxTimeInMilliseconds, static_cast<float> (period)) };
+        changes[1] = { Target::feedback, message.getFloatVelocity() * mapping.maxNoteFeedback };
+        return 2;
+    }
+
+    return 0;
+}
+
+} // namespace midi
+} // namespace helper
+} // namespace cdrt
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+
+namespace cdrt
+{
+namespace helper
+{
+namespace midi
+{
+
+//==============================================================================
+// MIDI control of the delay time, feedback and mix, applied at the sample position of the events.
+// Controllers set the time (0 to the maximum, quadratic so short times get more steps), the feedback and the
+// mix (wet is the value, dry its complement). A note on sets the time to the period of the note, tuning the
+// repeats like a comb filter, and the feedback to its velocity scaled below 1, so the comb always rings out.
+// Note offs and the other messages are ignored.
+// The changes don't go through the parameters of the processor: the host doesn't record them.
+
+// Parameter changed by a message.
+enum class Target
+{
+    time,
+    feedback,
+    mix
+};
+
+// Value of a parameter, milliseconds for the time and 0 to 1 otherwise.
+struct Change
+{
+    Target target = Target::time;
+    float value = 0.0f;
+};
+
+// Changes of a single message, a note sets both time and feedback.
+static constexpr int maxChanges = 2;
+using Changes = std::array<Change, maxChanges>;
+
+// Messages listened to. A channel 0 listens to every channel, a controller -1 is disabled.
+struct Mapping
+{
+    int channel = 0;
+    int timeController = 12;     // Effect control 1.
+    int feedbackController = 13; // Effect control 2.
+    int mixController = 91;      // Effects depth.
+    bool notesSetTime = true;
+    float maxNoteFeedback = 0.95f; // Feedback of the loudest note.
+    float maxTimeInMilliseconds = 3000.0f;
+};
+
+/**
+ @brief: This function translates a message to the changes it makes, returns how many were written to changes, 0 for the messages not mapped.
+ */
+int getChanges (const juce::MidiMessage& message, const Mapping& mapping, Changes& changes);
+
+/**
+ @brief: This function splits a block at the events that change a parameter. process (start, numSamples) is called for every part
+ without changes inside, and apply (change) for every change before the part starting at its position. The events outside the block
+ are clamped to it, the ones past the end are applied after the last part.
+ */
+template <typename ProcessFunction, typename ApplyFunction>
+void splitBlock (const juce::MidiBuffer& messages, const Mapping& mapping, const int numSamples, ProcessFunction&& process, ApplyFunction&& apply)
+{
+    Changes changes;
+    int start = 0;
+
+    for (const auto metadata: messages)
+    {
+        const auto numChanges = getChanges (metadata.getMessage(), mapping, changes);
+
+        if (numChanges == 0)
+            continue;
+
+        if (const auto position = juce::jlimit (0, numSamples, metadata.samplePosition); position > start)
+        {
+            process (start, position - start);
+            start = position;
+        }
+
+        for (int i = 0; i < numChanges; ++i)
+            apply (changes[static_cast<size_t> (i)]);
+    }
+
+    if (start < numSamples)
+        process (start, numSamples - start);
+}
+
+} // namespace midi
+} // namespace helper
+} // namespace cdrt
@@ -18,6 +18,25 @@ juce::AudioProcessorValueTreeState::ParameterLayout createLayout(void)
     parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"dry", 5}, "Dry", juce::NormalisableRange<float> {0.0f, 1.0f, 0.01f}, 0.7f));
     parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"wet", 6}, "Wet", juce::NormalisableRange<float> {0.0f, 1.0f, 0.01f}, 0.7f));
     // parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"routing", 7}, "Routing", juce::StringArray {"Straight", "Ping Pong L to R", "Ping Pong R to L"}, 0));
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"timemode", 8}, "Time Mode", juce::StringArray {"Glide", "Crossfade"}, 0));
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"modulation", 9}, "Modulation", juce::StringArray {"Off", "Chorus", "Flanger", "Vibrato"}, 0));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"modrate", 10}, "Modulation Rate", juce::NormalisableRange<float> {0.05f, 10.0f, 0.01f}, 0.8f));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"moddepth", 11}, "Modulation Depth", juce::NormalisableRange<float> {0.0f, 1.0f, 0.01f}, 0.5f));
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"interpolation", 12}, "Interpolation", juce::StringArray {"None", "Linear", "Lagrange 3rd", "Thiran", "Thiran 2nd", "Thiran 3rd", "Thiran 4th"}, 1));
+    parameters.push_back (std::make_unique<juce::AudioParameterBool> (juce::ParameterID {"autoquality", 13}, "Auto Quality", false));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"lowcut", 14}, "Low Cut", juce::NormalisableRange<float> {20.0f, 20000.0f, 1.0f, 0.25f}, 20.0f));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"highcut", 15}, "High Cut", juce::NormalisableRange<float> {20.0f, 20000.0f, 1.0f, 0.25f}, 20000.0f));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"tilt", 16}, "Tilt", juce::NormalisableRange<float> {-12.0f, 12.0f, 0.1f}, 0.0f));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"saturation", 17}, "Saturation", juce::NormalisableRange<float> {0.0f, 1.0f, 0.01f}, 0.0f));
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"satshape", 18}, "Saturation Shape", juce::StringArray {"Tanh", "Hard Clip", "Asymmetric"}, 0));
+    // parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"grain", 19}, "Grain", juce::StringArray {"Off", "Reverse", "Pitch"}, 0));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"pitch", 20}, "Pitch", juce::NormalisableRange<float> {-12.0f, 12.0f, 1.0f}, 12.0f));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"grainsize", 21}, "Grain Size", juce::NormalisableRange<float> {20.0f, 500.0f, 1.0f}, 120.0f));
+    // parameters.push_back (std::make_unique<juce::AudioParameterBool> (juce::ParameterID {"spectral", 22}, "Spectral", false));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"spread", 23}, "Band Spread", juce::NormalisableRange<float> {-1.0f, 1.0f, 0.01f}, 0.5f));
+    // parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"bands", 24}, "Bands", juce::StringArray {"Off", "2 Bands", "3 Bands", "4 Bands"}, 0));
+    parameters.push_back (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID {"diffusion", 25}, "Diffusion", juce::NormalisableRange<float> {0.0f, 1.0f, 0.01f}, 0.0f));
+    parameters.push_back (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID {"wetmode", 26}, "Wet Mode", juce::StringArray {"Delay", "Reverse", "Pitch", "Spectral", "2 Bands", "3 Bands", "4 Bands"}, 0));
 
     return { parameters.begin(), parameters.end() };
 }
@@ -10,6 +10,7 @@ namespace parameters
 {
 /**
  @brief: This function is a wrapper over the parameters layout creation, used to generate all the required parameters for this plugin.
+ Every parameter has its own version hint, it is also the integer ID of the parameter in the binary state so it must never be reused.
  */
 juce::AudioProcessorValueTreeState::ParameterLayout createLayout(void);
 
@@ -0,0 +1,175 @@
+#include "State.h"
+
+namespace cdrt
+{
+namespace helper
+{
+namespace state
+{
+
+namespace
+{
+// Fields are copied one by one, the data coming from the host has no alignment guarantee.
+template <typename Type>
+void writeField (char*& cursor, const Type value)
+{
+    const auto littleEndian = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (cursor, &littleEndian, sizeof (Type));
+    cursor += sizeof (Type);
+}
+
+template <typename Type>
+bool readField (const char*& cursor, const char* end, Type& value)
+{
+    if (static_cast<size_t> (end - cursor) < sizeof (Type))
+        return false;
+
+    std::memcpy (&value, cursor, sizeof (Type));
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    cursor += sizeof (Type);
+    return true;
+}
+} // namespace
+
+bool isBinaryState (const void* data, const int sizeInBytes)
+{
+    juce::uint32 header = 0;
+    const auto* cursor = static_cast<const char*> (data);
+
+    return data != nullptr && readField (cursor, cursor + sizeInBytes, header) && header == magic;
+}
+
+void write (juce::MemoryBlock& destination, const std::vector<Parameter>& parameters, const Snapshot* snapshot)
+{
+    const auto hasSnapshot = snapshot != nullptr && snapshot->buffer.getNumChannels() > 0 && snapshot->buffer.getNumSamples() > 0;
+    const auto numChannels = hasSnapshot ? static_cast<size_t> (snapshot->buffer.getNumChannels()) : 0;
+    const auto numSamples = hasSnapshot ? static_cast<size_t> (snapshot->buffer.getNumSamples()) : 0;
+
+    const auto size = 3 * sizeof (juce::uint32)
+                    + parameters.size() * (sizeof (juce::uint32) + sizeof (float))
+                    + 2 * sizeof (juce::uint32)
+                    + (hasSnapshot ? sizeof (double) + numChannels * numSamples * sizeof (float) : 0);
+
+    destination.setSize (size);
+    auto* cursor = static_cast<char*> (destination.getData());
+
+    writeField (cursor, magic);
+    writeField (cursor, version);
+    writeField (cursor, static_cast<juce::uint32> (parameters.size()));
+
+    for (const auto& parameter: parameters)
+    {
+        writeField (cursor, parameter.id);
+        writeField (cursor, parameter.value);
+    }
+
+    writeField (cursor, static_cast<juce::uint32> (numChannels));
+    writeField (cursor, static_cast<juce::uint32> (numSamples));
+
+    if (! hasSnapshot)
+        return;
+
+    writeField (cursor, snapshot->sampleRate);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* samples = snapshot->buffer.getReadPointer (static_cast<int> (channel));
+
+       #if JUCE_LITTLE_ENDIAN
+        std::memcpy (cursor, samples, numSamples * sizeof (float));
+        cursor += numSamples * sizeof (float);
+       #else
+        for (size_t i = 0; i < numSamples; ++i)
+            writeField (cursor, samples[i]);
+       #endif
+    }
+}
+
+bool read (const void* data, const int sizeInBytes, std::vector<Parameter>& parameters, Snapshot& snapshot)
+{
+    const auto* cursor = static_cast<const char*> (data);
+    const auto* end = cursor + sizeInBytes;
+
+    juce::uint32 header = 0, stateVersion = 0, numParameters = 0;
+
+    if (! readField (cursor, end, header) || header != magic)
+        return false;
+
+    if (! readField (cursor, end, stateVersion) || stateVersion > version)
+        return false;
+
+    if (! readField (cursor, end, numParameters) || static_cast<size_t> (end - cursor) < numParameters * (sizeof (juce::uint32) + sizeof (float)))
+        return false;
+
+    parameters.resize (numParameters);
+
+    for (auto& parameter: parameters)
+    {
+        readField (cursor, end, parameter.id);
+        readField (cursor, end, parameter.value);
+    }
+
+    juce::uint32 numChannels = 0, numSamples = 0;
+
+    if (! readField (cursor, end, numChannels) || ! readField (cursor, end, numSamples))
+        return false;
+
+    snapshot.buffer.setSize (0, 0);
+
+    if (numChannels == 0 || numSamples == 0)
+        return true;
+
+    if (! readField (cursor, end, snapshot.sampleRate)
+        || static_cast<size_t> (end - cursor) / sizeof (float) / numChannels < numSamples)
+        return false;
+
+    snapshot.buffer.setSize (static_cast<int> (numChannels), static_cast<int> (numSamples), false, false, true);
+
+    for (int channel = 0; channel < static_cast<int> (numChannels); ++channel)
+    {
+        auto* samples = snapshot.buffer.getWritePointer (channel);
+
+       #if JUCE_LITTLE_ENDIAN
+        std::memcpy (samples, cursor, numSamples * sizeof (float));
+        cursor += numSamples * sizeof (float);
+       #else
+        for (juce::uint32 i = 0; i < numSamples; ++i)
+            readField (cursor, end, samples[i]);
+       #endif
+    }
+
+    return true;
+}
+
+std::vector<Parameter> getParameters (const juce::AudioProcessor& processor)
+{
+    std::vector<Parameter> parameters;
+    parameters.reserve (static_cast<size_t> (processor.getParameters().size()));
+
+    for (auto* parameter: processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+            parameters.push_back ({ static_cast<juce::uint32> (ranged->getVersionHint()), ranged->convertFrom0to1 (ranged->getValue()) });
+
+    return parameters;
+}
+
+void setParameters (juce::AudioProcessor& processor, const std::vector<Parameter>& parameters)
+{
+    for (auto* parameter: processor.getParameters())
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter);
+
+        if (ranged == nullptr)
+            continue;
+
+        const auto id = static_cast<juce::uint32> (ranged->getVersionHint());
+        const auto stored = std::find_if (parameters.begin(), parameters.end(), [id] (const Parameter& p) { return p.id == id; });
+
+        ranged->setValueNotifyingHost (stored != parameters.end() ? ranged->convertTo0to1 (stored->value)
+                                                                  : ranged->getDefaultValue());
+    }
+}
+
+} // namespace state
+} // namespace helper
+} // namespace cdrt
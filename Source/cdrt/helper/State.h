@@ -0,0 +1,66 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+namespace cdrt
+{
+namespace helper
+{
+namespace state
+{
+
+//==============================================================================
+// Compact binary plugin state.
+// Layout, every field little endian:
+//   magic (uint32) | version (uint32) | numParameters (uint32)
+//   numParameters x { id (uint32) | value (float32) }
+//   snapshotChannels (uint32) | snapshotSamples (uint32) | [ sampleRate (float64) | samples (float32, channel after channel) ]
+// Parameters are stored by integer ID with their plain (not normalised) value, unknown IDs are skipped when reading.
+// The delay buffer snapshot is optional, it is present only when snapshotChannels and snapshotSamples are not 0.
+
+static constexpr juce::uint32 magic = 0x54524443; // "CDRT".
+static constexpr juce::uint32 version = 1;
+
+// Plain value of a parameter identified by its integer ID.
+struct Parameter
+{
+    juce::uint32 id;
+    float value;
+};
+
+// Content of the delay lines, one channel for each line, samples from the oldest to the newest.
+struct Snapshot
+{
+    double sampleRate = 0.0;
+    juce::AudioBuffer<float> buffer;
+};
+
+/**
+ @brief: This function checks if a block of data starts with the binary state header, use it to choose between this format and the XML one.
+ */
+bool isBinaryState (const void* data, const int sizeInBytes);
+
+/**
+ @brief: This function writes parameters and an optional snapshot (nullptr when missing) in the binary format, replacing the content of destination.
+ */
+void write (juce::MemoryBlock& destination, const std::vector<Parameter>& parameters, const Snapshot* snapshot);
+
+/**
+ @brief: This function reads a binary state, returns false if the data is truncated or written by a newer version.
+ The snapshot buffer is set to 0 channels when the state does not contain it.
+ */
+bool read (const void* data, const int sizeInBytes, std::vector<Parameter>& parameters, Snapshot& snapshot);
+
+/**
+ @brief: This function collects the plain value of every ranged parameter of the processor, the ID is the parameter version hint.
+ */
+std::vector<Parameter> getParameters (const juce::AudioProcessor& processor);
+
+/**
+ @brief: This function sets every ranged parameter of the processor, parameters missing in the list go back to their default value.
+ */
+void setParameters (juce::AudioProcessor& processor, const std::vector<Parameter>& parameters);
+
+} // namespace state
+} // namespace helper
+} // namespace cdrt
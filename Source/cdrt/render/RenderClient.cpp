@@ -0,0 +1,229 @@
+#include "./RenderClient.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace cdrt
+{
+namespace render
+{
+//==============================================================================
+// class RenderClient
+
+namespace
+{
+// Longest single sleep, the state of the session is checked in between.
+constexpr int pollMs = 50;
+
+using Clock = std::chrono::steady_clock;
+
+int getRemainingMs (const Clock::time_point deadline) noexcept
+{
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds> (deadline - Clock::now()).count();
+    return static_cast<int> (std::max<long long> (0, remaining));
+}
+} // namespace
+
+RenderClient::~RenderClient()
+{
+    disconnect();
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+bool RenderClient::connect (const std::string& daemonName, const int timeoutMs)
+{
+    disconnect();
+
+    if (! memory.open (protocol::getSegmentName (daemonName)) || memory.getSize() < sizeof (Header))
+        return false;
+
+    auto* candidate = static_cast<Header*> (memory.getData());
+
+    if (candidate->magicNumber != protocol::magic || candidate->protocolVersion != protocol::version)
+    {
+        memory.close();
+        return false;
+    }
+
+    const auto deadline = Clock::now() + std::chrono::milliseconds (timeoutMs);
+
+    // First idle session, polled: the sessions don't share a word to sleep on.
+    do
+    {
+        for (uint32_t index = 0; index < candidate->numSessions; ++index)
+        {
+            auto& current = protocol::getSession (*candidate, index);
+            auto expected = static_cast<uint32_t> (SessionState::idle);
+
+            if (current.state.compare_exchange_strong (expected, static_cast<uint32_t> (SessionState::claimed), std::memory_order_acq_rel))
+            {
+                header = candidate;
+                session = &current;
+                futex::wakeAll (session->state);
+                return true;
+            }
+        }
+
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    } while (Clock::now() < deadline);
+
+    memory.close();
+    return false;
+}
+
+void RenderClient::disconnect()
+{
+    if (session != nullptr)
+    {
+        // A failed session is released as well, the new worker waits for it.
+        session->state.store (static_cast<uint32_t> (SessionState::released), std::memory_order_release);
+        futex::wakeAll (session->state);
+        futex::wakeAll (session->blocks.written);
+    }
+
+    header = nullptr;
+    session = nullptr;
+    memory.close();
+}
+
+//==============================================================================
+// Getters.
+
+bool RenderClient::isConnected() const noexcept
+{
+    return session != nullptr && session->state.load (std::memory_order_acquire) == static_cast<uint32_t> (SessionState::claimed);
+}
+
+double RenderClient::getSampleRate() const noexcept
+{
+    return header != nullptr ? header->sampleRate : 0.0;
+}
+
+int RenderClient::getBlockSize() const noexcept
+{
+    return header != nullptr ? static_cast<int> (header->blockSize) : 0;
+}
+
+int RenderClient::getNumChannels() const noexcept
+{
+    return header != nullptr ? static_cast<int> (header->numChannels) : 0;
+}
+
+//==============================================================================
+// Parameters.
+
+bool RenderClient::setParameter (const int index, const float normalisedValue)
+{
+    if (! isConnected())
+        return false;
+
+    return session->parameters.push (index, std::clamp (normalisedValue, 0.0f, 1.0f));
+}
+
+//==============================================================================
+// Zero copy processing.
+
+float* RenderClient::getInputPointer (const int channel) noexcept
+{
+    if (! isConnected() || channel < 0 || channel >= getNumChannels())
+        return nullptr;
+
+    // Only this client frees slots, a full ring can't become free while waiting.
+    const auto written = session->blocks.written.load (std::memory_order_relaxed);
+
+    if (written - session->blocks.read.load (std::memory_order_relaxed) == protocol::numBlockSlots)
+        return nullptr;
+
+    return protocol::getSamples (*header, *session, written, static_cast<uint32_t> (channel));
+}
+
+void RenderClient::submitBlock() noexcept
+{
+    if (session == nullptr)
+        return;
+
+    // The samples and the parameters pushed before are published with the counter.
+    session->blocks.written.fetch_add (1, std::memory_order_release);
+    futex::wakeAll (session->blocks.written);
+}
+
+const float* RenderClient::getOutputPointer (const int channel, const int timeoutMs)
+{
+    if (session == nullptr || channel < 0 || channel >= getNumChannels())
+        return nullptr;
+
+    const auto read = session->blocks.read.load (std::memory_order_relaxed);
+
+    if (read == session->blocks.written.load (std::memory_order_relaxed))
+        return nullptr; // Nothing submitted.
+
+    const auto deadline = Clock::now() + std::chrono::milliseconds (timeoutMs);
+
+    for (auto processed = session->blocks.processed.load (std::memory_order_acquire); processed == read;
+         processed = session->blocks.processed.load (std::memory_order_acquire))
+    {
+        if (! waitForChange (session->blocks.processed, processed, getRemainingMs (deadline)))
+            return nullptr;
+    }
+
+    return protocol::getSamples (*header, *session, read, static_cast<uint32_t> (channel));
+}
+
+void RenderClient::finishBlock() noexcept
+{
+    if (session == nullptr)
+        return;
+
+    session->blocks.read.fetch_add (1, std::memory_order_release);
+}
+
+//==============================================================================
+// Processing.
+
+bool RenderClient::process (const float* const* input, float* const* output, const int numSamples, const int timeoutMs)
+{
+    const auto numChannels = getNumChannels();
+    const auto count = std::clamp (numSamples, 0, getBlockSize());
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = getInputPointer (channel);
+
+        if (samples == nullptr)
+            return false;
+
+        std::copy (input[channel], input[channel] + count, samples);
+        std::fill (samples + count, samples + getBlockSize(), 0.0f);
+    }
+
+    submitBlock();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* samples = getOutputPointer (channel, timeoutMs);
+
+        if (samples == nullptr)
+            return false;
+
+        std::copy (samples, samples + count, output[channel]);
+    }
+
+    finishBlock();
+    return true;
+}
+
+bool RenderClient::waitForChange (std::atomic<uint32_t>& counter, const uint32_t value, const int timeoutMs)
+{
+    if (! isConnected() || timeoutMs <= 0)
+        return false;
+
+    // The daemon wakes the counters when the worker dies, the state is checked every poll anyway.
+    futex::wait (counter, value, std::min (timeoutMs, pollMs));
+    return isConnected() || counter.load (std::memory_order_acquire) != value;
+}
+
+} // namespace render
+} // namespace cdrt
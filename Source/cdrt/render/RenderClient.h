@@ -0,0 +1,152 @@
+#pragma once
+
+#include "./RenderProtocol.h"
+#include "./SharedMemory.h"
+
+namespace cdrt
+{
+namespace render
+{
+
+// Client of a render daemon: claims one of its warm instances and renders through it.
+// Blocks have the fixed size of the daemon and are pipelined: up to numBlockSlots blocks can
+// be submitted before the first output is read. The zero copy interface fills and reads the
+// slots of the ring in place, process() copies from and to the caller buffers.
+// If the worker of the session dies the calls return false, the caller is not affected.
+class RenderClient
+{
+public:
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new RenderClient object, not connected.
+     */
+    RenderClient() {}
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * RenderClient destructor, releases the session.
+     */
+    ~RenderClient();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief This method maps the segment of a daemon and claims an idle session.
+     *
+     * @param daemonName: name given to the daemon.
+     * @param timeoutMs: longest wait for an idle session expressed in milliseconds.
+     * @return bool: false when there is no daemon or every session stays busy.
+     */
+    bool connect (const std::string& daemonName, const int timeoutMs);
+
+    /**
+     * @brief This method gives the session back to the daemon, the instance is reset to the defaults for the next client.
+     */
+    void disconnect();
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method checks if a session is claimed and its worker is alive.
+     * @return bool
+     */
+    bool isConnected() const noexcept;
+
+    /**
+     * @brief This method gets the sample rate the instances are prepared with.
+     * @return double
+     */
+    double getSampleRate() const noexcept;
+
+    /**
+     * @brief This method gets the number of samples of every block.
+     * @return int
+     */
+    int getBlockSize() const noexcept;
+
+    /**
+     * @brief This method gets the number of channels of every block.
+     * @return int
+     */
+    int getNumChannels() const noexcept;
+
+    //==========================================================================
+    // Parameters.
+
+    /**
+     * @brief This method sets a parameter of the instance from the next submitted block.
+     *
+     * @param index: index of the parameter in the processor.
+     * @param normalisedValue: value in [0, 1].
+     * @return bool: false when the parameter ring is full or the session failed.
+     */
+    bool setParameter (const int index, const float normalisedValue);
+
+    //==========================================================================
+    // Zero copy processing.
+
+    /**
+     * @brief This method gets the input samples of the next free slot, write getBlockSize() samples to every channel.
+     *
+     * @param channel: channel of the block.
+     * @return float*: nullptr when every slot holds a block not finished yet or the session failed.
+     */
+    float* getInputPointer (const int channel) noexcept;
+
+    /**
+     * @brief This method hands the block filled through getInputPointer to the worker.
+     */
+    void submitBlock() noexcept;
+
+    /**
+     * @brief This method waits for the oldest submitted block and gets its output samples.
+     *
+     * @param channel: channel of the block.
+     * @param timeoutMs: longest wait expressed in milliseconds.
+     * @return const float*: nullptr on timeout or failure.
+     */
+    const float* getOutputPointer (const int channel, const int timeoutMs);
+
+    /**
+     * @brief This method frees the slot of the oldest processed block.
+     */
+    void finishBlock() noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method renders one block, waiting for its output.
+     *
+     * @param input: getNumChannels() channels of numSamples samples.
+     * @param output: getNumChannels() channels of numSamples samples, can be the input.
+     * @param numSamples: getBlockSize() at most, the rest of the block is silence.
+     * @param timeoutMs: longest wait expressed in milliseconds.
+     * @return bool: false on timeout or failure.
+     */
+    bool process (const float* const* input, float* const* output, const int numSamples, const int timeoutMs);
+
+private:
+    /**
+     * @brief This method sleeps on a counter of the ring until it differs from the given value, the session fails or the timeout.
+     *
+     * @param counter: counter of the ring.
+     * @param value: value to wait the change of.
+     * @param timeoutMs: longest wait expressed in milliseconds.
+     * @return bool: false on timeout or failure.
+     */
+    bool waitForChange (std::atomic<uint32_t>& counter, const uint32_t value, const int timeoutMs);
+
+    SharedMemory memory;
+    Header* header = nullptr;
+    Session* session = nullptr;
+}; // class RenderClient
+
+} // namespace render
+} // namespace cdrt
@@ -0,0 +1,302 @@
+#include "./RenderDaemon.h"
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Defined by the plugin, the daemon hosts the same processor.
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter();
+
+namespace cdrt
+{
+namespace render
+{
+//==============================================================================
+// class RenderDaemon
+
+namespace
+{
+std::atomic<bool> stopRequested { false };
+
+// Longest sleep of the worker, the state of the session is checked in between.
+constexpr int pollMs = 100;
+
+// Silent blocks processed once prepared, the code and the buffers are warm for the first job.
+constexpr int warmUpBlocks = 8;
+
+uint32_t toWord (const SessionState state) noexcept
+{
+    return static_cast<uint32_t> (state);
+}
+
+void setState (Session& session, const SessionState state) noexcept
+{
+    session.state.store (toWord (state), std::memory_order_release);
+    futex::wakeAll (session.state);
+}
+
+void restoreDefaults (juce::AudioProcessor& processor)
+{
+    for (auto* parameter: processor.getParameters())
+        parameter->setValueNotifyingHost (parameter->getDefaultValue());
+}
+} // namespace
+
+RenderDaemon::RenderDaemon (const Options& newOptions)
+    : options (newOptions)
+{
+    options.numInstances = juce::jmax (1, options.numInstances);
+    options.numChannels = juce::jlimit (1, protocol::maxChannels, options.numChannels);
+    options.blockSize = juce::jmax (1, options.blockSize);
+}
+
+//==============================================================================
+// Processing.
+
+int RenderDaemon::run()
+{
+    Header layout {};
+    layout.numSessions = static_cast<uint32_t> (options.numInstances);
+    layout.blockSize = static_cast<uint32_t> (options.blockSize);
+    layout.numChannels = static_cast<uint32_t> (options.numChannels);
+
+    if (! memory.create (protocol::getSegmentName (options.name), protocol::computeLayout (layout)))
+    {
+        std::cerr << "cdrt render: can't create the shared segment " << protocol::getSegmentName (options.name) << std::endl;
+        return 1;
+    }
+
+    // The segment is zeroed: every session is starting with empty rings. The magic goes last,
+    // clients ignore a segment without it.
+    header = static_cast<Header*> (memory.getData());
+    *header = layout;
+    header->daemonPid = static_cast<int32_t> (::getpid());
+    header->sampleRate = options.sampleRate;
+    header->protocolVersion = protocol::version;
+    std::atomic_thread_fence (std::memory_order_release);
+    header->magicNumber = protocol::magic;
+
+    workerPids.assign (layout.numSessions, -1);
+
+    for (uint32_t index = 0; index < layout.numSessions; ++index)
+        if (! startWorker (index))
+            return 1;
+
+    while (! stopRequested.load())
+    {
+        int status = 0;
+        const auto pid = ::waitpid (-1, &status, 0);
+
+        // Interrupted by the stop signal, or no child left.
+        if (pid < 0)
+            continue;
+
+        const auto found = std::find (workerPids.begin(), workerPids.end(), pid);
+
+        if (found == workerPids.end())
+            continue;
+
+        const auto index = static_cast<uint32_t> (found - workerPids.begin());
+        *found = -1;
+
+        if (stopRequested.load())
+            break;
+
+        std::cerr << "cdrt render: worker " << index << " exited with status " << status << ", restarting it" << std::endl;
+        recoverSession (index);
+
+        if (! startWorker (index))
+            break;
+    }
+
+    stopWorkers();
+    memory.close();
+    return 0;
+}
+
+void RenderDaemon::requestStop() noexcept
+{
+    stopRequested.store (true);
+}
+
+bool RenderDaemon::startWorker (const uint32_t index)
+{
+    const auto pid = ::fork();
+
+    if (pid < 0)
+    {
+        std::cerr << "cdrt render: can't fork the worker " << index << std::endl;
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        // The worker doesn't outlive the daemon.
+        ::prctl (PR_SET_PDEATHSIG, SIGTERM);
+        std::_Exit (runWorker (index));
+    }
+
+    workerPids[index] = pid;
+    protocol::getSession (*header, index).workerPid.store (pid, std::memory_order_release);
+    return true;
+}
+
+int RenderDaemon::runWorker (const uint32_t index)
+{
+    std::signal (SIGTERM, SIG_DFL);
+    std::signal (SIGINT, SIG_IGN);
+
+    auto& session = protocol::getSession (*header, index);
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    std::unique_ptr<juce::AudioProcessor> processor (createPluginFilter());
+    const auto numChannels = static_cast<int> (header->numChannels);
+    const auto blockSize = static_cast<int> (header->blockSize);
+
+    processor->setPlayConfigDetails (numChannels, numChannels, header->sampleRate, blockSize);
+    processor->setNonRealtime (true);
+
+    const auto prepare = [&]
+    {
+        restoreDefaults (*processor);
+        processor->prepareToPlay (header->sampleRate, blockSize);
+
+        // The same spec keeps the delay lines, nothing of the warm-up or of the last job must be heard in the next one.
+        processor->reset();
+    };
+
+    prepare();
+
+    juce::AudioBuffer<float> warmUp (numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    for (int block = 0; block < warmUpBlocks; ++block)
+    {
+        warmUp.clear();
+        processor->processBlock (warmUp, midi);
+    }
+
+    prepare();
+
+    std::array<float*, protocol::maxChannels> channels {};
+
+    for (;;)
+    {
+        const auto state = session.state.load (std::memory_order_acquire);
+
+        switch (static_cast<SessionState> (state))
+        {
+            case SessionState::starting:
+            case SessionState::released:
+            {
+                // A job ended (or a new worker starts): empty rings, defaults, ready for the next client.
+                if (state == toWord (SessionState::released))
+                {
+                    prepare();
+                    session.jobs.fetch_add (1, std::memory_order_relaxed);
+                }
+
+                ParameterRing::Entry entry {};
+                while (session.parameters.pop (entry)) {}
+
+                const auto written = session.blocks.written.load (std::memory_order_acquire);
+                session.blocks.processed.store (written, std::memory_order_relaxed);
+                session.blocks.read.store (written, std::memory_order_relaxed);
+
+                auto expected = state;
+                if (session.state.compare_exchange_strong (expected, toWord (SessionState::idle), std::memory_order_acq_rel))
+                    futex::wakeAll (session.state);
+
+                break;
+            }
+
+            case SessionState::idle:
+            case SessionState::failed:
+                // Waiting for a client, or for the client of the dead worker to release the session.
+                futex::wait (session.state, state, pollMs);
+                break;
+
+            case SessionState::claimed:
+            {
+                const auto processed = session.blocks.processed.load (std::memory_order_relaxed);
+                const auto written = session.blocks.written.load (std::memory_order_acquire);
+
+                if (processed == written)
+                {
+                    futex::wait (session.blocks.written, written, pollMs);
+                    break;
+                }
+
+                // Parameters pushed before the block, then the block in place in the ring.
+                ParameterRing::Entry entry {};
+                const auto& parameters = processor->getParameters();
+
+                while (session.parameters.pop (entry))
+                    if (entry.index >= 0 && entry.index < parameters.size())
+                        parameters[entry.index]->setValueNotifyingHost (entry.value);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    channels[static_cast<size_t> (channel)] = protocol::getSamples (*header, session, processed, static_cast<uint32_t> (channel));
+
+                juce::AudioBuffer<float> buffer (channels.data(), numChannels, blockSize);
+                midi.clear();
+                processor->processBlock (buffer, midi);
+
+                session.blocks.processed.store (processed + 1, std::memory_order_release);
+                futex::wakeAll (session.blocks.processed);
+                break;
+            }
+
+            case SessionState::shutdown:
+            default:
+                processor->releaseResources();
+                return 0;
+        }
+    }
+}
+
+void RenderDaemon::recoverSession (const uint32_t index)
+{
+    auto& session = protocol::getSession (*header, index);
+    session.workerPid.store (-1, std::memory_order_release);
+
+    // A client in the middle of a job sees the failure, a session without a client just starts again.
+    auto expected = toWord (SessionState::claimed);
+
+    if (! session.state.compare_exchange_strong (expected, toWord (SessionState::failed), std::memory_order_acq_rel)
+        && expected != toWord (SessionState::failed) && expected != toWord (SessionState::released))
+        session.state.store (toWord (SessionState::starting), std::memory_order_release);
+
+    futex::wakeAll (session.state);
+    futex::wakeAll (session.blocks.processed);
+}
+
+void RenderDaemon::stopWorkers()
+{
+    if (header == nullptr)
+        return;
+
+    for (uint32_t index = 0; index < header->numSessions; ++index)
+    {
+        auto& session = protocol::getSession (*header, index);
+        setState (session, SessionState::shutdown);
+        futex::wakeAll (session.blocks.processed);
+    }
+
+    for (auto& pid: workerPids)
+    {
+        if (pid > 0)
+            ::waitpid (pid, nullptr, 0);
+
+        pid = -1;
+    }
+}
+
+} // namespace render
+} // namespace cdrt
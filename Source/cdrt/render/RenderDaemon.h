@@ -0,0 +1,90 @@
+#pragma once
+
+#include "./RenderProtocol.h"
+#include "./SharedMemory.h"
+
+#include <vector>
+
+namespace cdrt
+{
+namespace render
+{
+
+// Render daemon: keeps a pool of warm plugin instances for the render clients.
+// Every instance lives in its own worker process, forked by the daemon, prepared once and
+// reused by every job: at the end of a job the parameters go back to their defaults and the
+// instance is prepared again (its buffers are reused) and reset, every job starts silent. The daemon only watches the workers,
+// a worker that dies is replaced and its session marked as failed, so a crash costs one job.
+class RenderDaemon
+{
+public:
+    struct Options
+    {
+        std::string name = "default";
+        int numInstances = 4;
+        double sampleRate = 48000.0;
+        int blockSize = 512;
+        int numChannels = 2;
+    };
+
+    //==========================================================================
+    // Constructor.
+
+    /**
+     * @brief Construct a new RenderDaemon object, nothing is started.
+     *
+     * @param newOptions: pool and processing settings.
+     */
+    explicit RenderDaemon (const Options& newOptions);
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method creates the shared segment, starts the workers and watches them until stop is requested.
+     * @return int: exit code of the daemon.
+     */
+    int run();
+
+    /**
+     * @brief This method asks run to return, safe from a signal handler.
+     */
+    static void requestStop() noexcept;
+
+private:
+    /**
+     * @brief This method forks the worker of a session.
+     *
+     * @param index: index of the session.
+     * @return bool: false when the fork failed.
+     */
+    bool startWorker (const uint32_t index);
+
+    /**
+     * @brief This method runs in the worker process: it prepares an instance and serves the session until shutdown.
+     *
+     * @param index: index of the session.
+     * @return int: exit code of the worker.
+     */
+    int runWorker (const uint32_t index);
+
+    /**
+     * @brief This method marks the session of a dead worker as failed (or starting when no client holds it) and wakes its client.
+     *
+     * @param index: index of the session.
+     */
+    void recoverSession (const uint32_t index);
+
+    /**
+     * @brief This method asks every worker to exit and waits for them.
+     */
+    void stopWorkers();
+
+    Options options;
+    SharedMemory memory;
+    Header* header = nullptr;
+    std::vector<int> workerPids;
+}; // class RenderDaemon
+
+} // namespace render
+} // namespace cdrt
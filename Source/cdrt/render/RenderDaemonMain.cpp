@@ -0,0 +1,58 @@
+#include "./RenderDaemon.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Render daemon for the batch renderers of the same machine, see RenderClient.
+// Usage: cdrt-render-daemon [--name NAME] [--instances N] [--sample-rate HZ] [--block-size N] [--channels N]
+
+namespace
+{
+void handleStop (int)
+{
+    cdrt::render::RenderDaemon::requestStop();
+}
+
+void printUsage()
+{
+    std::cerr << "Usage: cdrt-render-daemon [--name NAME] [--instances N] [--sample-rate HZ] [--block-size N] [--channels N]" << std::endl;
+}
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    cdrt::render::RenderDaemon::Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto hasValue = i + 1 < argc;
+
+        if (std::strcmp (argv[i], "--name") == 0 && hasValue)
+            options.name = argv[++i];
+        else if (std::strcmp (argv[i], "--instances") == 0 && hasValue)
+            options.numInstances = std::atoi (argv[++i]);
+        else if (std::strcmp (argv[i], "--sample-rate") == 0 && hasValue)
+            options.sampleRate = std::atof (argv[++i]);
+        else if (std::strcmp (argv[i], "--block-size") == 0 && hasValue)
+            options.blockSize = std::atoi (argv[++i]);
+        else if (std::strcmp (argv[i], "--channels") == 0 && hasValue)
+            options.numChannels = std::atoi (argv[++i]);
+        else
+        {
+            printUsage();
+            return 2;
+        }
+    }
+
+    // Without SA_RESTART the wait for the workers is interrupted by the signal.
+    struct sigaction action {};
+    action.sa_handler = handleStop;
+    sigemptyset (&action.sa_mask);
+    sigaction (SIGTERM, &action, nullptr);
+    sigaction (SIGINT, &action, nullptr);
+
+    cdrt::render::RenderDaemon daemon (options);
+    return daemon.run();
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cdrt
+{
+namespace render
+{
+
+// Layout of the shared segment of a render daemon, named "/cdrt-render-<name>":
+// a header followed by one session for each warm instance of the daemon.
+// Every session owns a parameter ring and a block ring. The client writes the input
+// of a block straight into a free slot, the worker process of the session processes the
+// slot in place and the client reads the output from the same slot: the ring is the only
+// buffer. Indices are free running counters, the futexes sleep on them.
+
+namespace protocol
+{
+inline constexpr uint32_t magic = 0x43445254; // "CDRT".
+inline constexpr uint32_t version = 1;
+inline constexpr int maxChannels = 2;
+inline constexpr uint32_t numBlockSlots = 4;
+inline constexpr uint32_t numParameterSlots = 256;
+
+/**
+ * @brief This function gets the name of the shared segment of a daemon.
+ *
+ * @param daemonName: name given to the daemon.
+ * @return std::string
+ */
+inline std::string getSegmentName (const std::string& daemonName)
+{
+    return "/cdrt-render-" + daemonName;
+}
+} // namespace protocol
+
+//==============================================================================
+// Session states, written by the daemon, its workers and the client.
+enum class SessionState : uint32_t
+{
+    starting, // The worker is preparing the instance.
+    idle,     // Warm and free, a client can claim it.
+    claimed,  // A client is rendering.
+    released, // The client is done, the worker restores the defaults and goes idle.
+    failed,   // The worker died during the job, the client has to release the session.
+    shutdown  // The daemon is stopping.
+};
+
+//==============================================================================
+// Parameter updates, single producer (client) single consumer (worker).
+// The worker applies the updates pushed before a block at the start of that block.
+struct ParameterRing
+{
+    struct Entry
+    {
+        int32_t index;
+        float value; // Normalised.
+    };
+
+    std::atomic<uint32_t> writeIndex;
+    std::atomic<uint32_t> readIndex;
+    Entry entries[protocol::numParameterSlots];
+
+    bool push (const int32_t index, const float value) noexcept
+    {
+        const auto write = writeIndex.load (std::memory_order_relaxed);
+
+        if (write - readIndex.load (std::memory_order_acquire) == protocol::numParameterSlots)
+            return false;
+
+        entries[write % protocol::numParameterSlots] = { index, value };
+        writeIndex.store (write + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop (Entry& entry) noexcept
+    {
+        const auto read = readIndex.load (std::memory_order_relaxed);
+
+        if (read == writeIndex.load (std::memory_order_acquire))
+            return false;
+
+        entry = entries[read % protocol::numParameterSlots];
+        readIndex.store (read + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+//==============================================================================
+// Audio blocks, the slot of block i is i % numBlockSlots, channels one after the other.
+// written: blocks filled by the client; processed: blocks done by the worker; read: blocks
+// the client finished reading, their slots can be written again.
+struct BlockRing
+{
+    std::atomic<uint32_t> written;
+    std::atomic<uint32_t> processed;
+    std::atomic<uint32_t> read;
+};
+
+//==============================================================================
+struct Session
+{
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> workerPid;
+    std::atomic<uint32_t> jobs;    // Jobs completed by the instance, for the statistics.
+    ParameterRing parameters;
+    BlockRing blocks;
+    // Followed by numBlockSlots * numChannels * blockSize samples, aligned to 64 bytes.
+};
+
+struct Header
+{
+    uint32_t magicNumber;
+    uint32_t protocolVersion;
+    int32_t daemonPid;
+    uint32_t numSessions;
+    double sampleRate;
+    uint32_t blockSize;
+    uint32_t numChannels;
+    size_t sessionStride;  // Bytes from a session to the next one.
+    size_t samplesOffset;  // Bytes from a session to its first sample.
+};
+
+namespace protocol
+{
+/**
+ * @brief This function rounds a size up to a whole number of cache lines.
+ *
+ * @param bytes: size expressed in bytes.
+ * @return size_t
+ */
+inline constexpr size_t alignToCacheLine (const size_t bytes) noexcept
+{
+    return (bytes + 63) / 64 * 64;
+}
+
+/**
+ * @brief This function fills the sizes of a header and gets the size of the whole segment.
+ *
+ * @param header: header with the number of sessions, the block size and the channels set.
+ * @return size_t
+ */
+inline size_t computeLayout (Header& header) noexcept
+{
+    header.samplesOffset = alignToCacheLine (sizeof (Session));
+    header.sessionStride = header.samplesOffset
+                         + alignToCacheLine (numBlockSlots * header.numChannels * header.blockSize * sizeof (float));
+
+    return alignToCacheLine (sizeof (Header)) + header.numSessions * header.sessionStride;
+}
+
+/**
+ * @brief This function gets a session of the segment.
+ *
+ * @param header: first byte of the segment.
+ * @param index: index of the session.
+ * @return Session&
+ */
+inline Session& getSession (Header& header, const uint32_t index) noexcept
+{
+    auto* base = reinterpret_cast<std::byte*> (&header) + alignToCacheLine (sizeof (Header));
+    return *reinterpret_cast<Session*> (base + index * header.sessionStride);
+}
+
+/**
+ * @brief This function gets the first sample of a channel in a block slot of a session.
+ *
+ * @param header: first byte of the segment.
+ * @param session: session of the segment.
+ * @param block: free running index of the block.
+ * @param channel: channel of the block.
+ * @return float*
+ */
+inline float* getSamples (const Header& header, Session& session, const uint32_t block, const uint32_t channel) noexcept
+{
+    auto* samples = reinterpret_cast<float*> (reinterpret_cast<std::byte*> (&session) + header.samplesOffset);
+    return samples + ((block % numBlockSlots) * header.numChannels + channel) * header.blockSize;
+}
+} // namespace protocol
+
+} // namespace render
+} // namespace cdrt
@@ -0,0 +1,142 @@
+#include "./SharedMemory.h"
+
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace cdrt
+{
+namespace render
+{
+//==============================================================================
+// class SharedMemory
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+bool SharedMemory::create (const std::string& newName, const size_t newSize)
+{
+    close();
+
+    // A segment left by a daemon that didn't exit cleanly is replaced.
+    ::shm_unlink (newName.c_str());
+
+    const auto descriptor = ::shm_open (newName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (descriptor < 0)
+        return false;
+
+    // New pages are zeroed by the kernel.
+    if (::ftruncate (descriptor, static_cast<off_t> (newSize)) != 0)
+    {
+        ::close (descriptor);
+        ::shm_unlink (newName.c_str());
+        return false;
+    }
+
+    auto* mapped = ::mmap (nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    ::close (descriptor);
+
+    if (mapped == MAP_FAILED)
+    {
+        ::shm_unlink (newName.c_str());
+        return false;
+    }
+
+    name = newName;
+    data = mapped;
+    size = newSize;
+    owner = true;
+    return true;
+}
+
+bool SharedMemory::open (const std::string& newName)
+{
+    close();
+
+    const auto descriptor = ::shm_open (newName.c_str(), O_RDWR, 0600);
+
+    if (descriptor < 0)
+        return false;
+
+    struct stat status {};
+
+    if (::fstat (descriptor, &status) != 0 || status.st_size <= 0)
+    {
+        ::close (descriptor);
+        return false;
+    }
+
+    auto* mapped = ::mmap (nullptr, static_cast<size_t> (status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    ::close (descriptor);
+
+    if (mapped == MAP_FAILED)
+        return false;
+
+    name = newName;
+    data = mapped;
+    size = static_cast<size_t> (status.st_size);
+    owner = false;
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (data == nullptr)
+        return;
+
+    ::munmap (data, size);
+
+    if (owner)
+        ::shm_unlink (name.c_str());
+
+    name.clear();
+    data = nullptr;
+    size = 0;
+    owner = false;
+}
+
+//==============================================================================
+// Getters.
+
+void* SharedMemory::getData() const noexcept
+{
+    return data;
+}
+
+size_t SharedMemory::getSize() const noexcept
+{
+    return size;
+}
+
+//==============================================================================
+// Futexes, not private: the word is shared between processes.
+
+namespace futex
+{
+void wait (std::atomic<uint32_t>& word, const uint32_t expected, const int timeoutMs) noexcept
+{
+    const timespec timeout { timeoutMs / 1000, static_cast<long> (timeoutMs % 1000) * 1000000L };
+
+    // Spurious wake ups and EAGAIN (the value changed) are fine, callers check the word again.
+    ::syscall (SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void wakeAll (std::atomic<uint32_t>& word) noexcept
+{
+    ::syscall (SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+} // namespace futex
+
+} // namespace render
+} // namespace cdrt
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace cdrt
+{
+namespace render
+{
+
+// POSIX shared memory segment mapped in the address space of the process, Linux only.
+// The render client and daemon share it and signal each other with futexes on the atomics
+// placed inside it, so nothing in this folder depends on JUCE: a batch renderer links the
+// client without the plugin.
+class SharedMemory
+{
+public:
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new SharedMemory object, nothing is mapped.
+     */
+    SharedMemory() {}
+
+    SharedMemory (const SharedMemory&) = delete;
+    SharedMemory& operator= (const SharedMemory&) = delete;
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * SharedMemory destructor, unmaps the segment and removes it when created by this object.
+     */
+    ~SharedMemory();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief This method creates a new zeroed segment and maps it, an old segment with the same name is replaced.
+     *
+     * @param newName: name of the segment, starting with '/'.
+     * @param newSize: size of the segment expressed in bytes.
+     * @return bool: false when the segment can't be created.
+     */
+    bool create (const std::string& newName, const size_t newSize);
+
+    /**
+     * @brief This method maps an existing segment.
+     *
+     * @param newName: name of the segment, starting with '/'.
+     * @return bool: false when the segment doesn't exist.
+     */
+    bool open (const std::string& newName);
+
+    /**
+     * @brief This method unmaps the segment, and removes it when created by this object.
+     */
+    void close();
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the first byte of the segment, nullptr when nothing is mapped.
+     * @return void*
+     */
+    void* getData() const noexcept;
+
+    /**
+     * @brief This method gets the size of the segment expressed in bytes.
+     * @return size_t
+     */
+    size_t getSize() const noexcept;
+
+private:
+    std::string name;
+    void* data = nullptr;
+    size_t size = 0;
+    bool owner = false;
+}; // class SharedMemory
+
+//==============================================================================
+// Futexes on 32 bit atomics of a shared segment, the waiters of every process are woken.
+
+namespace futex
+{
+static_assert (std::atomic<uint32_t>::is_always_lock_free && sizeof (std::atomic<uint32_t>) == sizeof (uint32_t));
+
+/**
+ * @brief This function sleeps while the word holds the expected value, until woken or the timeout.
+ *
+ * @param word: atomic in shared memory.
+ * @param expected: value to sleep on.
+ * @param timeoutMs: longest sleep expressed in milliseconds.
+ */
+void wait (std::atomic<uint32_t>& word, const uint32_t expected, const int timeoutMs) noexcept;
+
+/**
+ * @brief This function wakes every thread and process sleeping on the word.
+ *
+ * @param word: atomic in shared memory.
+ */
+void wakeAll (std::atomic<uint32_t>& word) noexcept;
+} // namespace futex
+
+} // namespace render
+} // namespace cdrt
@@ -0,0 +1,127 @@
+#include "./AlignedStorage.h"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+ #include <sys/mman.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+ #include <xmmintrin.h>
+#endif
+
+namespace cdrt
+{
+namespace utility
+{
+//==============================================================================
+// class AlignedStorage
+
+std::atomic<bool> AlignedStorage::hugePagesEnabled { true };
+
+AlignedStorage::~AlignedStorage()
+{
+    release();
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+bool AlignedStorage::allocate (const size_t numBytes)
+{
+    if (data != nullptr && numBytes <= capacity)
+    {
+        std::memset (data, 0, numBytes);
+        return true;
+    }
+
+    release();
+
+    if (numBytes == 0)
+        return true;
+
+    // Huge pages only for buffers that fill one, whole pages so that nothing else shares them.
+    const auto huge = hugePagesEnabled.load() && numBytes >= hugePageBytes;
+    const auto newAlignment = huge ? hugePageBytes : cacheLineBytes;
+    const auto newCapacity = (numBytes + newAlignment - 1) / newAlignment * newAlignment;
+
+    auto* newData = ::operator new (newCapacity, std::align_val_t (newAlignment), std::nothrow);
+
+    if (newData == nullptr)
+        return false;
+
+   #if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Before the first touch, the pages are faulted in as huge pages by the memset.
+    hugePageAdvised = huge && ::madvise (newData, newCapacity, MADV_HUGEPAGE) == 0;
+   #endif
+
+    std::memset (newData, 0, newCapacity);
+
+    data = newData;
+    capacity = newCapacity;
+    alignment = newAlignment;
+    return true;
+}
+
+void AlignedStorage::release() noexcept
+{
+    if (data != nullptr)
+        ::operator delete (data, std::align_val_t (alignment));
+
+    data = nullptr;
+    capacity = 0;
+    alignment = 0;
+    hugePageAdvised = false;
+}
+
+//==============================================================================
+// Getters.
+
+void* AlignedStorage::getData() const noexcept
+{
+    return data;
+}
+
+size_t AlignedStorage::getCapacity() const noexcept
+{
+    return capacity;
+}
+
+bool AlignedStorage::isHugePageAdvised() const noexcept
+{
+    return hugePageAdvised;
+}
+
+//==============================================================================
+// Settings.
+
+void AlignedStorage::setHugePagesEnabled (const bool shouldBeEnabled) noexcept
+{
+    hugePagesEnabled.store (shouldBeEnabled);
+}
+
+//==============================================================================
+// Prefetch.
+
+void AlignedStorage::prefetch (const void* range, const size_t numBytes) noexcept
+{
+    // From the cache line of the first byte.
+    const auto* last = static_cast<const char*> (range) + juce::jmin (numBytes, maxPrefetchBytes);
+    const auto* first = reinterpret_cast<const char*> (reinterpret_cast<std::uintptr_t> (range) & ~static_cast<std::uintptr_t> (cacheLineBytes - 1));
+
+    for (const auto* line = first; line < last; line += cacheLineBytes)
+    {
+       #if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch (line, 0, 3);
+       #elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_prefetch (line, _MM_HINT_T0);
+       #else
+        juce::ignoreUnused (line);
+       #endif
+    }
+}
+
+} // namespace utility
+} // namespace cdrt
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstddef>
+
+namespace cdrt
+{
+namespace utility
+{
+
+// Zeroed memory for long buffers (the circular buffers of the delay lines), aligned to the
+// cache lines. Allocations of a huge page or more are aligned to the huge pages and, on Linux,
+// advised for transparent huge pages: a read head megabytes away from the write head then
+// needs far fewer TLB entries. The advice is a hint, the kernel can ignore it.
+class AlignedStorage
+{
+public:
+    static constexpr size_t cacheLineBytes = 64;
+    static constexpr size_t hugePageBytes = 2 * 1024 * 1024;
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new AlignedStorage object, nothing is allocated.
+     */
+    AlignedStorage() {}
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * AlignedStorage destructor, releases the memory.
+     */
+    ~AlignedStorage();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief This method gets zeroed memory of the given size, the current memory is reused when large enough.
+     * It allocates, don't call it while processing.
+     *
+     * @param numBytes: size of the memory.
+     * @return bool: false when the allocation failed, nothing is allocated then.
+     */
+    bool allocate (const size_t numBytes);
+
+    /**
+     * @brief This method releases the memory.
+     */
+    void release() noexcept;
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the memory, nullptr when nothing is allocated.
+     * @return void*
+     */
+    void* getData() const noexcept;
+
+    /**
+     * @brief This method gets the size of the allocated memory, at least the size requested.
+     * @return size_t
+     */
+    size_t getCapacity() const noexcept;
+
+    /**
+     * @brief This method tells if the memory was advised for transparent huge pages.
+     * @return bool
+     */
+    bool isHugePageAdvised() const noexcept;
+
+    //==========================================================================
+    // Settings.
+
+    /**
+     * @brief This function enables the huge pages for the next allocations of every storage, enabled by default.
+     * Use it to compare both layouts.
+     *
+     * @param shouldBeEnabled: true to align to and advise the huge pages.
+     */
+    static void setHugePagesEnabled (const bool shouldBeEnabled) noexcept;
+
+    //==========================================================================
+    // Prefetch.
+
+    /**
+     * @brief This function asks the caches to load a range that is read soon, one hint per cache line.
+     * Long ranges are cut to maxPrefetchBytes, the hardware prefetcher follows the rest of a sequential read.
+     *
+     * @param range: first byte of the range.
+     * @param numBytes: size of the range.
+     */
+    static void prefetch (const void* range, const size_t numBytes) noexcept;
+
+    static constexpr size_t maxPrefetchBytes = 8192;
+
+private:
+    void* data = nullptr;
+    size_t capacity = 0;
+    size_t alignment = 0;
+    bool hugePageAdvised = false;
+
+    static std::atomic<bool> hugePagesEnabled;
+
+    JUCE_DECLARE_NON_COPYABLE (AlignedStorage)
+}; // class AlignedStorage
+
+} // namespace utility
+} // namespace cdrt
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <type_traits>
+#include "./Tables.h"
 
 namespace cdrt
 {
@@ -29,9 +30,9 @@ namespace InterpolationTypes
     // still possible but heavier computation.
     struct Lagrange3rd {};
 
-    // Successive samples in the delay will be interpolated using 1st order
-    // Thiran interpolation. Very efficient with flat amplitude frequency response
-    // but with less accuracy in the phase response.
+    // Successive samples in the delay will be interpolated using 1st to 4th order
+    // Thiran allpass interpolation. Very efficient with flat amplitude frequency response,
+    // the higher orders keep the phase response flat up to higher frequencies.
     // This interpolation is stateful, means it is unsuitable for applications
     // requiring fast delay modulation.
     struct Thiran {};
@@ -69,6 +70,17 @@ SampleType lagrange3rd (const SampleType sample1, const SampleType sample2, cons
     return sample1 * c1 + delayFrac * (sample2 * c2 + sample3 * c3 + sample4 * c4);
 }
 
+// Lagrange interpolation function with coefficients from a compile time table.
+// delayFrac must be in [1, 2], it is rounded to the nearest of the NumPhases + 1 positions.
+template <typename SampleType, std::size_t NumPhases = 256, std::enable_if_t<std::is_floating_point<SampleType>::value, bool> = true>
+SampleType lagrange3rdTabulated (const SampleType sample1, const SampleType sample2, const SampleType sample3, const SampleType sample4, const float delayFrac)
+{
+    const auto& table = cdrt::utility::tables::lagrange3rdTable<NumPhases, SampleType>;
+    const auto& c = table[static_cast<std::size_t> ((delayFrac - 1.f) * static_cast<float> (NumPhases) + 0.5f)];
+
+    return sample1 * c[0] + sample2 * c[1] + sample3 * c[2] + sample4 * c[3];
+}
+
 // Thiran interpolation function.
 template <typename SampleType>
 SampleType thiran (const SampleType sample1, const SampleType sample2, const float delayFrac, const SampleType alpha, const SampleType &prev)
@@ -81,6 +93,26 @@ SampleType thiran (const SampleType sample1, const SampleType sample2, const flo
     return (delayFrac == 0) * sample1 + (delayFrac != 0) * (sample2 + alpha * (sample1 - prev));
 }
 
+// Thiran allpass coefficients a1...aN of the given order (a0 is 1) for a delay in (order - 1, order + 1),
+// the delay is flattest (no ringing) in [order - 0.5, order + 0.5). With delay == order every coefficient is 0.
+template <typename SampleType, std::enable_if_t<std::is_floating_point<SampleType>::value, bool> = true>
+void thiranCoefficients (const int order, const double delay, SampleType* coefficients)
+{
+    double binomial = 1.0;
+
+    for (int k = 1; k <= order; ++k)
+    {
+        binomial *= static_cast<double> (order - k + 1) / static_cast<double> (k);
+
+        auto coefficient = (k % 2 == 0 ? 1.0 : -1.0) * binomial;
+
+        for (int n = 0; n <= order; ++n)
+            coefficient *= (delay - order + n) / (delay - order + k + n);
+
+        coefficients[k - 1] = static_cast<SampleType> (coefficient);
+    }
+}
+
 } // namespace interpolation
 } // namespace utility
 } // namespace cdrt
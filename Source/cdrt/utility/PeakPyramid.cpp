@@ -0,0 +1,218 @@
+#include "./PeakPyramid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cdrt
+{
+namespace utility
+{
+//==============================================================================
+// class PeakPyramid
+
+//==============================================================================
+// Preparation.
+
+void PeakPyramid::prepare (const int newNumChannels, const int newHistorySamples)
+{
+    jassert (newNumChannels >= 0 && newHistorySamples >= 0);
+
+    const juce::SpinLock::ScopedLockType lock (layoutLock);
+
+    numChannels = newNumChannels;
+    historySamples = newHistorySamples;
+    levels.clear();
+    valuesPerChannel = 0;
+
+    // Every ring keeps the history plus the bucket being written, up to the level with a few buckets.
+    for (auto bucketSamples = static_cast<juce::int64> (baseBucketSamples);; bucketSamples *= branching)
+    {
+        Level level;
+        level.bucketSamples = static_cast<int> (bucketSamples);
+        level.numBuckets = static_cast<int> (historySamples / bucketSamples) + 2;
+        level.offset = valuesPerChannel;
+
+        levels.push_back (level);
+        valuesPerChannel += 2 * static_cast<size_t> (level.numBuckets);
+
+        if (historySamples / bucketSamples < branching)
+            break;
+    }
+
+    values = std::make_unique<std::atomic<float>[]> (valuesPerChannel * static_cast<size_t> (numChannels));
+    counts = std::make_unique<std::atomic<juce::int64>[]> (static_cast<size_t> (numChannels));
+
+    reset();
+}
+
+void PeakPyramid::reset() noexcept
+{
+    // Nothing pushed, the old buckets are never read.
+    for (int channel = 0; channel < numChannels; ++channel)
+        counts[static_cast<size_t> (channel)].store (0, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// Writing.
+
+void PeakPyramid::push (const int channel, const float* samples, const int numSamples) noexcept
+{
+    if (numSamples <= 0 || ! juce::isPositiveAndBelow (channel, numChannels))
+        return;
+
+    auto& count = counts[static_cast<size_t> (channel)];
+    const auto first = count.load (std::memory_order_relaxed);
+    const auto last = first + numSamples;
+
+    const auto initialSequence = sequence.load (std::memory_order_relaxed);
+    sequence.store (initialSequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+
+    // First level from the samples, a bucket starts over with its first sample.
+    const auto& base = levels.front();
+
+    for (auto position = first; position < last;)
+    {
+        const auto offsetInBucket = static_cast<int> (position % base.bucketSamples);
+        const auto numBucketSamples = static_cast<int> (juce::jmin (last - position, static_cast<juce::int64> (base.bucketSamples - offsetInBucket)));
+
+        float minimum, maximum;
+        juce::FloatVectorOperations::findMinAndMax (samples + (position - first), numBucketSamples, minimum, maximum);
+
+        auto* bucket = getBucket (channel, base, position / base.bucketSamples);
+
+        if (offsetInBucket != 0)
+        {
+            minimum = juce::jmin (minimum, bucket[0].load (std::memory_order_relaxed));
+            maximum = juce::jmax (maximum, bucket[1].load (std::memory_order_relaxed));
+        }
+
+        bucket[0].store (minimum, std::memory_order_relaxed);
+        bucket[1].store (maximum, std::memory_order_relaxed);
+        position += numBucketSamples;
+    }
+
+    // Next levels from the buckets below, those after the newest one belong to the previous turn of the ring.
+    for (size_t index = 1; index < levels.size(); ++index)
+    {
+        const auto& lower = levels[index - 1];
+        const auto& level = levels[index];
+        const auto newestChild = (last - 1) / lower.bucketSamples;
+
+        for (auto bucket = first / level.bucketSamples; bucket <= (last - 1) / level.bucketSamples; ++bucket)
+        {
+            const auto firstChild = bucket * branching;
+            const auto* child = getBucket (channel, lower, firstChild);
+            auto minimum = child[0].load (std::memory_order_relaxed);
+            auto maximum = child[1].load (std::memory_order_relaxed);
+
+            for (auto other = firstChild + 1; other < firstChild + branching && other <= newestChild; ++other)
+            {
+                child = getBucket (channel, lower, other);
+                minimum = juce::jmin (minimum, child[0].load (std::memory_order_relaxed));
+                maximum = juce::jmax (maximum, child[1].load (std::memory_order_relaxed));
+            }
+
+            auto* parent = getBucket (channel, level, bucket);
+            parent[0].store (minimum, std::memory_order_relaxed);
+            parent[1].store (maximum, std::memory_order_relaxed);
+        }
+    }
+
+    count.store (last, std::memory_order_relaxed);
+    sequence.store (initialSequence + 2, std::memory_order_release);
+}
+
+//==============================================================================
+// Reading.
+
+bool PeakPyramid::getPeaks (const int channel, const double newestAge, const double oldestAge, Peak* peaks, const int numPeaks) const noexcept
+{
+    const juce::SpinLock::ScopedLockType lock (layoutLock);
+
+    if (numPeaks <= 0)
+        return true;
+
+    if (! juce::isPositiveAndBelow (channel, numChannels) || oldestAge <= newestAge)
+    {
+        std::fill (peaks, peaks + numPeaks, Peak());
+        return true;
+    }
+
+    // The coarsest level with buckets not longer than a span, a span then covers at most branching + 2 buckets.
+    const auto span = (oldestAge - newestAge) / numPeaks;
+    size_t index = 0;
+
+    while (index + 1 < levels.size() && levels[index + 1].bucketSamples <= span)
+        ++index;
+
+    const auto& level = levels[index];
+
+    for (int attempt = 1;; ++attempt)
+    {
+        const auto initialSequence = sequence.load (std::memory_order_acquire);
+        const auto count = counts[static_cast<size_t> (channel)].load (std::memory_order_relaxed);
+        const auto oldest = juce::jmax (static_cast<juce::int64> (0), count - historySamples);
+
+        for (int peak = 0; peak < numPeaks; ++peak)
+        {
+            // Samples from start to end (excluded), at least one.
+            const auto end = count - static_cast<juce::int64> (std::floor (newestAge + peak * span));
+            const auto start = juce::jmax (oldest, juce::jmin (end - 1, count - static_cast<juce::int64> (std::floor (newestAge + (peak + 1) * span))));
+
+            if (start >= juce::jmin (end, count))
+            {
+                peaks[peak] = Peak();
+                continue;
+            }
+
+            const auto* bucket = getBucket (channel, level, start / level.bucketSamples);
+            auto minimum = bucket[0].load (std::memory_order_relaxed);
+            auto maximum = bucket[1].load (std::memory_order_relaxed);
+
+            for (auto other = start / level.bucketSamples + 1; other <= (juce::jmin (end, count) - 1) / level.bucketSamples; ++other)
+            {
+                bucket = getBucket (channel, level, other);
+                minimum = juce::jmin (minimum, bucket[0].load (std::memory_order_relaxed));
+                maximum = juce::jmax (maximum, bucket[1].load (std::memory_order_relaxed));
+            }
+
+            peaks[peak] = { minimum, maximum };
+        }
+
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (initialSequence % 2 == 0 && sequence.load (std::memory_order_relaxed) == initialSequence)
+            return true;
+
+        if (attempt == maxReadAttempts)
+            return false;
+    }
+}
+
+std::atomic<float>* PeakPyramid::getBucket (const int channel, const Level& level, const juce::int64 bucket) const noexcept
+{
+    const auto slot = static_cast<size_t> (bucket % level.numBuckets);
+    return values.get() + static_cast<size_t> (channel) * valuesPerChannel + level.offset + 2 * slot;
+}
+
+//==============================================================================
+// Getters.
+
+int PeakPyramid::getNumChannels() const noexcept
+{
+    return numChannels;
+}
+
+int PeakPyramid::getHistorySamples() const noexcept
+{
+    return historySamples;
+}
+
+int PeakPyramid::getNumLevels() const noexcept
+{
+    return static_cast<int> (levels.size());
+}
+
+} // namespace utility
+} // namespace cdrt
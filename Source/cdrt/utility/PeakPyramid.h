@@ -0,0 +1,135 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace cdrt
+{
+namespace utility
+{
+
+// Minimum and maximum of the last samples of a few channels at several resolutions, for the displays.
+// The audio thread pushes the samples as they are written, only the buckets they touch are updated:
+// the first level has a bucket every baseBucketSamples samples, every next level merges branching
+// buckets of the one below. A reader (the editor) gets the peaks of any span of the history reading
+// at most branching + 2 buckets for each peak. The audio thread takes no lock: a sequence counter (seqlock) tells
+// the reader when the audio thread wrote while it was reading, the read is then repeated.
+class PeakPyramid
+{
+public:
+    static constexpr int baseBucketSamples = 16;
+    static constexpr int branching = 4;
+    static constexpr int maxReadAttempts = 4;
+
+    struct Peak
+    {
+        float minimum = 0.0f;
+        float maximum = 0.0f;
+    };
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new PeakPyramid object, call prepare before using it.
+     */
+    PeakPyramid() {}
+
+    //==========================================================================
+    // Preparation.
+
+    /**
+     * @brief This method allocates the levels for the given history and clears them.
+     * It allocates, don't call it while processing. The readers wait for it to complete.
+     *
+     * @param newNumChannels: number of channels.
+     * @param newHistorySamples: number of samples kept, the oldest ones are dropped.
+     */
+    void prepare (const int newNumChannels, const int newHistorySamples);
+
+    /**
+     * @brief This method clears the history, on the thread pushing the samples.
+     */
+    void reset() noexcept;
+
+    //==========================================================================
+    // Writing.
+
+    /**
+     * @brief This method adds the newest samples of a channel, only one thread can push.
+     *
+     * @param channel: channel of the samples.
+     * @param samples: samples from the oldest to the newest.
+     * @param numSamples: number of samples.
+     */
+    void push (const int channel, const float* samples, const int numSamples) noexcept;
+
+    //==========================================================================
+    // Reading.
+
+    /**
+     * @brief This method gets the peaks of numPeaks equal spans between two ages of the samples, 0 being the newest
+     * sample pushed. Peaks[0] is the newest span, a span older than the history or not pushed yet gets zeros. A span
+     * shorter than baseBucketSamples gets the peaks of the whole bucket.
+     *
+     * @param channel: channel to read.
+     * @param newestAge: age in samples where the first span starts.
+     * @param oldestAge: age in samples where the last span ends.
+     * @param peaks: numPeaks peaks receiving the result.
+     * @param numPeaks: number of spans.
+     * @return bool: false when the samples kept changing while reading, the peaks can then mix old and new values.
+     */
+    bool getPeaks (const int channel, const double newestAge, const double oldestAge, Peak* peaks, const int numPeaks) const noexcept;
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the number of channels given at prepare time.
+     * @return int
+     */
+    int getNumChannels() const noexcept;
+
+    /**
+     * @brief This method gets the number of samples kept for every channel.
+     * @return int
+     */
+    int getHistorySamples() const noexcept;
+
+    /**
+     * @brief This method gets the number of levels, the last one has at most branching buckets in the history.
+     * @return int
+     */
+    int getNumLevels() const noexcept;
+
+private:
+    struct Level
+    {
+        int bucketSamples = 0;
+        int numBuckets = 0;
+        size_t offset = 0; // First value of the level in a channel.
+    };
+
+    // Minimum and maximum of every bucket, level after level, one channel after the other.
+    std::atomic<float>* getBucket (const int channel, const Level& level, const juce::int64 bucket) const noexcept;
+
+    int numChannels = 0;
+    int historySamples = 0;
+    size_t valuesPerChannel = 0;
+    std::vector<Level> levels;
+    std::unique_ptr<std::atomic<float>[]> values;
+    std::unique_ptr<std::atomic<juce::int64>[]> counts; // Samples pushed to every channel.
+
+    // Odd while the audio thread writes.
+    std::atomic<juce::uint32> sequence { 0 };
+
+    // Held by prepare and by the readers, never by the audio thread.
+    juce::SpinLock layoutLock;
+
+    JUCE_DECLARE_NON_COPYABLE (PeakPyramid)
+}; // class PeakPyramid
+
+} // namespace utility
+} // namespace cdrt
@@ -0,0 +1,116 @@
+#include "./QualityGovernor.h"
+
+namespace cdrt
+{
+namespace utility
+{
+//==============================================================================
+// class QualityGovernor
+
+//==============================================================================
+// Allocation/Deallocation.
+
+void QualityGovernor::prepare (const double newSampleRate)
+{
+    jassert (newSampleRate > 0.0);
+
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void QualityGovernor::reset() noexcept
+{
+    level = maximumLevel;
+    load = 0.0;
+    timeAbove = 0.0;
+    timeOverloaded = 0.0;
+    timeBelow = 0.0;
+    timeSinceChange = 0.0;
+}
+
+//==============================================================================
+// Setters.
+
+void QualityGovernor::setMaximumLevel (const int newMaximumLevel) noexcept
+{
+    jassert (newMaximumLevel >= 0);
+
+    // A higher maximum is reached stepping up as usual.
+    maximumLevel = newMaximumLevel;
+    level = juce::jmin (level, maximumLevel);
+}
+
+void QualityGovernor::setThresholds (const double newStepDownLoad, const double newStepUpLoad) noexcept
+{
+    jassert (newStepUpLoad < newStepDownLoad);
+
+    stepDownLoad = newStepDownLoad;
+    stepUpLoad = newStepUpLoad;
+}
+
+void QualityGovernor::setOverload (const double newOverloadLoad, const int newOverloadLevel) noexcept
+{
+    jassert (newOverloadLoad > stepDownLoad && newOverloadLevel >= 0);
+
+    overloadLoad = newOverloadLoad;
+    overloadLevel = newOverloadLevel;
+}
+
+//==============================================================================
+// Getters.
+
+int QualityGovernor::getLevel() const noexcept
+{
+    return level;
+}
+
+double QualityGovernor::getLoad() const noexcept
+{
+    return load;
+}
+
+//==============================================================================
+// Processing.
+
+bool QualityGovernor::addMeasurement (const double elapsedSeconds, const int numSamples) noexcept
+{
+    if (numSamples <= 0)
+        return false;
+
+    const auto blockTime = static_cast<double> (numSamples) / sampleRate;
+
+    // One pole average, the coefficient depends on the block duration.
+    const auto alpha = 1.0 - std::exp (-blockTime / averageTime);
+    load += alpha * (elapsedSeconds / blockTime - load);
+
+    timeAbove = load > stepDownLoad ? timeAbove + blockTime : 0.0;
+    timeOverloaded = load > overloadLoad ? timeOverloaded + blockTime : 0.0;
+    timeBelow = load < stepUpLoad ? timeBelow + blockTime : 0.0;
+    timeSinceChange += blockTime;
+
+    auto newLevel = level;
+
+    // The overload level is reached without waiting for the load to settle, below it the steps are one at a time.
+    if (timeOverloaded >= stepDownTime && level > overloadLevel)
+        newLevel = overloadLevel;
+    else if (timeSinceChange < settleTime)
+        return false;
+    else if (timeAbove >= stepDownTime && level > 0)
+        --newLevel;
+    else if (timeBelow >= stepUpTime && level < maximumLevel)
+        ++newLevel;
+
+    if (newLevel == level)
+        return false;
+
+    level = newLevel;
+    timeAbove = 0.0;
+    timeOverloaded = 0.0;
+    timeBelow = 0.0;
+    timeSinceChange = 0.0;
+
+    return true;
+}
+
+} // namespace utility
+} // namespace cdrt
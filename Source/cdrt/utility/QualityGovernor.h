@@ -0,0 +1,119 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+namespace cdrt
+{
+namespace utility
+{
+
+// Chooses a quality level from the measured processing load.
+// The load is the time spent processing a block divided by the duration of the block,
+// it is averaged over a short window. The level goes down when the average stays above
+// the step down threshold, and goes up only after a longer time below the step up one.
+// After every change the governor waits for the load to settle before moving again.
+// Far above the threshold, in overload, the level drops at once to a cheap one instead.
+class QualityGovernor
+{
+public:
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new QualityGovernor object.
+     */
+    QualityGovernor() {}
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief Call this method before doing anything else to initialize the governor.
+     *
+     * @param newSampleRate: sample rate of the measured blocks.
+     */
+    void prepare (const double newSampleRate);
+
+    /**
+     * @brief This method forgets the measured load and goes back to the maximum level.
+     */
+    void reset() noexcept;
+
+    //==========================================================================
+    // Setters.
+
+    /**
+     * @brief This method sets the highest level, the current level is lowered if above it.
+     *
+     * @param newMaximumLevel: highest level, levels go from 0 to this value.
+     */
+    void setMaximumLevel (const int newMaximumLevel) noexcept;
+
+    /**
+     * @brief This method sets the load thresholds, expressed as a fraction of the block duration.
+     *
+     * @param newStepDownLoad: average load above which the level goes down.
+     * @param newStepUpLoad: average load below which the level goes up, lower than newStepDownLoad.
+     */
+    void setThresholds (const double newStepDownLoad, const double newStepUpLoad) noexcept;
+
+    /**
+     * @brief This method sets the overload threshold, above it the level skips the ones in between.
+     *
+     * @param newOverloadLoad: average load above which the level drops at once, higher than the step down one.
+     * @param newOverloadLevel: level reached in overload, a lower current level is kept.
+     */
+    void setOverload (const double newOverloadLoad, const int newOverloadLevel) noexcept;
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the current level.
+     * @return int
+     */
+    int getLevel() const noexcept;
+
+    /**
+     * @brief This method gets the average load.
+     * @return double
+     */
+    double getLoad() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method adds the measure of a processed block and updates the level.
+     *
+     * @param elapsedSeconds: time spent processing the block.
+     * @param numSamples: number of samples in the block.
+     * @return true if the level changed.
+     */
+    bool addMeasurement (const double elapsedSeconds, const int numSamples) noexcept;
+
+private:
+    // Timings expressed in seconds.
+    static constexpr double averageTime = 0.1;
+    static constexpr double stepDownTime = 0.1;
+    static constexpr double stepUpTime = 2.0;
+    static constexpr double settleTime = 0.5;
+
+    double sampleRate = 44100.0;
+    double stepDownLoad = 0.6;
+    double stepUpLoad = 0.3;
+    double overloadLoad = std::numeric_limits<double>::infinity();
+    int overloadLevel = 0;
+
+    int maximumLevel = 0;
+    int level = 0;
+
+    double load = 0.0;
+    double timeAbove = 0.0;
+    double timeOverloaded = 0.0;
+    double timeBelow = 0.0;
+    double timeSinceChange = 0.0;
+}; // class QualityGovernor
+
+} // namespace utility
+} // namespace cdrt
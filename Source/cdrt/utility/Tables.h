@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace cdrt
+{
+namespace utility
+{
+namespace tables
+{
+
+//==============================================================================
+// Fixed tables generated at compile time.
+// Every table is an inline constexpr variable: it is computed by the compiler,
+// stored in read-only data and shared by all the instances of the plugin.
+// Tables are selected by template parameters (shape, size, sample type).
+
+namespace detail
+{
+inline constexpr double pi = 3.14159265358979323846;
+
+// Taylor series of the sine, the argument is reduced to [-pi/2, pi/2] first.
+consteval double sine (double x)
+{
+    while (x > pi)
+        x -= 2.0 * pi;
+    while (x < -pi)
+        x += 2.0 * pi;
+
+    if (x > pi / 2.0)
+        x = pi - x;
+    else if (x < -pi / 2.0)
+        x = -pi - x;
+
+    double term = x;
+    double sum = x;
+
+    for (int n = 1; n < 12; ++n)
+    {
+        term *= -x * x / static_cast<double> ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+} // namespace detail
+
+//==============================================================================
+// Crossfade windows.
+
+// Shapes of the fade in curve, the fade out is the same curve read backwards.
+enum class Window
+{
+    linear,     // Gains sum to 1, for correlated signals, audible corners at the ends.
+    equalPower, // Powers sum to 1, for uncorrelated signals.
+    hann        // Gains sum to 1 with smooth ends, for correlated signals.
+};
+
+/**
+ @brief: This function generates the fade in curve of a window over [0, 1], the table has Size + 1 points so both ends are included.
+ */
+template <Window shape, std::size_t Size, typename SampleType>
+consteval std::array<SampleType, Size + 1> makeWindow()
+{
+    std::array<SampleType, Size + 1> table {};
+
+    for (std::size_t i = 0; i <= Size; ++i)
+    {
+        const auto position = static_cast<double> (i) / static_cast<double> (Size);
+
+        if constexpr (shape == Window::linear)
+            table[i] = static_cast<SampleType> (position);
+        else if constexpr (shape == Window::equalPower)
+            table[i] = static_cast<SampleType> (detail::sine (position * detail::pi / 2.0));
+        else // 0.5 - 0.5 cos (pi x), written as a square so both ends are exact.
+            table[i] = static_cast<SampleType> (detail::sine (position * detail::pi / 2.0) * detail::sine (position * detail::pi / 2.0));
+    }
+
+    return table;
+}
+
+template <Window shape, std::size_t Size = 512, typename SampleType = float>
+inline constexpr auto windowTable = makeWindow<shape, Size, SampleType>();
+
+/**
+ @brief: This function gets the fade in gain of a window at the given position, linearly interpolating the table.
+ Use getWindowGain (1 - position) for the fade out gain.
+ */
+template <Window shape, std::size_t Size = 512, typename SampleType>
+SampleType getWindowGain (const SampleType position) noexcept
+{
+    static_assert (std::is_floating_point_v<SampleType>);
+
+    const auto& table = windowTable<shape, Size, SampleType>;
+    const auto scaled = position * static_cast<SampleType> (Size);
+    const auto index = static_cast<std::size_t> (scaled);
+
+    if (index >= Size)
+        return table[Size];
+
+    const auto frac = scaled - static_cast<SampleType> (index);
+    return table[index] + frac * (table[index + 1] - table[index]);
+}
+
+//==============================================================================
+// Lagrange 3rd order coefficients.
+
+/**
+ @brief: This function generates the 4 coefficients of the 3rd order Lagrange interpolation for NumPhases + 1 fractional positions.
+ The positions cover [1, 2], the range between the central samples used by the delay lines.
+ */
+template <std::size_t NumPhases, typename SampleType>
+consteval std::array<std::array<SampleType, 4>, NumPhases + 1> makeLagrange3rd()
+{
+    std::array<std::array<SampleType, 4>, NumPhases + 1> table {};
+
+    for (std::size_t i = 0; i <= NumPhases; ++i)
+    {
+        const auto d = 1.0 + static_cast<double> (i) / static_cast<double> (NumPhases);
+
+        table[i][0] = static_cast<SampleType> (-(d - 1.0) * (d - 2.0) * (d - 3.0) / 6.0);
+        table[i][1] = static_cast<SampleType> (d * (d - 2.0) * (d - 3.0) / 2.0);
+        table[i][2] = static_cast<SampleType> (-d * (d - 1.0) * (d - 3.0) / 2.0);
+        table[i][3] = static_cast<SampleType> (d * (d - 1.0) * (d - 2.0) / 6.0);
+    }
+
+    return table;
+}
+
+template <std::size_t NumPhases = 256, typename SampleType = float>
+inline constexpr auto lagrange3rdTable = makeLagrange3rd<NumPhases, SampleType>();
+
+} // namespace tables
+} // namespace utility
+} // namespace cdrt
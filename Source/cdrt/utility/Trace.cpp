@@ -0,0 +1,178 @@
+#include "./Trace.h"
+
+#include <vector>
+
+namespace cdrt
+{
+namespace utility
+{
+namespace trace
+{
+//==============================================================================
+// class ThreadBuffer
+
+ThreadBuffer::ThreadBuffer (const int newThreadIndex)
+    : events (capacity), threadIndex (newThreadIndex)
+{
+}
+
+void ThreadBuffer::push (const Event& event) noexcept
+{
+    const auto currentHead = head.load (std::memory_order_relaxed);
+
+    if (currentHead - tail.load (std::memory_order_acquire) >= capacity)
+    {
+        dropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    events[currentHead & (capacity - 1)] = event;
+    head.store (currentHead + 1, std::memory_order_release);
+}
+
+void ThreadBuffer::drain (const std::function<void (const Event&)>& callback)
+{
+    const auto currentHead = head.load (std::memory_order_acquire);
+    auto currentTail = tail.load (std::memory_order_relaxed);
+
+    for (; currentTail != currentHead; ++currentTail)
+        callback (events[currentTail & (capacity - 1)]);
+
+    tail.store (currentTail, std::memory_order_release);
+}
+
+int ThreadBuffer::getThreadIndex() const noexcept
+{
+    return threadIndex;
+}
+
+int ThreadBuffer::getAndResetDroppedEvents() noexcept
+{
+    return dropped.exchange (0, std::memory_order_relaxed);
+}
+
+
+//==============================================================================
+// class Session
+
+std::atomic<Session*> Session::activeSession { nullptr };
+std::atomic<int> Session::sessionGeneration { 0 };
+
+Session::Session()
+    : juce::Thread ("cdrt trace writer"), originTicks (juce::Time::getHighResolutionTicks())
+{
+    auto defaultFile = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                           .getChildFile ("StillLate-trace-" + juce::Time::getCurrentTime().formatted ("%Y%m%d-%H%M%S") + ".json");
+
+    juce::File file (juce::SystemStats::getEnvironmentVariable ("STILLLATE_TRACE_FILE", defaultFile.getFullPathName()));
+    file.deleteFile();
+
+    output = std::make_unique<juce::FileOutputStream> (file);
+
+    if (! output->openedOk())
+    {
+        jassertfalse;
+        output.reset();
+        return;
+    }
+
+    *output << "{\"traceEvents\":[\n";
+
+    sessionGeneration.fetch_add (1);
+    activeSession.store (this);
+
+    startThread (juce::Thread::Priority::background);
+}
+
+Session::~Session()
+{
+    activeSession.store (nullptr);
+    stopThread (1000);
+
+    if (output == nullptr)
+        return;
+
+    flush();
+    *output << "\n]}\n";
+    output->flush();
+}
+
+ThreadBuffer* Session::getBufferForCurrentThread()
+{
+    // The generation invalidates the cached pointer when a session
+    // is destroyed and a new one is created later in the same process.
+    thread_local int cachedGeneration = -1;
+    thread_local ThreadBuffer* cachedBuffer = nullptr;
+
+    auto* session = activeSession.load (std::memory_order_acquire);
+
+    if (session == nullptr)
+        return nullptr;
+
+    const auto generation = sessionGeneration.load (std::memory_order_relaxed);
+
+    if (cachedGeneration != generation)
+    {
+        const juce::ScopedLock sl (session->registrationLock);
+        cachedBuffer = session->buffers.add (new ThreadBuffer (session->buffers.size() + 1));
+        cachedGeneration = generation;
+    }
+
+    return cachedBuffer;
+}
+
+//==============================================================================
+// Writer thread.
+
+void Session::run()
+{
+    while (! threadShouldExit())
+    {
+        wait (100);
+        flush();
+    }
+}
+
+void Session::flush()
+{
+    // The buffers live as long as the session: the list is copied under the lock and the file is
+    // written outside it, a thread tracing for the first time never waits for the disk.
+    std::vector<ThreadBuffer*> buffersToDrain;
+    {
+        const juce::ScopedLock sl (registrationLock);
+        buffersToDrain.assign (buffers.begin(), buffers.end());
+    }
+
+    const auto ticksPerMicrosecond = static_cast<double> (juce::Time::getHighResolutionTicksPerSecond()) / 1.0e6;
+
+    for (auto* buffer : buffersToDrain)
+    {
+        buffer->drain ([&] (const Event& event)
+        {
+            *output << (firstEvent ? "" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"cat\":\"dsp\",\"ph\":\"X\",\"pid\":1"
+                    << ",\"tid\":" << buffer->getThreadIndex()
+                    << ",\"ts\":" << static_cast<double> (event.start - originTicks) / ticksPerMicrosecond
+                    << ",\"dur\":" << static_cast<double> (event.end - event.start) / ticksPerMicrosecond << "}";
+
+            firstEvent = false;
+        });
+
+        // Leave a trace of lost events so the report is not silently incomplete.
+        if (auto dropped = buffer->getAndResetDroppedEvents(); dropped > 0)
+        {
+            *output << (firstEvent ? "" : ",\n")
+                    << "{\"name\":\"dropped " << dropped << " events\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1"
+                    << ",\"tid\":" << buffer->getThreadIndex()
+                    << ",\"ts\":" << static_cast<double> (juce::Time::getHighResolutionTicks() - originTicks) / ticksPerMicrosecond << "}";
+
+            firstEvent = false;
+        }
+    }
+
+    output->flush();
+}
+
+} // namespace trace
+} // namespace utility
+} // namespace cdrt
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+// Scoped trace markers.
+// When the project is configured with STILLLATE_ENABLE_TRACING=ON the
+// CDRT_ENABLE_TRACING definition is set and every CDRT_TRACE_SCOPE records a
+// complete event (begin + duration) into a per-thread ring buffer.
+// When tracing is disabled the macros expand to nothing, so release builds
+// do not pay anything for the instrumentation.
+#if CDRT_ENABLE_TRACING
+ #define CDRT_TRACE_SCOPE(name) const cdrt::utility::trace::ScopedTrace JUCE_JOIN_MACRO (cdrtTraceScope_, __LINE__) (name)
+#else
+ #define CDRT_TRACE_SCOPE(name)
+#endif
+
+namespace cdrt
+{
+namespace utility
+{
+namespace trace
+{
+
+// A single complete event, timestamps are expressed in high resolution ticks.
+struct Event
+{
+    const char* name;
+    juce::int64 start;
+    juce::int64 end;
+};
+
+// Single producer single consumer ring buffer owned by one recording thread.
+// The recording thread is the only writer, the writer thread of the session
+// is the only reader, no locks are involved in both sides.
+class ThreadBuffer
+{
+public:
+    //==========================================================================
+    // Constructor.
+
+    /**
+     * @brief Construct a new ThreadBuffer object.
+     *
+     * @param newThreadIndex: index used as "tid" in the exported trace.
+     */
+    explicit ThreadBuffer (const int newThreadIndex);
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method stores an event, if the buffer is full the event is dropped.
+     *
+     * @param event: event to store.
+     */
+    void push (const Event& event) noexcept;
+
+    /**
+     * @brief This method reads all the events currently stored in the buffer.
+     *
+     * @param callback: function called for each event read.
+     */
+    void drain (const std::function<void (const Event&)>& callback);
+
+    /**
+     * @brief This method gets the index of the thread owning the buffer.
+     *
+     * @return int
+     */
+    int getThreadIndex() const noexcept;
+
+    /**
+     * @brief This method gets and clears the number of events dropped because the buffer was full.
+     *
+     * @return int
+     */
+    int getAndResetDroppedEvents() noexcept;
+
+private:
+    static constexpr size_t capacity = 1 << 15; // Power of two, used as mask.
+
+    std::vector<Event> events;
+    std::atomic<size_t> head { 0 }; // Written by the producer.
+    std::atomic<size_t> tail { 0 }; // Written by the consumer.
+    std::atomic<int> dropped { 0 };
+    const int threadIndex;
+}; // class ThreadBuffer
+
+// Shared trace session, use it through juce::SharedResourcePointer<Session>
+// so all the plugin instances living in the same process write to the same file.
+// The output file is read from the STILLLATE_TRACE_FILE environment variable,
+// when missing a time stamped file is created in the temporary directory.
+class Session : private juce::Thread
+{
+public:
+    //==========================================================================
+    // Constructor/Destructor.
+
+    /**
+     * @brief Construct a new Session object, opens the output file and starts the writer thread.
+     */
+    Session();
+
+    /**
+     * Flushes the pending events, closes the JSON document and stops the writer thread.
+     */
+    ~Session() override;
+
+    //==========================================================================
+    // Recording.
+
+    /**
+     * @brief This method gets the ring buffer of the calling thread, registering it at the first call.
+     * The registration takes a lock once per thread, all the following calls are lock free.
+     *
+     * @return ThreadBuffer*: nullptr if no session is active.
+     */
+    static ThreadBuffer* getBufferForCurrentThread();
+
+private:
+    //==========================================================================
+    // Writer thread.
+    void run() override;
+
+    /**
+     * @brief This method moves all the recorded events to the output file.
+     */
+    void flush();
+
+    static std::atomic<Session*> activeSession;
+    static std::atomic<int> sessionGeneration;
+
+    juce::CriticalSection registrationLock;
+    juce::OwnedArray<ThreadBuffer> buffers;
+
+    std::unique_ptr<juce::FileOutputStream> output;
+    juce::int64 originTicks;
+    bool firstEvent = true;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Session)
+}; // class Session
+
+// RAII marker used by CDRT_TRACE_SCOPE, the event is recorded on destruction.
+class ScopedTrace
+{
+public:
+    explicit ScopedTrace (const char* newName) noexcept
+        : name (newName), buffer (Session::getBufferForCurrentThread()), start (juce::Time::getHighResolutionTicks())
+    {
+    }
+
+    ~ScopedTrace()
+    {
+        if (buffer != nullptr)
+            buffer->push ({ name, start, juce::Time::getHighResolutionTicks() });
+    }
+
+private:
+    const char* name;
+    ThreadBuffer* buffer;
+    juce::int64 start;
+}; // class ScopedTrace
+
+} // namespace trace
+} // namespace utility
+} // namespace cdrt
@@ -0,0 +1,152 @@
+#include "./WorkerPool.h"
+
+namespace cdrt
+{
+namespace utility
+{
+//==============================================================================
+// class WorkerPool
+
+WorkerPool::~WorkerPool()
+{
+    stop();
+}
+
+//==============================================================================
+// Allocation/Deallocation.
+
+void WorkerPool::start (const int numWorkers)
+{
+    jassert (numWorkers >= 0);
+
+    if (numWorkers == workers.size())
+        return;
+
+    stop();
+    stopping = false;
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        auto* worker = workers.add (new Worker (*this));
+
+        // Same priority class of the audio thread, they share its deadline.
+        worker->startRealtimeThread (juce::Thread::RealtimeOptions {}.withPriority (9));
+    }
+}
+
+void WorkerPool::stop()
+{
+    if (workers.size() == 0)
+        return;
+
+    for (auto* worker: workers)
+        worker->signalThreadShouldExit();
+
+    // Sleeping workers are woken by a new generation.
+    stopping = true;
+    generation.fetch_add (1, std::memory_order_release);
+    generation.notify_all();
+
+    for (auto* worker: workers)
+        worker->stopThread (1000);
+
+    workers.clear();
+}
+
+//==============================================================================
+// Getters.
+
+int WorkerPool::getNumWorkers() const noexcept
+{
+    return workers.size();
+}
+
+//==============================================================================
+// Processing.
+
+void WorkerPool::run (Job job, void* context, const int numJobs) noexcept
+{
+    if (workers.size() == 0 || numJobs <= 1)
+    {
+        for (int i = 0; i < numJobs; ++i)
+            job (context, i);
+
+        return;
+    }
+
+    // Workers late from the previous run are locked out first, the new jobs are
+    // visible to the others once they see the new generation.
+    const auto newGeneration = generation.load (std::memory_order_relaxed) + 1;
+    nextJob.store (static_cast<juce::uint64> (newGeneration) << 32, std::memory_order_relaxed);
+
+    currentJob = job;
+    currentContext = context;
+    currentNumJobs.store (numJobs, std::memory_order_relaxed);
+    remainingJobs.store (numJobs, std::memory_order_relaxed);
+
+    generation.store (newGeneration, std::memory_order_release);
+    generation.notify_all();
+
+    while (runNextJob (newGeneration)) {}
+
+    // Join, the remaining jobs are short and already running.
+    while (remainingJobs.load (std::memory_order_acquire) > 0) {}
+}
+
+bool WorkerPool::runNextJob (const juce::uint32 expectedGeneration) noexcept
+{
+    auto claimed = nextJob.load (std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto claimedGeneration = static_cast<juce::uint32> (claimed >> 32);
+        const auto index = static_cast<int> (claimed & 0xffffffff);
+
+        if (claimedGeneration != expectedGeneration || index >= currentNumJobs.load (std::memory_order_relaxed))
+            return false;
+
+        if (nextJob.compare_exchange_weak (claimed, claimed + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            currentJob (currentContext, index);
+            remainingJobs.fetch_sub (1, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+//==============================================================================
+// class WorkerPool::Worker
+
+WorkerPool::Worker::Worker (WorkerPool& owner)
+    : juce::Thread ("cdrt worker"), pool (owner)
+{
+}
+
+void WorkerPool::Worker::run()
+{
+    auto seen = pool.generation.load (std::memory_order_acquire);
+
+    while (! threadShouldExit())
+    {
+        auto current = pool.generation.load (std::memory_order_acquire);
+
+        for (int i = 0; i < spinIterations && current == seen; ++i)
+            current = pool.generation.load (std::memory_order_acquire);
+
+        if (current == seen)
+        {
+            pool.generation.wait (seen, std::memory_order_acquire);
+            current = pool.generation.load (std::memory_order_acquire);
+        }
+
+        seen = current;
+
+        if (pool.stopping.load())
+            return;
+
+        while (pool.runNextJob (seen)) {}
+    }
+}
+
+} // namespace utility
+} // namespace cdrt
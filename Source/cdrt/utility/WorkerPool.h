@@ -0,0 +1,114 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <atomic>
+
+namespace cdrt
+{
+namespace utility
+{
+
+// Small pool of real-time threads running the jobs of one processing step in parallel.
+// The caller (the audio thread) publishes the jobs, takes part in running them and
+// returns when all of them are done, nothing is allocated or locked while running.
+// Idle workers spin for a short time, then sleep on the generation counter with
+// std::atomic::wait (a futex on Linux) until the next run.
+class WorkerPool
+{
+public:
+    // Job function, called once for each index in [0, numJobs).
+    using Job = void (*) (void* context, int index);
+
+    //==========================================================================
+    // Default constructor.
+
+    /**
+     * @brief Construct a new WorkerPool object, no thread is started.
+     */
+    WorkerPool() {}
+
+    //==========================================================================
+    // Destructor.
+
+    /**
+     * WorkerPool destructor, stops the workers.
+     */
+    ~WorkerPool();
+
+    //==========================================================================
+    // Allocation/Deallocation.
+
+    /**
+     * @brief This method starts the given number of workers, stopping the running ones if the number differs.
+     * It must not be called while run is running.
+     *
+     * @param numWorkers: number of threads besides the caller of run, 0 runs every job on the caller.
+     */
+    void start (const int numWorkers);
+
+    /**
+     * @brief This method stops every worker.
+     */
+    void stop();
+
+    //==========================================================================
+    // Getters.
+
+    /**
+     * @brief This method gets the number of running workers.
+     * @return int
+     */
+    int getNumWorkers() const noexcept;
+
+    //==========================================================================
+    // Processing.
+
+    /**
+     * @brief This method runs the jobs on the workers and on the calling thread, and returns when all of them are done.
+     * Call it from one thread at a time.
+     *
+     * @param job: function to run.
+     * @param context: first argument of every call.
+     * @param numJobs: number of jobs.
+     */
+    void run (Job job, void* context, const int numJobs) noexcept;
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        explicit Worker (WorkerPool& owner);
+        void run() override;
+
+    private:
+        WorkerPool& pool;
+    };
+
+    /**
+     * @brief This method runs the next job of the given generation, if any is left.
+     *
+     * @param expectedGeneration: generation the caller woke up for.
+     * @return bool: false when no job is left.
+     */
+    bool runNextJob (const juce::uint32 expectedGeneration) noexcept;
+
+    // Iterations of the spin loop before sleeping, a few microseconds.
+    static constexpr int spinIterations = 4000;
+
+    juce::OwnedArray<Worker> workers;
+    std::atomic<juce::uint32> generation { 0 };
+    std::atomic<bool> stopping { false };
+
+    // Generation in the high half, index of the next job in the low one:
+    // a worker late from the previous run can't take a job of the next one.
+    std::atomic<juce::uint64> nextJob { 0 };
+    std::atomic<int> remainingJobs { 0 };
+
+    // Written before the generation is published.
+    Job currentJob = nullptr;
+    void* currentContext = nullptr;
+    std::atomic<int> currentNumJobs { 0 };
+}; // class WorkerPool
+
+} // namespace utility
+} // namespace cdrt
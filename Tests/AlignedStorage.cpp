@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+// Module to test.
+#include <cdrt/utility/AlignedStorage.h>
+
+namespace
+{
+using AlignedStorage = cdrt::utility::AlignedStorage;
+
+bool isAligned (const void* data, const size_t alignment)
+{
+    return reinterpret_cast<std::uintptr_t> (data) % alignment == 0;
+}
+
+bool isZero (const void* data, const size_t numBytes)
+{
+    const auto* bytes = static_cast<const unsigned char*> (data);
+    return std::all_of (bytes, bytes + numBytes, [] (unsigned char byte) { return byte == 0; });
+}
+} // namespace
+
+TEST_CASE("AlignedStorage: small buffers are zeroed and aligned to the cache lines")
+{
+    AlignedStorage storage;
+    REQUIRE (storage.getData() == nullptr);
+
+    REQUIRE (storage.allocate (1000));
+    REQUIRE (storage.getData() != nullptr);
+    REQUIRE (storage.getCapacity() >= 1000);
+    REQUIRE (isAligned (storage.getData(), AlignedStorage::cacheLineBytes));
+    REQUIRE (isZero (storage.getData(), 1000));
+    REQUIRE_FALSE (storage.isHugePageAdvised());
+
+    // Smaller sizes reuse the memory, zeroed again.
+    auto* data = storage.getData();
+    static_cast<unsigned char*> (data)[10] = 1;
+
+    REQUIRE (storage.allocate (500));
+    REQUIRE (storage.getData() == data);
+    REQUIRE (isZero (storage.getData(), 500));
+
+    storage.release();
+    REQUIRE (storage.getData() == nullptr);
+    REQUIRE (storage.getCapacity() == 0);
+}
+
+TEST_CASE("AlignedStorage: long buffers fill whole huge pages")
+{
+    constexpr size_t numBytes = 3 * AlignedStorage::hugePageBytes + 100;
+
+    AlignedStorage storage;
+    REQUIRE (storage.allocate (numBytes));
+    REQUIRE (isAligned (storage.getData(), AlignedStorage::hugePageBytes));
+    REQUIRE (storage.getCapacity() % AlignedStorage::hugePageBytes == 0);
+    REQUIRE (isZero (storage.getData(), numBytes));
+
+    // Without huge pages the next allocation is only aligned to the cache lines.
+    AlignedStorage::setHugePagesEnabled (false);
+    AlignedStorage other;
+    REQUIRE (other.allocate (numBytes));
+    REQUIRE (isAligned (other.getData(), AlignedStorage::cacheLineBytes));
+    REQUIRE_FALSE (other.isHugePageAdvised());
+    AlignedStorage::setHugePagesEnabled (true);
+
+    // Prefetching is only a hint, any range is accepted.
+    AlignedStorage::prefetch (static_cast<char*> (storage.getData()) + 3, numBytes - 3);
+    AlignedStorage::prefetch (storage.getData(), 0);
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+// Module to test.
+#include <cdrt/dsp/DelayEngine.h>
+
+TEST_CASE("DelayEngineManager: interpolation change swaps the engine without altering the output")
+{
+    using Manager = cdrt::dsp::DelayEngineManager<float>;
+    using Interpolation = Manager::Interpolation;
+
+    const juce::dsp::ProcessSpec spec { 1000.0, 8, 2 };
+    Manager manager;
+    manager.prepare (spec, 64, false, Interpolation::linear);
+
+    auto reference = cdrt::dsp::DelayEngine<float>::create (Interpolation::linear, spec, 64, false);
+
+    // Integer delay, every interpolation gives the same output.
+    const auto processBlock = [] (cdrt::dsp::DelayEngine<float>& engine, const int firstSample, std::vector<float>& output)
+    {
+        output.clear();
+
+        for (int i = 0; i < 8; ++i)
+        {
+            float samples[2] = { static_cast<float> ((firstSample + i) % 50), 0.0f };
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                engine.router->setDelayTime (channel, 10.0f);
+                engine.router->setFeedback (channel, 0.5f);
+            }
+
+            engine.router->processSamples (samples);
+            output.push_back (samples[0]);
+            output.push_back (samples[1]);
+        }
+    };
+
+    std::vector<float> expected, actual;
+    int swappedAt = -1;
+
+    for (int block = 0; block < 2000 && (swappedAt < 0 || block < swappedAt + 20); ++block)
+    {
+        // Some history is written before the change.
+        if (block == 10)
+            manager.requestInterpolation (Interpolation::none);
+
+        auto& engine = manager.beginBlock (8);
+
+        if (swappedAt < 0 && engine.interpolation == Interpolation::none)
+            swappedAt = block;
+
+        processBlock (engine, block * 8, actual);
+        processBlock (*reference, block * 8, expected);
+
+        for (size_t i = 0; i < expected.size(); ++i)
+            REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs (expected[i], 1.0e-5));
+
+        juce::Thread::sleep (1);
+    }
+
+    REQUIRE(swappedAt >= 10);
+}
+
+TEST_CASE("DelayEngineManager: a long history is copied in slices while the audio keeps running")
+{
+    using Manager = cdrt::dsp::DelayEngineManager<float>;
+    using Interpolation = Manager::Interpolation;
+
+    // Several slices are needed, the delay reads the oldest part of the history.
+    constexpr int blockSize = 64;
+    constexpr int maxDelaySamples = 3 * Manager::primingSliceSamples + 100;
+    constexpr float delayTime = static_cast<float> (maxDelaySamples - 10);
+
+    const juce::dsp::ProcessSpec spec { 1000.0, blockSize, 2 };
+    Manager manager;
+    manager.prepare (spec, maxDelaySamples, false, Interpolation::linear);
+
+    auto reference = cdrt::dsp::DelayEngine<float>::create (Interpolation::linear, spec, maxDelaySamples, false);
+
+    const auto processBlock = [&delayTime] (cdrt::dsp::DelayEngine<float>& engine, const int firstSample, std::vector<float>& output)
+    {
+        output.clear();
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            float samples[2] = { static_cast<float> ((firstSample + i) % 997), 0.0f };
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                engine.router->setDelayTime (channel, delayTime);
+                engine.router->setFeedback (channel, 0.5f);
+            }
+
+            engine.router->processSamples (samples);
+            output.push_back (samples[0]);
+            output.push_back (samples[1]);
+        }
+    };
+
+    std::vector<float> expected, actual;
+    const auto historyBlocks = maxDelaySamples / blockSize + 1;
+    int swappedAt = -1;
+
+    for (int block = 0; block < 20000 && (swappedAt < 0 || block < swappedAt + historyBlocks); ++block)
+    {
+        // The whole history is written before the change.
+        if (block == historyBlocks)
+            manager.requestInterpolation (Interpolation::none);
+
+        if (block >= historyBlocks && swappedAt < 0)
+            juce::Thread::sleep (1);
+
+        auto& engine = manager.beginBlock (blockSize);
+
+        if (swappedAt < 0 && engine.interpolation == Interpolation::none)
+            swappedAt = block;
+
+        processBlock (engine, block * blockSize, actual);
+        processBlock (*reference, block * blockSize, expected);
+
+        for (size_t i = 0; i < expected.size(); ++i)
+            REQUIRE_THAT(actual[i], Catch::Matchers::WithinAbs (expected[i], 1.0e-3));
+    }
+
+    // A slice every block.
+    REQUIRE(swappedAt >= historyBlocks + maxDelaySamples / (blockSize + Manager::primingSliceSamples));
+}
+
+TEST_CASE("DelayEngineManager: re-prepare keeps or resamples the delay lines content")
+{
+    using Manager = cdrt::dsp::DelayEngineManager<float>;
+    using Interpolation = Manager::Interpolation;
+
+    Manager manager;
+    REQUIRE(manager.prepare ({ 1000.0, 8, 2 }, 64, false, Interpolation::linear) == Manager::Preparation::rebuilt);
+
+    // A constant signal fills the lines, it stays constant at any sample rate.
+    auto& engine = manager.beginBlock (64);
+
+    for (int i = 0; i < 64; ++i)
+    {
+        float samples[2] = { 1.0f, 1.0f };
+        engine.router->processSamples (samples);
+    }
+
+    std::vector<float> history (64);
+
+    SECTION("Only the block size changes")
+    {
+        REQUIRE(manager.prepare ({ 1000.0, 32, 2 }, 64, false, Interpolation::linear) == Manager::Preparation::reused);
+        REQUIRE(manager.getActiveEngine() == &engine);
+
+        manager.getActiveEngine()->delayLines[0]->copyHistory (0, history.data());
+        REQUIRE(history.front() == 1.0f);
+    }
+
+    SECTION("The sample rate changes")
+    {
+        REQUIRE(manager.prepare ({ 2000.0, 8, 2 }, 128, false, Interpolation::linear) == Manager::Preparation::resampled);
+
+        history.resize (128);
+        manager.getActiveEngine()->delayLines[1]->copyHistory (0, history.data());
+        REQUIRE(history.front() == 1.0f);
+        REQUIRE(history.back() == 1.0f);
+    }
+
+    SECTION("Resampling is disabled")
+    {
+        manager.setResampleOnSampleRateChange (false);
+        REQUIRE(manager.prepare ({ 500.0, 8, 2 }, 32, false, Interpolation::linear) == Manager::Preparation::rebuilt);
+
+        history.resize (32);
+        manager.getActiveEngine()->delayLines[0]->copyHistory (0, history.data());
+        REQUIRE(history.back() == 0.0f);
+    }
+}
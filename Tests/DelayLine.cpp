@@ -1,5 +1,6 @@
 #include <cdrt/dsp/DelayLine.h>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 #include <juce_dsp/juce_dsp.h>
 
@@ -39,11 +40,349 @@ TEST_CASE("Delay Line put/get sample w/ None interpolation.")
     REQUIRE(res == expected);
 }
 
+// Crossfading delay time change.
+TEST_CASE("Delay Line delay change w/ crossfade: old and new read heads are crossfaded.")
+{
+    std::unique_ptr<cdrt::dsp::DelayLineBase<float>> dl;
+    dl = std::make_unique<cdrt::dsp::DelayLineNone<float>>();
+
+    dl->prepare (ps);
+    dl->setMaxDelaySamples(64);
+    dl->reset();
+    dl->setFeedback (0.0f);
+    dl->setCrossfadeSamples (4);
+    dl->setDelaySamples (10.0f);
+
+    // The input is a ramp so the output tells where each read head is.
+    float input = 0.0f;
+    for (; input < 32.0f; input += 1.0f)
+        dl->processSample (0, input);
+
+    dl->setDelaySamples (5.0f);
+
+    for (int i = 0; i < 4; ++i, input += 1.0f)
+    {
+        const auto gain = static_cast<float> (i) / 4.0f;
+        REQUIRE(dl->processSample (0, input) == gain * (input - 5.0f) + (1.0f - gain) * (input - 10.0f));
+    }
+
+    // Crossfade completed, only the new read head is left.
+    REQUIRE(dl->processSample (0, input) == input - 5.0f);
+}
+
+TEST_CASE("Delay Line delay change w/ crossfade: channels crossfade independently")
+{
+    // Two channels prepared, only the first one is processed.
+    cdrt::dsp::DelayLineNone<float> dl;
+    dl.prepare ({ 44100, 5, 2 });
+    dl.setMaxDelaySamples (64);
+    dl.reset();
+    dl.setFeedback (0.0f);
+    dl.setCrossfadeSamples (4);
+    dl.setDelaySamples (10.0f);
+
+    float input = 0.0f;
+    for (; input < 32.0f; input += 1.0f)
+        dl.processSample (0, input);
+
+    // Every change reaches the new read head after its crossfade, the second one queued during the first.
+    dl.setDelaySamples (5.0f);
+    dl.processSample (0, input);
+    input += 1.0f;
+    dl.setDelaySamples (20.0f);
+
+    for (int i = 0; i < 7; ++i, input += 1.0f)
+        dl.processSample (0, input);
+
+    REQUIRE(dl.processSample (0, input) == input - 20.0f);
+    input += 1.0f;
+
+    dl.setDelaySamples (8.0f);
+
+    for (int i = 0; i < 4; ++i, input += 1.0f)
+        dl.processSample (0, input);
+
+    REQUIRE(dl.processSample (0, input) == input - 8.0f);
+}
+
 // Linear
 // Lagrange3rd interpolation.
-// Thiran interpolation.
 // Those tests are missing at the moment. They are not required as they
 // follow the same steps as the None interpolation the the interpolation functions already have been tested.
 // Make a test for them would be too difficult and the effort is not worth to me.
 // In future i will maybe add them if required.
 // ...
+
+TEST_CASE("Delay Line Thiran interpolation: the repeat of an impulse is centred on the fractional delay")
+{
+    for (const auto order: { 1, 2, 3, 4 })
+    {
+        cdrt::dsp::DelayLineThiran<float> dl (order);
+        dl.prepare (ps);
+        dl.setMaxDelaySamples (128);
+        dl.reset();
+        dl.setDelaySamples (20.3f);
+        dl.setFeedback (1.0f);
+
+        // The input is written at the index of its time, the first repeat comes back through the allpass.
+        for (int i = 0; i < 40; ++i)
+            dl.processSample (0, i == 0 ? 1.0f : 0.0f);
+
+        double sum = 0.0, moment = 0.0;
+
+        // The second repeat starts ringing before 40, it is left out.
+        for (int i = 1; i < 32; ++i)
+        {
+            sum += dl.getSample (0, i);
+            moment += i * static_cast<double> (dl.getSample (0, i));
+        }
+
+        // Unity gain and group delay at DC.
+        REQUIRE_THAT(sum, Catch::Matchers::WithinAbs (1.0, 1.0e-3));
+        REQUIRE_THAT(moment / sum, Catch::Matchers::WithinAbs (20.3, 1.0e-2));
+    }
+}
+
+TEST_CASE("DelayLine history: a copied history restored in another line gives the same output")
+{
+    juce::dsp::ProcessSpec spec { 1000.0, 16, 1 };
+
+    cdrt::dsp::DelayLineNone<float> source, restored;
+    for (auto* line: { &source, &restored })
+    {
+        line->prepare (spec);
+        line->setMaxDelaySamples (8);
+        line->setDelaySamples (3.0f);
+        line->setFeedback (0.0f);
+    }
+
+    // More samples than the buffer size, the write pointer is not at 0.
+    for (int i = 1; i <= 11; ++i)
+        source.processSample (0, static_cast<float> (i));
+
+    std::vector<float> history (8);
+    source.copyHistory (0, history.data());
+    REQUIRE(history.front() == 4.0f);
+    REQUIRE(history.back() == 11.0f);
+
+    restored.setHistory (0, history.data(), static_cast<int> (history.size()));
+
+    for (int i = 12; i < 20; ++i)
+        REQUIRE(restored.processSample (0, static_cast<float> (i)) == source.processSample (0, static_cast<float> (i)));
+}
+
+TEST_CASE("DelayLine block processing: a static integer delay gives the same samples as processSample")
+{
+    juce::dsp::ProcessSpec spec { 1000.0, 64, 1 };
+
+    const auto check = [&spec] (auto& block, auto& reference, const float delay)
+    {
+        for (auto* line: { static_cast<cdrt::dsp::DelayLineBase<float>*> (&block), static_cast<cdrt::dsp::DelayLineBase<float>*> (&reference) })
+        {
+            line->prepare (spec);
+            line->setMaxDelaySamples (50);
+            line->reset();
+            line->setDelaySamples (delay);
+            line->setFeedback (0.5f);
+        }
+
+        // Delays shorter than the block and blocks crossing the end of the buffer.
+        std::array<float, 64> input, output;
+        float value = 1.0f;
+
+        for (int i = 0; i < 10; ++i)
+        {
+            for (auto& sample: input)
+                sample = (value += 1.0f);
+
+            block.processBlock (0, input.data(), output.data(), static_cast<int> (input.size()));
+
+            for (size_t sample = 0; sample < input.size(); ++sample)
+                REQUIRE(output[sample] == reference.processSample (0, input[sample]));
+        }
+
+        // Moving to a fractional delay the interpolation starts from an up to date state.
+        block.setDelaySamples (delay + 0.25f);
+        reference.setDelaySamples (delay + 0.25f);
+
+        for (auto& sample: input)
+            sample = (value += 1.0f);
+
+        block.processBlock (0, input.data(), output.data(), static_cast<int> (input.size()));
+
+        for (size_t sample = 0; sample < input.size(); ++sample)
+            REQUIRE_THAT(output[sample], Catch::Matchers::WithinRel (reference.processSample (0, input[sample]), 1.0e-5f));
+    };
+
+    for (const auto delay: { 7.0f, 20.0f, 7.5f })
+    {
+        cdrt::dsp::DelayLineNone<float> none1, none2;
+        check (none1, none2, delay);
+
+        cdrt::dsp::DelayLineLinear<float> linear1, linear2;
+        check (linear1, linear2, delay);
+
+        cdrt::dsp::DelayLineLagrange3rd<float> lagrange1, lagrange2;
+        check (lagrange1, lagrange2, delay);
+
+        cdrt::dsp::DelayLineThiran<float> thiran1 (2), thiran2 (2);
+        check (thiran1, thiran2, delay);
+    }
+}
+
+TEST_CASE("Delay Line Lagrange3rd interpolation: the delay holds over many samples set once")
+{
+    cdrt::dsp::DelayLineLagrange3rd<float> dl;
+    dl.prepare (ps);
+    dl.setMaxDelaySamples (512);
+    dl.reset();
+    dl.setDelaySamples (100.3f);
+    dl.setFeedback (1.0f);
+
+    // The delay is set once, two repeats are written before the buffer wraps.
+    for (int i = 0; i < 260; ++i)
+        dl.processSample (0, i == 0 ? 1.0f : 0.0f);
+
+    for (const auto repeat: { 1, 2 })
+    {
+        double sum = 0.0, moment = 0.0;
+
+        for (int i = 100 * repeat - 50; i < 100 * repeat + 50; ++i)
+        {
+            sum += dl.getSample (0, i);
+            moment += i * static_cast<double> (dl.getSample (0, i));
+        }
+
+        // Unity gain and group delay at DC.
+        REQUIRE_THAT(sum, Catch::Matchers::WithinAbs (1.0, 1.0e-3));
+        REQUIRE_THAT(moment / sum, Catch::Matchers::WithinAbs (100.3 * repeat, 1.0e-2));
+    }
+}
+
+TEST_CASE("Delay Line Lagrange3rd interpolation: tabulated coefficients follow the computed ones")
+{
+    cdrt::dsp::DelayLineLagrange3rd<float> computed;
+    cdrt::dsp::DelayLineLagrange3rd<float, 256> tabulated;
+
+    for (auto* dl: std::initializer_list<cdrt::dsp::DelayLineBase<float>*> { &computed, &tabulated })
+    {
+        dl->prepare (ps);
+        dl->setMaxDelaySamples (512);
+        dl->reset();
+        dl->setDelaySamples (100.3f);
+        dl->setFeedback (0.5f);
+    }
+
+    // The fractional delay is rounded to 1 / 256 samples, a slow sine barely moves.
+    for (int i = 0; i < 1000; ++i)
+    {
+        const auto input = std::sin (0.05f * static_cast<float> (i));
+        REQUIRE_THAT(tabulated.processSample (0, input), Catch::Matchers::WithinAbs (computed.processSample (0, input), 1.0e-4));
+    }
+}
+
+TEST_CASE("DelayLine block processing: the longest delay gives the same samples as processSample")
+{
+    juce::dsp::ProcessSpec spec { 1000.0, 16, 1 };
+
+    cdrt::dsp::DelayLineNone<float> block, reference;
+    for (auto* line: { &block, &reference })
+    {
+        line->prepare (spec);
+        line->setMaxDelaySamples (32);
+        line->reset();
+        line->setDelaySamples (32.0f);
+        line->setFeedback (0.5f);
+    }
+
+    // The last slot is left to the write head.
+    REQUIRE(block.getDelaySamples() == 31.0f);
+
+    std::array<float, 16> input, output;
+    float value = 1.0f;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        for (auto& sample: input)
+            sample = (value += 1.0f);
+
+        block.processBlock (0, input.data(), output.data(), static_cast<int> (input.size()));
+
+        for (size_t sample = 0; sample < input.size(); ++sample)
+            REQUIRE(output[sample] == reference.processSample (0, input[sample]));
+    }
+}
+
+TEST_CASE("DelayLine feedback filter: turning it on and off doesn't move the repeats")
+{
+    constexpr int delay = 100;
+
+    for (const auto crossfadeSamples: { 0, 16 })
+    {
+        const auto makeLine = [crossfadeSamples]
+        {
+            auto dl = std::make_unique<cdrt::dsp::DelayLineLinear<float>>();
+            dl->prepare ({ 48000.0, 64, 1 });
+            dl->setMaxDelaySamples (1024);
+            dl->reset();
+            dl->setCrossfadeSamples (crossfadeSamples);
+            dl->setDelaySamples (static_cast<float> (delay));
+            dl->setFeedback (0.5f);
+            return dl;
+        };
+
+        auto reference = makeLine();
+        auto dl = makeLine();
+
+        for (int i = 0; i < 8 * delay; ++i)
+        {
+            // A tilt small enough to leave the repeats as they are, the filter goes on and off nonetheless.
+            if (i % delay == 50)
+            {
+                dl->setFeedbackFilter (20.0f, 20000.0f, (i / delay) % 2 == 0 ? 0.01f : 0.0f);
+                dl->updateFeedbackFilter (48000);
+                REQUIRE(dl->getFeedbackLatency() == 0.0f);
+            }
+
+            const auto input = i % 37 == 0 ? 1.0f : 0.0f;
+            REQUIRE_THAT(dl->processSample (0, input), Catch::Matchers::WithinAbs (reference->processSample (0, input), 1.0e-3));
+        }
+    }
+}
+
+TEST_CASE("DelayLine saturation: its half sample of delay doesn't move the repeats")
+{
+    constexpr int delay = 100;
+
+    cdrt::dsp::DelayLineLagrange3rd<float> dl;
+    dl.prepare ({ 48000.0, 64, 1 });
+    dl.setMaxDelaySamples (1024);
+    dl.reset();
+    dl.setDelaySamples (static_cast<float> (delay));
+    dl.setFeedback (0.9f);
+
+    // Below the knee the shape is the identity, only the averaging of the antialiasing is left.
+    // The feedback is read half a sample away from the samples, lagrange keeps the centre of the repeats in place.
+    dl.setFeedbackSaturation (cdrt::dsp::Saturation<float>::Shape::tanh, 0.01f);
+    REQUIRE(dl.getFeedbackLatency() == 0.5f);
+
+    std::vector<float> output (8 * delay + 10);
+
+    for (size_t i = 0; i < output.size(); ++i)
+        output[i] = dl.processSample (0, i == 0 ? 0.5f : 0.0f);
+
+    // The repeats spread over a few samples, their centre stays a delay after the previous one.
+    for (int repeat = 1; repeat <= 8; ++repeat)
+    {
+        double sum = 0.0;
+        double moment = 0.0;
+
+        for (int i = repeat * delay - 10; i < repeat * delay + 10; ++i)
+        {
+            sum += output[static_cast<size_t> (i)];
+            moment += i * static_cast<double> (output[static_cast<size_t> (i)]);
+        }
+
+        REQUIRE(std::abs (moment / sum - repeat * delay) < 0.01);
+    }
+}
@@ -0,0 +1,223 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <tuple>
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/DelayLineRouting.h>
+
+namespace
+{
+std::shared_ptr<cdrt::dsp::DelayLineBase<float>> makeLine()
+{
+    auto line = std::make_shared<cdrt::dsp::DelayLineLinear<float>>();
+    line->prepare ({ 1000.0, 16, 1 });
+    line->setMaxDelaySamples (64);
+    return line;
+}
+} // namespace
+
+TEST_CASE("DelayLineRouting mono to stereo: equal taps match two straight delay lines")
+{
+    cdrt::dsp::DelayLineRoutingStraight<float> straight;
+    cdrt::dsp::DelayLineRoutingMonoToStereo<float> mono;
+
+    auto left = makeLine(), right = makeLine(), shared = makeLine();
+    straight.prepare ({ left, right });
+    mono.prepare ({ shared });
+
+    for (auto* router: std::initializer_list<cdrt::dsp::DelayLineRoutingBase<float>*> { &straight, &mono })
+    {
+        for (int output = 0; output < 2; ++output)
+        {
+            router->setDelayTime (output, 5.0f);
+            router->setFeedback (output, 0.5f);
+        }
+    }
+
+    for (int i = 0; i < 40; ++i)
+    {
+        float straightSamples[2] = { i == 0 ? 1.0f : 0.0f, 0.0f };
+        float monoSamples[2] = { straightSamples[0], 0.0f };
+
+        straight.processSamples (straightSamples);
+        mono.processSamples (monoSamples);
+
+        REQUIRE_THAT(monoSamples[0], Catch::Matchers::WithinAbs (straightSamples[0], 1.0e-6));
+        REQUIRE_THAT(monoSamples[1], Catch::Matchers::WithinAbs (straightSamples[1], 1.0e-6));
+    }
+}
+
+TEST_CASE("DelayLineRouting mono to stereo: every tap feeds the buffer with half its gain")
+{
+    for (const auto& [leftFeedback, rightFeedback]: { std::tuple { 0.5f, 0.25f }, std::tuple { 1.0f, 1.0f } })
+    {
+        cdrt::dsp::DelayLineRoutingMonoToStereo<float> mono;
+        auto shared = makeLine();
+        mono.prepare ({ shared });
+
+        mono.setDelayTime (0, 3.0f);
+        mono.setDelayTime (1, 7.0f);
+        mono.setFeedback (0, leftFeedback);
+        mono.setFeedback (1, rightFeedback);
+
+        // The buffer: w[n] = x[n] + (gl * w[n - 3] + gr * w[n - 7]) / 2.
+        std::vector<float> written (40, 0.0f);
+
+        for (size_t i = 0; i < written.size(); ++i)
+        {
+            written[i] = (i == 0 ? 1.0f : 0.0f) + (i >= 3 ? 0.5f * leftFeedback * written[i - 3] : 0.0f)
+                                                + (i >= 7 ? 0.5f * rightFeedback * written[i - 7] : 0.0f);
+
+            float samples[2] = { i == 0 ? 1.0f : 0.0f, 0.0f };
+            mono.processSamples (samples);
+
+            REQUIRE_THAT(samples[0], Catch::Matchers::WithinAbs (i >= 3 ? written[i - 3] : 0.0f, 1.0e-6));
+            REQUIRE_THAT(samples[1], Catch::Matchers::WithinAbs (i >= 7 ? written[i - 7] : 0.0f, 1.0e-6));
+        }
+    }
+}
+
+TEST_CASE("DelayLineRouting mono to stereo: the tap feedback goes through the feedback stages of the line")
+{
+    // Only the right tap feeds back: its repeats match a straight line with half its feedback and the same saturation.
+    cdrt::dsp::DelayLineRoutingStraight<float> straight;
+    cdrt::dsp::DelayLineRoutingMonoToStereo<float> mono;
+
+    auto left = makeLine(), right = makeLine(), shared = makeLine();
+    straight.prepare ({ left, right });
+    mono.prepare ({ shared });
+
+    for (auto& line: { left, right, shared })
+        line->setFeedbackSaturation (cdrt::dsp::Saturation<float>::Shape::tanh, 4.0f);
+
+    for (auto* router: std::initializer_list<cdrt::dsp::DelayLineRoutingBase<float>*> { &straight, &mono })
+    {
+        for (int output = 0; output < 2; ++output)
+            router->setDelayTime (output, 5.0f);
+
+        router->setFeedback (0, 0.0f);
+        router->setFeedback (1, router == &mono ? 0.9f : 0.45f);
+    }
+
+    for (int i = 0; i < 40; ++i)
+    {
+        float straightSamples[2] = { i == 0 ? 1.0f : 0.0f, 0.0f };
+        float monoSamples[2] = { straightSamples[0], 0.0f };
+
+        straight.processSamples (straightSamples);
+        mono.processSamples (monoSamples);
+
+        REQUIRE_THAT(monoSamples[1], Catch::Matchers::WithinAbs (straightSamples[1], 1.0e-6));
+    }
+}
+
+TEST_CASE("DelayLineRouting mono to stereo: the right tap has its own delay")
+{
+    cdrt::dsp::DelayLineRoutingMonoToStereo<float> mono;
+    auto shared = makeLine();
+    mono.prepare ({ shared });
+
+    mono.setDelayTime (0, 3.0f);
+    mono.setDelayTime (1, 7.0f);
+    mono.setFeedback (0, 0.0f);
+    mono.setFeedback (1, 0.0f);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        float samples[2] = { i == 0 ? 1.0f : 0.0f, 0.0f };
+        mono.processSamples (samples);
+
+        REQUIRE(samples[0] == (i == 3 ? 1.0f : 0.0f));
+        REQUIRE(samples[1] == (i == 7 ? 1.0f : 0.0f));
+    }
+}
+
+TEST_CASE("DelayLineRouting mono to stereo: a block gives the same samples as processSamples")
+{
+    constexpr int blockSize = 16;
+
+    // Integer delays go through the copies, a fractional tap or the saturation through the samples.
+    const std::vector<std::tuple<float, float, float>> settings { { 3.0f, 7.0f, 0.0f }, { 7.0f, 3.0f, 0.0f }, { 5.0f, 6.5f, 0.0f }, { 4.0f, 9.0f, 0.5f } };
+
+    for (const auto& [leftTime, rightTime, drive]: settings)
+    {
+        cdrt::dsp::DelayLineRoutingMonoToStereo<float> block;
+        cdrt::dsp::DelayLineRoutingMonoToStereo<float> reference;
+
+        auto blockLine = makeLine(), referenceLine = makeLine();
+        block.prepare ({ blockLine });
+        reference.prepare ({ referenceLine });
+
+        for (auto* router: { &block, &reference })
+        {
+            router->setDelayTime (0, leftTime);
+            router->setDelayTime (1, rightTime);
+            router->setFeedback (0, 0.6f);
+            router->setFeedback (1, 0.8f);
+        }
+
+        for (auto& line: { blockLine, referenceLine })
+            line->setFeedbackSaturation (cdrt::dsp::Saturation<float>::Shape::tanh, drive);
+
+        std::vector<float> input (blockSize), left (blockSize), right (blockSize);
+        float value = 0.0f;
+
+        for (int i = 0; i < 10; ++i)
+        {
+            for (auto& sample: input)
+                sample = (value += 0.25f) > 1.0f ? (value = -1.0f) : value;
+
+            block.processBlock (input.data(), left.data(), right.data(), blockSize);
+
+            for (size_t sample = 0; sample < input.size(); ++sample)
+            {
+                float samples[2] = { input[sample], 0.0f };
+                reference.processSamples (samples);
+
+                REQUIRE_THAT(left[sample], Catch::Matchers::WithinAbs (samples[0], 1.0e-6));
+                REQUIRE_THAT(right[sample], Catch::Matchers::WithinAbs (samples[1], 1.0e-6));
+            }
+        }
+    }
+}
+
+TEST_CASE("DelayLineRouting mono to stereo: the right tap reads with the interpolation of the line")
+{
+    // Only the right tap feeds back at a fractional delay: the buffer matches a line with that delay and half the feedback.
+    const auto check = [] (auto makeTypedLine)
+    {
+        cdrt::dsp::DelayLineRoutingMonoToStereo<float> mono;
+        std::shared_ptr<cdrt::dsp::DelayLineBase<float>> shared = makeTypedLine(), straight = makeTypedLine();
+
+        for (auto& line: { shared, straight })
+        {
+            line->prepare ({ 1000.0, 16, 1 });
+            line->setMaxDelaySamples (64);
+        }
+
+        mono.prepare ({ shared });
+        mono.setDelayTime (0, 5.0f);
+        mono.setFeedback (0, 0.0f);
+        mono.setDelayTime (1, 5.5f);
+        mono.setFeedback (1, 0.9f);
+
+        straight->setDelaySamples (5.5f);
+        straight->setFeedback (0.45f);
+
+        for (int i = 0; i < 60; ++i)
+        {
+            float samples[2] = { i == 0 ? 1.0f : 0.0f, 0.0f };
+            const auto expected = straight->processSample (0, samples[0]);
+            mono.processSamples (samples);
+
+            // The left output reads the buffer 5 samples back, as the straight line does.
+            REQUIRE_THAT(samples[0], Catch::Matchers::WithinAbs (expected, 1.0e-6));
+        }
+    };
+
+    check ([] { return std::make_shared<cdrt::dsp::DelayLineNone<float>>(); });
+    check ([] { return std::make_shared<cdrt::dsp::DelayLineLinear<float>>(); });
+    check ([] { return std::make_shared<cdrt::dsp::DelayLineLagrange3rd<float>>(); });
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+
+// Module to test.
+#include <cdrt/dsp/FeedbackFilter.h>
+
+namespace
+{
+// Gain of a constant signal after the filter settled.
+float dcGain (cdrt::dsp::FeedbackFilter<float>& filter)
+{
+    float output = 0.0f;
+
+    for (int i = 0; i < 48000; ++i)
+        output = filter.processSample (0, 1.0f);
+
+    return output;
+}
+} // namespace
+
+TEST_CASE("FeedbackFilter: bypassed while flat, active once a filter is set")
+{
+    cdrt::dsp::FeedbackFilter<float> filter;
+    filter.prepare (48000.0, 2);
+    filter.update (512);
+
+    REQUIRE_FALSE(filter.isActive());
+
+    filter.setParameters (200.0f, 20000.0f, 0.0f);
+    filter.update (512);
+    REQUIRE(filter.isActive());
+
+    filter.setParameters (20.0f, 20000.0f, 0.0f);
+    filter.update (48000);
+    REQUIRE_FALSE(filter.isActive());
+}
+
+TEST_CASE("FeedbackFilter: the cascade adds no delay and shapes the low frequencies")
+{
+    cdrt::dsp::FeedbackFilter<float> filter;
+    filter.prepare (48000.0, 1);
+
+    SECTION("High cut only, an impulse comes out at once and DC is untouched")
+    {
+        filter.setParameters (20.0f, 5000.0f, 0.0f);
+        filter.update (48000);
+
+        REQUIRE(filter.processSample (0, 1.0f) > 0.0f);
+
+        filter.reset();
+        REQUIRE_THAT(dcGain (filter), Catch::Matchers::WithinAbs (1.0, 1.0e-3));
+    }
+
+    SECTION("Low cut removes DC")
+    {
+        filter.setParameters (200.0f, 20000.0f, 0.0f);
+        filter.update (48000);
+
+        REQUIRE_THAT(dcGain (filter), Catch::Matchers::WithinAbs (0.0, 1.0e-3));
+    }
+
+    SECTION("Tilt lowers the low frequencies by half of its gain")
+    {
+        filter.setParameters (20.0f, 20000.0f, 6.0f);
+        filter.update (48000);
+
+        REQUIRE_THAT(dcGain (filter), Catch::Matchers::WithinAbs (std::pow (10.0, -3.0 / 20.0), 1.0e-3));
+    }
+}
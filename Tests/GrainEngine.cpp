@@ -0,0 +1,171 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/DelayLine.h>
+#include <cdrt/dsp/GrainEngine.h>
+
+namespace
+{
+constexpr int blockSize = 64;
+constexpr int grainSamples = 200;
+constexpr float delaySamples = 1050.0f; // Between two grain starts, no repeat falls on a window edge.
+
+// Runs the input through a delay line and reads it back with the grains, block by block.
+void processGrains (cdrt::dsp::GrainEngine<float>& grainEngine, const std::vector<float>& input, std::vector<float>& output, const int preparedBlockSize = blockSize)
+{
+    cdrt::dsp::DelayLineLinear<float> delayLine;
+    delayLine.setMaxDelaySamples (4800);
+    delayLine.prepare ({ 48000.0, blockSize, 1 });
+    delayLine.setDelaySamples (delaySamples);
+    delayLine.setFeedback (0.0f);
+
+    grainEngine.prepare ({ 48000.0, static_cast<juce::uint32> (preparedBlockSize), 1 }, 480);
+    grainEngine.setGrainSamples (grainSamples);
+
+    output.resize (input.size());
+
+    for (size_t start = 0; start + blockSize <= input.size(); start += blockSize)
+    {
+        for (size_t i = start; i < start + blockSize; ++i)
+            delayLine.processSample (0, input[i]);
+
+        grainEngine.process (delayLine, 0, output.data() + start, blockSize);
+        REQUIRE(grainEngine.getNumActiveGrains() <= cdrt::dsp::GrainEngine<float>::maxGrains);
+    }
+}
+
+std::vector<float> impulse (const size_t length)
+{
+    std::vector<float> input (length, 0.0f);
+    input[0] = 1.0f;
+    return input;
+}
+} // namespace
+
+TEST_CASE("GrainEngine: grains without pitch shift are the plain delay")
+{
+    cdrt::dsp::GrainEngine<float> grainEngine;
+    grainEngine.setMode (cdrt::dsp::GrainEngine<float>::Mode::pitch);
+    grainEngine.setPitch (0.0f);
+
+    std::vector<float> output;
+    processGrains (grainEngine, impulse (2048), output);
+
+    // The overlapping windows sum to 1.
+    for (size_t i = 0; i < output.size(); ++i)
+        REQUIRE_THAT(output[i], Catch::Matchers::WithinAbs (i == static_cast<size_t> (delaySamples) ? 1.0 : 0.0, 1.0e-5));
+}
+
+TEST_CASE("GrainEngine: reverse grains play the impulse once in every overlapping grain")
+{
+    cdrt::dsp::GrainEngine<float> grainEngine;
+    grainEngine.setMode (cdrt::dsp::GrainEngine<float>::Mode::reverse);
+
+    std::vector<float> output;
+    processGrains (grainEngine, impulse (4096), output);
+
+    std::vector<size_t> positions;
+    double sum = 0.0;
+
+    for (size_t i = 0; i < output.size(); ++i)
+    {
+        if (std::abs (output[i]) > 1.0e-6f)
+            positions.push_back (i);
+
+        sum += output[i];
+    }
+
+    // Two grains contain the impulse, each one reads it backward from its own start,
+    // so the repeats are a grain apart and their windows still sum to 1.
+    REQUIRE(positions.size() == 2);
+    REQUIRE(positions[1] - positions[0] == static_cast<size_t> (grainSamples));
+    REQUIRE_THAT(sum, Catch::Matchers::WithinAbs (1.0, 1.0e-5));
+}
+
+TEST_CASE("GrainEngine: an octave up doubles the frequency")
+{
+    cdrt::dsp::GrainEngine<float> grainEngine;
+    grainEngine.setMode (cdrt::dsp::GrainEngine<float>::Mode::pitch);
+    grainEngine.setPitch (12.0f);
+
+    constexpr double frequency = 480.0;
+    std::vector<float> input (16384);
+
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = static_cast<float> (std::sin (2.0 * std::numbers::pi * frequency * static_cast<double> (i) / 48000.0));
+
+    std::vector<float> output;
+    processGrains (grainEngine, input, output);
+
+    // Magnitude of a frequency over the settled part of the output.
+    const auto magnitude = [&output] (const double f)
+    {
+        double re = 0.0, im = 0.0;
+
+        for (size_t i = 4096; i < output.size(); ++i)
+        {
+            re += output[i] * std::cos (2.0 * std::numbers::pi * f * static_cast<double> (i) / 48000.0);
+            im += output[i] * std::sin (2.0 * std::numbers::pi * f * static_cast<double> (i) / 48000.0);
+        }
+
+        return std::sqrt (re * re + im * im);
+    };
+
+    REQUIRE(magnitude (2.0 * frequency) > 10.0 * magnitude (frequency));
+}
+
+TEST_CASE("GrainEngine: blocks longer than the prepared one give the same grains")
+{
+    cdrt::dsp::GrainEngine<float> prepared;
+    cdrt::dsp::GrainEngine<float> shorter;
+
+    std::vector<float> input (2048);
+
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = std::sin (0.05f * static_cast<float> (i));
+
+    std::vector<float> expected;
+    std::vector<float> output;
+    processGrains (prepared, input, expected);
+    processGrains (shorter, input, output, blockSize / 4);
+
+    for (size_t i = 0; i < output.size(); ++i)
+        REQUIRE(output[i] == expected[i]);
+}
+
+TEST_CASE("GrainEngine: a new grain size lets the playing grains end with their own window")
+{
+    cdrt::dsp::DelayLineLinear<float> delayLine;
+    delayLine.setMaxDelaySamples (4800);
+    delayLine.prepare ({ 48000.0, blockSize, 1 });
+    delayLine.setDelaySamples (100.0f);
+    delayLine.setFeedback (0.0f);
+
+    cdrt::dsp::GrainEngine<float> grainEngine;
+    grainEngine.prepare ({ 48000.0, blockSize, 1 }, 480);
+    grainEngine.setMode (cdrt::dsp::GrainEngine<float>::Mode::pitch);
+    grainEngine.setPitch (0.0f);
+    grainEngine.setGrainSamples (400);
+
+    // A constant input: the playing grains fade out whole under the new ones, the output never drops.
+    std::vector<float> output (4096);
+
+    for (size_t start = 0; start < output.size(); start += blockSize)
+    {
+        if (start == 2048)
+            grainEngine.setGrainSamples (100);
+
+        for (int i = 0; i < blockSize; ++i)
+            delayLine.processSample (0, 1.0f);
+
+        grainEngine.process (delayLine, 0, output.data() + start, blockSize);
+    }
+
+    for (size_t i = 1024; i < output.size(); ++i)
+        REQUIRE(output[i] > 0.99f);
+}
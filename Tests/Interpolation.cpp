@@ -1,4 +1,5 @@
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
 
 // Module to test.
 #include <cdrt/utility/Interpolation.h>
@@ -111,3 +112,21 @@ TEST_CASE("Thiran interpolation <float>: with delayFrac=1 expected result -> sam
 
 // Thiran interpolation w/ double sampletype.
 // At the moment not implemented, float is good enough as test.
+
+TEST_CASE("Thiran coefficients: the first order is the classic alpha, integer delays are pure delays")
+{
+    using namespace cdrt::utility::interpolation;
+
+    float coefficients[4];
+
+    thiranCoefficients (1, 0.7, coefficients);
+    REQUIRE_THAT(coefficients[0], Catch::Matchers::WithinAbs ((1.0 - 0.7) / (1.0 + 0.7), 1.0e-6));
+
+    for (int order = 1; order <= 4; ++order)
+    {
+        thiranCoefficients (order, static_cast<double> (order), coefficients);
+
+        for (int k = 0; k < order; ++k)
+            REQUIRE(coefficients[k] == 0.0f);
+    }
+}
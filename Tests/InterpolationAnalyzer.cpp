@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+
+// Module to test.
+#include <cdrt/analysis/InterpolationAnalyzer.h>
+
+namespace
+{
+using InterpolationAnalyzer = cdrt::analysis::InterpolationAnalyzer;
+using Interpolation = InterpolationAnalyzer::Interpolation;
+
+// Short sweeps, the timing is not checked.
+InterpolationAnalyzer::Settings getSettings()
+{
+    InterpolationAnalyzer::Settings settings;
+    settings.fractions = { 0.0f, 0.5f };
+    settings.modulationRatesHz = { 2.0 };
+    settings.timingSamples = 4096;
+    settings.timingRepeats = 1;
+    return settings;
+}
+} // namespace
+
+TEST_CASE("InterpolationAnalyzer: an integer delay without interpolation is exact")
+{
+    InterpolationAnalyzer analyzer (getSettings());
+    const auto result = analyzer.analyze (Interpolation::none);
+
+    REQUIRE (result.staticSweep.size() == 2);
+    REQUIRE (result.staticSweep[0].responseErrorDb < -100.0);
+    REQUIRE (result.staticSweep[0].thdnDb < -100.0);
+    REQUIRE (result.staticSweep[0].phaseDelayErrorSamples < 1.0e-6);
+
+    // Half a sample missed.
+    REQUIRE (result.staticSweep[1].phaseDelayErrorSamples > 0.49);
+    REQUIRE (result.staticSweep[1].phaseDelayErrorSamples < 0.51);
+}
+
+TEST_CASE("InterpolationAnalyzer: higher Thiran orders are closer to the exact delay")
+{
+    InterpolationAnalyzer analyzer (getSettings());
+    const auto first = analyzer.analyze (Interpolation::thiran);
+    const auto fourth = analyzer.analyze (Interpolation::thiran4th);
+
+    // Allpass: flat magnitude, the phase error shrinks with the order.
+    REQUIRE (first.staticSweep[1].magnitudeErrorDb < 0.01);
+    REQUIRE (fourth.staticSweep[1].magnitudeErrorDb < 0.01);
+    REQUIRE (fourth.staticSweep[1].responseErrorDb < first.staticSweep[1].responseErrorDb);
+    REQUIRE (fourth.qualityDb < first.qualityDb);
+}
+
+TEST_CASE("InterpolationAnalyzer: the Pareto front keeps what nothing else beats on cost and quality")
+{
+    std::vector<InterpolationAnalyzer::Result> results (4);
+    results[0].nsPerSample = 1.0;  results[0].qualityDb = -10.0; // Cheapest.
+    results[1].nsPerSample = 2.0;  results[1].qualityDb = -5.0;  // Dominated by the first.
+    results[2].nsPerSample = 3.0;  results[2].qualityDb = -40.0; // Best.
+    results[3].nsPerSample = 3.0;  results[3].qualityDb = -40.0; // Ties are both kept.
+    results.emplace_back();
+    results[4].nsPerSample = 0.5;  results[4].qualityDb = -50.0; // Invalid timing, left out.
+    results[4].timingValid = false;
+
+    InterpolationAnalyzer::markParetoFront (results);
+
+    REQUIRE (results[0].pareto);
+    REQUIRE_FALSE (results[1].pareto);
+    REQUIRE (results[2].pareto);
+    REQUIRE (results[3].pareto);
+    REQUIRE_FALSE (results[4].pareto);
+}
+
+TEST_CASE("InterpolationAnalyzer: every interpolation is timed on a bounded output")
+{
+    InterpolationAnalyzer analyzer (getSettings());
+
+    for (const auto interpolation: { Interpolation::none, Interpolation::linear, Interpolation::lagrange3rd, Interpolation::thiran4th })
+        REQUIRE (analyzer.analyze (interpolation).timingValid);
+}
@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+// Module to test.
+#include <cdrt/dsp/LfoBank.h>
+
+TEST_CASE("LfoBank: sine and triangle stay in range and follow the phase")
+{
+    using Bank = cdrt::dsp::LfoBank<float>;
+
+    Bank lfos;
+    lfos.prepare ({ 1000.0, 250, 1 }, 2);
+    lfos.setWaveform (0, Bank::Waveform::sine);
+    lfos.setWaveform (1, Bank::Waveform::triangle);
+    lfos.setFrequency (0, 10.0f);
+    lfos.setFrequency (1, 10.0f);
+    lfos.reset();
+    lfos.process (250);
+
+    const auto* sine = lfos.getModulation (0);
+    const auto* triangle = lfos.getModulation (1);
+
+    for (int i = 0; i < 250; ++i)
+    {
+        const auto expected = std::sin (juce::MathConstants<float>::twoPi * 10.0f * static_cast<float> (i) / 1000.0f);
+        REQUIRE_THAT(sine[i], Catch::Matchers::WithinAbs (expected, 0.002));
+        REQUIRE(triangle[i] >= -1.0f);
+        REQUIRE(triangle[i] <= 1.0f);
+    }
+
+    // One cycle lasts 100 samples, the triangle peaks at half of it.
+    REQUIRE_THAT(triangle[0], Catch::Matchers::WithinAbs (-1.0, 1.0e-5));
+    REQUIRE_THAT(triangle[50], Catch::Matchers::WithinAbs (1.0, 1.0e-4));
+    REQUIRE_THAT(triangle[125], Catch::Matchers::WithinAbs (0.0, 1.0e-4));
+}
+
+TEST_CASE("LfoBank: random smooth is continuous across blocks")
+{
+    using Bank = cdrt::dsp::LfoBank<float>;
+
+    Bank lfos;
+    lfos.prepare ({ 1000.0, 64, 1 }, 1);
+    lfos.setWaveform (0, Bank::Waveform::randomSmooth);
+    lfos.setFrequency (0, 7.0f);
+    lfos.reset();
+
+    float previous = 0.0f;
+    for (int block = 0; block < 20; ++block)
+    {
+        lfos.process (37);
+        const auto* values = lfos.getModulation (0);
+
+        for (int i = 0; i < 37; ++i)
+        {
+            REQUIRE(std::abs (values[i]) <= 1.0f);
+            // The steepest smoothstep slope is 1.5 * 2 * 7 / 1000 per sample.
+            REQUIRE(std::abs (values[i] - previous) < 0.025f);
+            previous = values[i];
+        }
+    }
+}
+
+TEST_CASE("LfoBank: phase offsets and frequencies hold across blocks of any size")
+{
+    using Bank = cdrt::dsp::LfoBank<float>;
+
+    Bank lfos;
+    lfos.prepare ({ 1000.0, 64, 1 }, 2);
+    lfos.setWaveform (0, Bank::Waveform::sine);
+    lfos.setWaveform (1, Bank::Waveform::sine);
+    lfos.setFrequency (0, 3.0f);
+    lfos.setFrequency (1, 11.0f);
+    lfos.setPhaseOffset (1, 0.25f);
+    lfos.reset();
+
+    // Uneven blocks, the waveforms continue where the previous block left them.
+    int time = 0;
+    for (const auto numSamples: { 64, 1, 13, 37, 64, 5 })
+    {
+        lfos.process (numSamples);
+
+        for (int i = 0; i < numSamples; ++i, ++time)
+        {
+            const auto seconds = static_cast<float> (time) / 1000.0f;
+            REQUIRE_THAT(lfos.getModulation (0)[i], Catch::Matchers::WithinAbs (std::sin (juce::MathConstants<float>::twoPi * 3.0f * seconds), 0.002));
+            REQUIRE_THAT(lfos.getModulation (1)[i], Catch::Matchers::WithinAbs (std::cos (juce::MathConstants<float>::twoPi * 11.0f * seconds), 0.002));
+        }
+    }
+}
+
+TEST_CASE("LfoBank: random smooth moves across its range")
+{
+    using Bank = cdrt::dsp::LfoBank<float>;
+
+    Bank lfos;
+    lfos.prepare ({ 1000.0, 500, 1 }, 1);
+    lfos.setWaveform (0, Bank::Waveform::randomSmooth);
+    lfos.setFrequency (0, 20.0f);
+    lfos.reset();
+
+    float minimum = 1.0f, maximum = -1.0f;
+
+    // 100 random targets.
+    for (int block = 0; block < 10; ++block)
+    {
+        lfos.process (500);
+        const auto* values = lfos.getModulation (0);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            minimum = std::min (minimum, values[i]);
+            maximum = std::max (maximum, values[i]);
+        }
+    }
+
+    REQUIRE(minimum < -0.5f);
+    REQUIRE(maximum > 0.5f);
+}
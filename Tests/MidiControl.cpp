@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <utility>
+#include <vector>
+
+// Module to test.
+#include <cdrt/helper/MidiControl.h>
+
+namespace
+{
+namespace midi = cdrt::helper::midi;
+} // namespace
+
+TEST_CASE("MidiControl: controllers and notes are translated to changes")
+{
+    midi::Mapping mapping;
+    midi::Changes changes;
+
+    REQUIRE (midi::getChanges (juce::MidiMessage::controllerEvent (1, mapping.timeController, 127), mapping, changes) == 1);
+    REQUIRE (changes[0].target == midi::Target::time);
+    REQUIRE_THAT (changes[0].value, Catch::Matchers::WithinAbs (mapping.maxTimeInMilliseconds, 1.0e-3));
+
+    REQUIRE (midi::getChanges (juce::MidiMessage::controllerEvent (1, mapping.feedbackController, 0), mapping, changes) == 1);
+    REQUIRE (changes[0].target == midi::Target::feedback);
+    REQUIRE (changes[0].value == 0.0f);
+
+    REQUIRE (midi::getChanges (juce::MidiMessage::controllerEvent (16, mapping.mixController, 127), mapping, changes) == 1);
+    REQUIRE (changes[0].target == midi::Target::mix);
+    REQUIRE (changes[0].value == 1.0f);
+
+    // A note sets the time to its period (A4, 440 Hz) and the feedback to its velocity, below 1 at the loudest.
+    REQUIRE (midi::getChanges (juce::MidiMessage::noteOn (1, 69, static_cast<juce::uint8> (127)), mapping, changes) == 2);
+    REQUIRE (changes[0].target == midi::Target::time);
+    REQUIRE_THAT (changes[0].value, Catch::Matchers::WithinAbs (1000.0 / 440.0, 1.0e-4));
+    REQUIRE (changes[1].target == midi::Target::feedback);
+    REQUIRE (changes[1].value == mapping.maxNoteFeedback);
+    REQUIRE (changes[1].value < 1.0f);
+
+    // Not mapped.
+    REQUIRE (midi::getChanges (juce::MidiMessage::noteOff (1, 69), mapping, changes) == 0);
+    REQUIRE (midi::getChanges (juce::MidiMessage::controllerEvent (1, 1, 64), mapping, changes) == 0);
+
+    // Other channels are ignored once a channel is set.
+    mapping.channel = 2;
+    REQUIRE (midi::getChanges (juce::MidiMessage::controllerEvent (1, mapping.timeController, 64), mapping, changes) == 0);
+    REQUIRE (midi::getChanges (juce::MidiMessage::controllerEvent (2, mapping.timeController, 64), mapping, changes) == 1);
+}
+
+TEST_CASE("MidiControl: the block is split at the changes only")
+{
+    constexpr int numSamples = 256;
+
+    midi::Mapping mapping;
+    juce::MidiBuffer messages;
+
+    messages.addEvent (juce::MidiMessage::controllerEvent (1, mapping.feedbackController, 64), 0);
+    messages.addEvent (juce::MidiMessage::controllerEvent (1, 1, 64), 32);    // Not mapped, no split.
+    messages.addEvent (juce::MidiMessage::controllerEvent (1, mapping.timeController, 64), 100);
+    messages.addEvent (juce::MidiMessage::noteOn (1, 60, static_cast<juce::uint8> (100)), 100);
+    messages.addEvent (juce::MidiMessage::controllerEvent (1, mapping.mixController, 64), numSamples + 10);
+
+    // Parts as (start, numSamples), the changes as the number of samples processed when they are applied.
+    std::vector<std::pair<int, int>> parts;
+    std::vector<std::pair<midi::Target, int>> applied;
+    int processed = 0;
+
+    midi::splitBlock (messages, mapping, numSamples,
+                      [&] (const int start, const int count)
+                      {
+                          REQUIRE (start == processed);
+                          parts.emplace_back (start, count);
+                          processed += count;
+                      },
+                      [&] (const midi::Change& change) { applied.emplace_back (change.target, processed); });
+
+    const std::vector<std::pair<int, int>> expectedParts { { 0, 100 }, { 100, numSamples - 100 } };
+    const std::vector<std::pair<midi::Target, int>> expectedChanges { { midi::Target::feedback, 0 },
+                                                                      { midi::Target::time, 100 },
+                                                                      { midi::Target::time, 100 },
+                                                                      { midi::Target::feedback, 100 },
+                                                                      { midi::Target::mix, numSamples } };
+    REQUIRE (parts == expectedParts);
+    REQUIRE (applied == expectedChanges);
+
+    // Without events the block is processed at once.
+    parts.clear();
+    midi::splitBlock (juce::MidiBuffer(), mapping, numSamples,
+                      [&] (const int start, const int count) { parts.emplace_back (start, count); },
+                      [] (const midi::Change&) {});
+
+    REQUIRE (parts.size() == 1);
+    REQUIRE (parts[0] == std::make_pair (0, numSamples));
+}
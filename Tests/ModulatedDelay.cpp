@@ -0,0 +1,124 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/ModulatedDelay.h>
+
+namespace
+{
+using ModulatedDelay = cdrt::dsp::ModulatedDelay<float>;
+
+// Processes the signal in place, in blocks of the given size.
+void process (ModulatedDelay& effect, std::vector<float>& signal, const int blockSize)
+{
+    for (size_t start = 0; start < signal.size(); start += static_cast<size_t> (blockSize))
+    {
+        auto* data = signal.data() + start;
+        const auto numSamples = std::min (signal.size() - start, static_cast<size_t> (blockSize));
+        juce::dsp::AudioBlock<float> block (&data, 1, numSamples);
+        effect.process (juce::dsp::ProcessContextReplacing<float> (block));
+    }
+}
+} // namespace
+
+TEST_CASE("ModulatedDelay: without depth the modes are fixed delays with their mix and feedback")
+{
+    // 2 samples every millisecond: chorus at 30 samples, flanger at 5, vibrato at 10.
+    for (const auto mode: { ModulatedDelay::Mode::chorus, ModulatedDelay::Mode::flanger, ModulatedDelay::Mode::vibrato })
+    {
+        ModulatedDelay effect;
+        effect.setMode (mode);
+        effect.setDepth (0.0f);
+        effect.prepare ({ 2000.0, 16, 1 });
+
+        std::vector<float> signal (64, 0.0f);
+        signal[0] = 1.0f;
+        process (effect, signal, 16);
+
+        switch (mode)
+        {
+            case ModulatedDelay::Mode::chorus:
+                // Every voice at the centre delay, half dry and half wet.
+                REQUIRE_THAT(signal[0], Catch::Matchers::WithinAbs (0.5, 1.0e-6));
+                REQUIRE_THAT(signal[30], Catch::Matchers::WithinAbs (0.5, 1.0e-6));
+                break;
+
+            case ModulatedDelay::Mode::flanger:
+                // The repeats of the feedback come back every delay.
+                REQUIRE_THAT(signal[0], Catch::Matchers::WithinAbs (0.5, 1.0e-6));
+                REQUIRE_THAT(signal[5], Catch::Matchers::WithinAbs (0.5, 1.0e-6));
+                REQUIRE_THAT(signal[10], Catch::Matchers::WithinAbs (0.3, 1.0e-6));
+                REQUIRE_THAT(signal[15], Catch::Matchers::WithinAbs (0.18, 1.0e-6));
+                break;
+
+            case ModulatedDelay::Mode::vibrato:
+                // Wet only.
+                REQUIRE(signal[0] == 0.0f);
+                REQUIRE_THAT(signal[10], Catch::Matchers::WithinAbs (1.0, 1.0e-6));
+                break;
+        }
+    }
+}
+
+TEST_CASE("ModulatedDelay: the vibrato delay sweeps the full depth whatever the block size")
+{
+    // On a ramp the output tells the delay of every sample: 50 samples from the centre, 30 of depth.
+    for (const auto blockSize: { 100, 37 })
+    {
+        ModulatedDelay effect;
+        effect.setMode (ModulatedDelay::Mode::vibrato);
+        effect.setRate (50.0f);
+        effect.setDepth (1.0f);
+        effect.prepare ({ 10000.0, 100, 1 });
+
+        std::vector<float> signal (2000);
+        for (size_t i = 0; i < signal.size(); ++i)
+            signal[i] = static_cast<float> (i);
+
+        process (effect, signal, blockSize);
+
+        float minimum = 1000.0f, maximum = 0.0f, previous = 0.0f;
+
+        for (size_t i = 200; i < signal.size(); ++i)
+        {
+            const auto delay = static_cast<float> (i) - signal[i];
+            minimum = std::min (minimum, delay);
+            maximum = std::max (maximum, delay);
+
+            // A sine of 200 samples with 30 samples of depth moves by less than a sample each time.
+            if (i > 200)
+                REQUIRE(std::abs (delay - previous) < 1.0f);
+
+            previous = delay;
+        }
+
+        REQUIRE_THAT(minimum, Catch::Matchers::WithinAbs (20.0, 0.1));
+        REQUIRE_THAT(maximum, Catch::Matchers::WithinAbs (80.0, 0.1));
+    }
+}
+
+TEST_CASE("ModulatedDelay: blocks longer than prepared are processed in parts")
+{
+    ModulatedDelay parts, whole;
+
+    for (auto* effect: { &parts, &whole })
+    {
+        effect->setMode (ModulatedDelay::Mode::flanger);
+        effect->setRate (20.0f);
+        effect->setDepth (1.0f);
+        effect->prepare ({ 10000.0, 16, 1 });
+    }
+
+    std::vector<float> expected (960), actual (960);
+    for (size_t i = 0; i < expected.size(); ++i)
+        expected[i] = actual[i] = std::sin (0.05f * static_cast<float> (i));
+
+    // The parts of the long blocks fall where the short blocks do.
+    process (parts, expected, 16);
+    process (whole, actual, 160);
+
+    REQUIRE(actual == expected);
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/MultiBandDelay.h>
+
+namespace
+{
+using MultiBandDelay = cdrt::dsp::MultiBandDelay<float>;
+
+constexpr double sampleRate = 48000.0;
+
+// Output of both channels, the right channel is the left one inverted, processed in blocks of an odd size.
+void render (MultiBandDelay& multiBandDelay, std::vector<float>& left, std::vector<float>& right)
+{
+    constexpr int blockSize = 100;
+    const auto length = static_cast<int> (left.size());
+
+    for (size_t i = 0; i < left.size(); ++i)
+        right[i] = -left[i];
+
+    for (int start = 0; start < length; start += blockSize)
+    {
+        float* channels[] = { left.data() + start, right.data() + start };
+        juce::dsp::AudioBlock<float> block (channels, 2, static_cast<size_t> (juce::jmin (blockSize, length - start)));
+        multiBandDelay.process (juce::dsp::ProcessContextReplacing<float> (block));
+    }
+}
+
+// Energy of a tone after the given sample, the delays are longer than the transient of the crossovers.
+double energyAfter (const std::vector<float>& samples, const size_t start, const size_t end)
+{
+    double energy = 0.0;
+
+    for (size_t i = start; i < end; ++i)
+        energy += static_cast<double> (samples[i]) * static_cast<double> (samples[i]);
+
+    return energy;
+}
+} // namespace
+
+TEST_CASE("MultiBandDelay: the bands sum to an allpass with the same delay on every band")
+{
+    for (int numBands = MultiBandDelay::minBands; numBands <= MultiBandDelay::maxBands; ++numBands)
+    {
+        MultiBandDelay multiBandDelay;
+        multiBandDelay.prepare ({ sampleRate, 100, 2 }, 4800);
+        multiBandDelay.setNumBands (numBands);
+
+        for (int band = 0; band < numBands; ++band)
+            multiBandDelay.setBand (band, 64.0f, 0.0f);
+
+        std::vector<float> left (16384, 0.0f), right (16384, 0.0f);
+        left[0] = 1.0f;
+        render (multiBandDelay, left, right);
+
+        // Nothing before the delay, the energy of the impulse after it.
+        for (size_t i = 0; i < 64; ++i)
+            REQUIRE(left[i] == 0.0f);
+
+        REQUIRE_THAT(energyAfter (left, 64, left.size()), Catch::Matchers::WithinAbs (1.0, 1.0e-3));
+        REQUIRE_THAT(energyAfter (right, 64, right.size()), Catch::Matchers::WithinAbs (1.0, 1.0e-3));
+    }
+}
+
+TEST_CASE("MultiBandDelay: low and high tones are delayed by their bands")
+{
+    constexpr int lowDelay = 2000;
+    constexpr int highDelay = 400;
+    constexpr size_t length = 4000;
+
+    for (int numBands = MultiBandDelay::minBands; numBands <= MultiBandDelay::maxBands; ++numBands)
+    {
+        MultiBandDelay multiBandDelay;
+        multiBandDelay.prepare ({ sampleRate, 100, 2 }, 4800);
+        multiBandDelay.setNumBands (numBands);
+        multiBandDelay.setCrossover (0, 200.0f);
+        multiBandDelay.setCrossover (1, 1000.0f);
+        multiBandDelay.setCrossover (2, 5000.0f);
+
+        multiBandDelay.setBand (0, static_cast<float> (lowDelay), 0.0f);
+        for (int band = 1; band < numBands; ++band)
+            multiBandDelay.setBand (band, static_cast<float> (highDelay), 0.0f);
+
+        // 50 Hz tone in the lowest band, 12 kHz tone in the highest one.
+        std::vector<float> low (length), high (length), right (length);
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            low[i] = static_cast<float> (std::sin (2.0 * juce::MathConstants<double>::pi * 50.0 * static_cast<double> (i) / sampleRate));
+            high[i] = static_cast<float> (std::sin (2.0 * juce::MathConstants<double>::pi * 12000.0 * static_cast<double> (i) / sampleRate));
+        }
+
+        render (multiBandDelay, low, right);
+        multiBandDelay.reset();
+        render (multiBandDelay, high, right);
+
+        // The low tone is still silent after the delay of the high band, the high tone is not.
+        REQUIRE(energyAfter (low, 0, lowDelay) < 1.0e-3 * energyAfter (low, lowDelay, length));
+        REQUIRE(energyAfter (high, highDelay + 200, lowDelay) > 100.0);
+    }
+}
+
+TEST_CASE("MultiBandDelay: the feedback of a band repeats it at every delay")
+{
+    MultiBandDelay multiBandDelay;
+    multiBandDelay.prepare ({ sampleRate, 100, 2 }, 4800);
+    multiBandDelay.setNumBands (2);
+
+    for (int band = 0; band < 2; ++band)
+        multiBandDelay.setBand (band, 1000.0f, 0.5f);
+
+    std::vector<float> left (8192, 0.0f), right (8192, 0.0f);
+    left[0] = 1.0f;
+    render (multiBandDelay, left, right);
+
+    // The repeats are fed back after the crossover, every one is half the previous one.
+    const auto first = energyAfter (left, 1000, 2000);
+    const auto second = energyAfter (left, 2000, 3000);
+
+    REQUIRE_THAT(second / first, Catch::Matchers::WithinAbs (0.25, 1.0e-2));
+}
+
+TEST_CASE("MultiBandDelay: blocks longer than prepared are processed in parts")
+{
+    MultiBandDelay parts, whole;
+
+    for (auto* multiBandDelay: { &parts, &whole })
+    {
+        multiBandDelay->prepare ({ sampleRate, 100, 2 }, 4800);
+        multiBandDelay->setNumBands (3);
+
+        for (int band = 0; band < 3; ++band)
+            multiBandDelay->setBand (band, 40.0f * static_cast<float> (band + 1), 0.5f);
+    }
+
+    std::vector<float> expectedLeft (1000, 0.0f), expectedRight (1000, 0.0f);
+    expectedLeft[0] = 1.0f;
+    auto actualLeft = expectedLeft, actualRight = expectedRight;
+
+    render (parts, expectedLeft, expectedRight);
+
+    // A single block of ten times the prepared size.
+    for (size_t i = 0; i < actualLeft.size(); ++i)
+        actualRight[i] = -actualLeft[i];
+
+    float* channels[] = { actualLeft.data(), actualRight.data() };
+    juce::dsp::AudioBlock<float> block (channels, 2, actualLeft.size());
+    whole.process (juce::dsp::ProcessContextReplacing<float> (block));
+
+    REQUIRE(actualLeft == expectedLeft);
+    REQUIRE(actualRight == expectedRight);
+}
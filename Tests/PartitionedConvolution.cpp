@@ -0,0 +1,90 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <random>
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/PartitionedConvolution.h>
+
+namespace
+{
+using PartitionedConvolution = cdrt::dsp::PartitionedConvolution;
+
+std::vector<float> noise (const size_t length, const unsigned int seed)
+{
+    std::minstd_rand generator (seed);
+    std::uniform_real_distribution<float> distribution (-1.0f, 1.0f);
+    std::vector<float> samples (length);
+
+    for (auto& sample: samples)
+        sample = distribution (generator);
+
+    return samples;
+}
+
+// Output of one channel processed in blocks of an odd size, crossing every block boundary.
+std::vector<float> convolve (PartitionedConvolution& convolution, std::vector<float> samples, const int blockSize)
+{
+    const auto length = static_cast<int> (samples.size());
+
+    for (int start = 0; start < length; start += blockSize)
+    {
+        float* channels[] = { samples.data() + start };
+        juce::dsp::AudioBlock<float> block (channels, 1, static_cast<size_t> (juce::jmin (blockSize, length - start)));
+        convolution.process (juce::dsp::ProcessContextReplacing<float> (block));
+    }
+
+    return samples;
+}
+} // namespace
+
+TEST_CASE("PartitionedConvolution: the output is the convolution with no latency")
+{
+    const auto input = noise (12000, 1);
+
+    // Head only, head and body, every part, partial partitions.
+    for (const auto impulseLength: { 40, 64, 1000, 2048, 5000, 7333 })
+    {
+        for (const auto blockSize: { 1, 37, 512 })
+        {
+            auto impulse = noise (static_cast<size_t> (impulseLength), 2);
+            const float* impulseChannels[] = { impulse.data() };
+
+            PartitionedConvolution convolution;
+            convolution.prepare ({ 48000.0, static_cast<juce::uint32> (blockSize), 1 }, 8000);
+            convolution.setImpulseResponse (impulseChannels, 1, impulseLength);
+
+            const auto output = convolve (convolution, input, blockSize);
+
+            for (size_t n = 0; n < input.size(); n += 7)
+            {
+                double expected = 0.0;
+
+                for (size_t tap = 0; tap < impulse.size() && tap <= n; ++tap)
+                    expected += static_cast<double> (impulse[tap]) * static_cast<double> (input[n - tap]);
+
+                REQUIRE_THAT(output[n], Catch::Matchers::WithinAbs (expected, 2.0e-3));
+            }
+        }
+    }
+}
+
+TEST_CASE("PartitionedConvolution: reset clears the input and the pending tail")
+{
+    const auto impulseLength = 6000;
+    auto impulse = noise (static_cast<size_t> (impulseLength), 3);
+    const float* impulseChannels[] = { impulse.data() };
+
+    PartitionedConvolution convolution;
+    convolution.prepare ({ 48000.0, 256, 1 }, impulseLength);
+    convolution.setImpulseResponse (impulseChannels, 1, impulseLength);
+
+    convolve (convolution, noise (5000, 4), 256);
+    convolution.reset();
+
+    const auto output = convolve (convolution, std::vector<float> (8192, 0.0f), 256);
+
+    for (const auto sample: output)
+        REQUIRE(sample == 0.0f);
+}
@@ -0,0 +1,144 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Module to test.
+#include <cdrt/utility/PeakPyramid.h>
+
+namespace
+{
+using PeakPyramid = cdrt::utility::PeakPyramid;
+
+// Minimum and maximum of the samples from start to end (excluded).
+PeakPyramid::Peak getExactPeak (const std::vector<float>& signal, const size_t start, const size_t end)
+{
+    const auto [minimum, maximum] = std::minmax_element (signal.begin() + static_cast<long> (start), signal.begin() + static_cast<long> (end));
+    return { *minimum, *maximum };
+}
+} // namespace
+
+TEST_CASE("PeakPyramid: the peaks of every zoom level match the samples")
+{
+    constexpr int historySamples = 8192;
+
+    PeakPyramid pyramid;
+    pyramid.prepare (1, historySamples);
+    REQUIRE (pyramid.getNumLevels() == 5); // Buckets of 16 to 4096 samples.
+
+    // More than the history in uneven blocks, the total a multiple of the largest span tested.
+    juce::Random random (3);
+    std::vector<float> signal (static_cast<size_t> (2 * historySamples + 1024));
+
+    for (auto& sample: signal)
+        sample = 2.0f * random.nextFloat() - 1.0f;
+
+    for (size_t position = 0; position < signal.size();)
+    {
+        const auto numSamples = std::min (signal.size() - position, static_cast<size_t> (1 + random.nextInt (300)));
+        pyramid.push (0, signal.data() + position, static_cast<int> (numSamples));
+        position += numSamples;
+    }
+
+    // Spans aligned to the buckets of a level are exact.
+    for (const auto span: { 16, 64, 256, 1024, 8192 })
+    {
+        const auto numPeaks = historySamples / span;
+        std::vector<PeakPyramid::Peak> peaks (static_cast<size_t> (numPeaks));
+
+        REQUIRE (pyramid.getPeaks (0, 0.0, historySamples, peaks.data(), numPeaks));
+
+        for (int peak = 0; peak < numPeaks; ++peak)
+        {
+            const auto end = signal.size() - static_cast<size_t> (peak * span);
+            const auto exact = getExactPeak (signal, end - static_cast<size_t> (span), end);
+
+            REQUIRE (peaks[static_cast<size_t> (peak)].minimum == exact.minimum);
+            REQUIRE (peaks[static_cast<size_t> (peak)].maximum == exact.maximum);
+        }
+    }
+
+    // Other spans cover at least their samples.
+    std::vector<PeakPyramid::Peak> peaks (7);
+    REQUIRE (pyramid.getPeaks (0, 10.0, 1000.0, peaks.data(), 7));
+
+    for (size_t peak = 0; peak < peaks.size(); ++peak)
+    {
+        const auto end = signal.size() - static_cast<size_t> (10.0 + static_cast<double> (peak) * 990.0 / 7.0);
+        const auto start = signal.size() - static_cast<size_t> (10.0 + static_cast<double> (peak + 1) * 990.0 / 7.0);
+        const auto exact = getExactPeak (signal, start, end);
+
+        REQUIRE (peaks[peak].minimum <= exact.minimum);
+        REQUIRE (peaks[peak].maximum >= exact.maximum);
+    }
+}
+
+TEST_CASE("PeakPyramid: samples older than the history or never pushed are silent")
+{
+    PeakPyramid pyramid;
+    pyramid.prepare (2, 1000);
+
+    const std::vector<float> ones (100, 1.0f);
+    pyramid.push (1, ones.data(), static_cast<int> (ones.size()));
+
+    std::vector<PeakPyramid::Peak> peaks (4);
+
+    // The first 100 samples only, the rest is not pushed yet.
+    REQUIRE (pyramid.getPeaks (1, 0.0, 400.0, peaks.data(), 4));
+    REQUIRE (peaks[0].maximum == 1.0f);
+    REQUIRE (peaks[1].maximum == 0.0f);
+    REQUIRE (peaks[3].minimum == 0.0f);
+
+    // Nothing on the other channel, nothing past the history.
+    REQUIRE (pyramid.getPeaks (0, 0.0, 400.0, peaks.data(), 4));
+    REQUIRE (peaks[0].maximum == 0.0f);
+
+    REQUIRE (pyramid.getPeaks (1, 1000.0, 2000.0, peaks.data(), 4));
+    REQUIRE (peaks[0].maximum == 0.0f);
+
+    pyramid.reset();
+    REQUIRE (pyramid.getPeaks (1, 0.0, 400.0, peaks.data(), 4));
+    REQUIRE (peaks[0].maximum == 0.0f);
+}
+
+TEST_CASE("PeakPyramid: a reader never gets a torn bucket while the audio thread pushes")
+{
+    constexpr int blockSize = 64;
+
+    PeakPyramid pyramid;
+    pyramid.prepare (1, 48000);
+
+    // Every block is constant: a consistent read of the newest bucket has the same minimum and maximum.
+    std::atomic<bool> done { false };
+    std::thread writer ([&]
+    {
+        std::vector<float> block (blockSize);
+
+        for (int index = 0; index < 20000; ++index)
+        {
+            std::fill (block.begin(), block.end(), static_cast<float> (index % 1000) * 0.001f);
+            pyramid.push (0, block.data(), blockSize);
+        }
+
+        done = true;
+    });
+
+    int consistentReads = 0;
+
+    do
+    {
+        PeakPyramid::Peak peak;
+
+        if (pyramid.getPeaks (0, 0.0, PeakPyramid::baseBucketSamples, &peak, 1))
+        {
+            REQUIRE (peak.minimum == peak.maximum);
+            ++consistentReads;
+        }
+    }
+    while (! done.load());
+
+    writer.join();
+    REQUIRE (consistentReads > 0);
+}
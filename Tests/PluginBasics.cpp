@@ -2,6 +2,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <cmath>
+
 TEST_CASE("one is equal to one", "[dummy]")
 {
   REQUIRE(1 == 1);
@@ -24,3 +26,79 @@ TEST_CASE("IPP version", "[ipp]")
   CHECK_THAT(ippsGetLibVersion()->Version, Catch::Matchers::Equals("2021.7 (r0xa954907f)"));
 }
 #endif
+
+TEST_CASE("Plugin reset: a job after another starts silent", "[reset]")
+{
+  constexpr int blockSize = 256;
+
+  AudioPluginAudioProcessor plugin;
+  juce::AudioBuffer<float> buffer (2, blockSize);
+  juce::MidiBuffer midi;
+
+  // What the render daemon does between two jobs, the same spec keeps the delay lines.
+  // Short repeats with feedback, the wet signal only.
+  const auto prepare = [&]
+  {
+    plugin.prepareToPlay (48000.0, blockSize);
+    plugin.reset();
+
+    plugin.parameterChanged ("time", 50.0f);
+    plugin.parameterChanged ("feedback", 0.5f);
+    plugin.parameterChanged ("dry", 0.0f);
+    plugin.parameterChanged ("wet", 1.0f);
+  };
+
+  // First job: a tone, its repeats are still in the delay lines when the job ends.
+  prepare();
+
+  for (int block = 0; block < 40; ++block)
+  {
+    for (int channel = 0; channel < 2; ++channel)
+      for (int sample = 0; sample < blockSize; ++sample)
+        buffer.setSample (channel, sample, std::sin (0.05f * static_cast<float> (block * blockSize + sample)));
+
+    plugin.processBlock (buffer, midi);
+  }
+
+  // Second job: silence in, silence out.
+  prepare();
+
+  for (int block = 0; block < 40; ++block)
+  {
+    buffer.clear();
+    plugin.processBlock (buffer, midi);
+    REQUIRE(buffer.getMagnitude (0, blockSize) == 0.0f);
+  }
+}
+
+TEST_CASE("Plugin MIDI: a note sets the delay time at its position", "[midi]")
+{
+  AudioPluginAudioProcessor plugin;
+  plugin.prepareToPlay (48000.0, 256);
+  plugin.parameterChanged ("time", 500.0f);
+
+  // A4, the period of the note without the one second glide of the parameter.
+  plugin.applyMidiChange ({ cdrt::helper::midi::Target::time, 1000.0f / 440.0f });
+
+  for (const auto& value: plugin.delayLineTimeValueSmoothed)
+  {
+    REQUIRE(value.getCurrentValue() == 1000.0f / 440.0f);
+    REQUIRE_FALSE(value.isSmoothing());
+  }
+}
+
+TEST_CASE("Plugin parallel delay lines: the workers start only when enabled", "[parallel]")
+{
+  AudioPluginAudioProcessor plugin;
+
+  plugin.prepareToPlay (48000.0, 256);
+  REQUIRE(plugin.delayWorkers.getNumWorkers() == 0);
+
+  plugin.setParallelDelayLines (true);
+  plugin.prepareToPlay (48000.0, 256);
+  REQUIRE(plugin.delayWorkers.getNumWorkers() == juce::jmin (AudioPluginAudioProcessor::numDelayLines - 1, juce::SystemStats::getNumCpus() - 1));
+
+  plugin.setParallelDelayLines (false);
+  plugin.prepareToPlay (48000.0, 256);
+  REQUIRE(plugin.delayWorkers.getNumWorkers() == 0);
+}
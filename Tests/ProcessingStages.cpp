@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/ProcessingStages.h>
+
+namespace
+{
+using CallbackStage = cdrt::dsp::CallbackStage<float>;
+using MixStage = cdrt::dsp::MixStage<float>;
+
+constexpr double sampleRate = 48000.0;
+constexpr int blockSize = 64;
+
+// Doubles every sample of the block, counts the calls.
+void doubleBlock (void* context, const juce::dsp::AudioBlock<float>& block)
+{
+    ++*static_cast<int*> (context);
+
+    for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        juce::FloatVectorOperations::multiply (block.getChannelPointer (channel), 2.0f, static_cast<int> (block.getNumSamples()));
+}
+} // namespace
+
+TEST_CASE("CallbackStage: the callback processes the whole block in place")
+{
+    std::vector<float> left (blockSize, 1.0f), right (blockSize, -1.0f);
+    float* channels[] = { left.data(), right.data() };
+    juce::dsp::AudioBlock<float> block (channels, 2, blockSize);
+
+    CallbackStage stage;
+    stage.prepare ({ sampleRate, blockSize, 2 });
+
+    // Without a callback the block is left untouched.
+    stage.process (juce::dsp::ProcessContextReplacing<float> (block));
+    REQUIRE (left[0] == 1.0f);
+
+    int calls = 0;
+    stage.setCallback (doubleBlock, &calls);
+    stage.process (juce::dsp::ProcessContextReplacing<float> (block));
+
+    REQUIRE (calls == 1);
+
+    for (int i = 0; i < blockSize; ++i)
+    {
+        REQUIRE (left[static_cast<size_t> (i)] == 2.0f);
+        REQUIRE (right[static_cast<size_t> (i)] == -2.0f);
+    }
+}
+
+TEST_CASE("MixStage: the dry and wet levels are a proportion and a level")
+{
+    MixStage stage;
+
+    stage.setLevels (0.7f, 0.7f);
+    REQUIRE_THAT (stage.getWetProportion(), Catch::Matchers::WithinAbs (0.5f, 1.0e-6f));
+    REQUIRE_THAT (stage.getMixLevel(), Catch::Matchers::WithinAbs (1.4f, 1.0e-6f));
+
+    stage.setLevels (0.2f, 0.6f);
+    REQUIRE_THAT (stage.getWetProportion(), Catch::Matchers::WithinAbs (0.75f, 1.0e-6f));
+    REQUIRE_THAT (stage.getMixLevel(), Catch::Matchers::WithinAbs (0.8f, 1.0e-6f));
+
+    // Both silent: the level is 0 whatever the proportion.
+    stage.setLevels (0.0f, 0.0f);
+    REQUIRE (stage.getMixLevel() == 0.0f);
+    REQUIRE (stage.getWetProportion() >= 0.0f);
+    REQUIRE (stage.getWetProportion() <= 1.0f);
+}
+
+TEST_CASE("MixStage: dry and wet times their levels once the mix level is applied")
+{
+    constexpr float dry = 0.2f;
+    constexpr float wet = 0.6f;
+
+    MixStage stage;
+    stage.setLevels (dry, wet);
+    stage.prepare ({ sampleRate, blockSize, 2 });
+
+    std::vector<float> dryLeft (blockSize, 1.0f), dryRight (blockSize, 0.5f);
+    const float* dryChannels[] = { dryLeft.data(), dryRight.data() };
+    stage.pushDrySamples (juce::dsp::AudioBlock<const float> (dryChannels, 2, blockSize));
+
+    std::vector<float> left (blockSize, -1.0f), right (blockSize, 2.0f);
+    float* channels[] = { left.data(), right.data() };
+    juce::dsp::AudioBlock<float> block (channels, 2, blockSize);
+    stage.process (juce::dsp::ProcessContextReplacing<float> (block));
+
+    // Prepared at the levels, no ramp.
+    for (int i = 0; i < blockSize; ++i)
+    {
+        const auto index = static_cast<size_t> (i);
+        REQUIRE_THAT (left[index] * stage.getMixLevel(), Catch::Matchers::WithinAbs (dry * 1.0f + wet * -1.0f, 1.0e-5f));
+        REQUIRE_THAT (right[index] * stage.getMixLevel(), Catch::Matchers::WithinAbs (dry * 0.5f + wet * 2.0f, 1.0e-5f));
+    }
+}
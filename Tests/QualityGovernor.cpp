@@ -0,0 +1,72 @@
+#include <catch2/catch_test_macros.hpp>
+
+// Module to test.
+#include <cdrt/utility/QualityGovernor.h>
+
+namespace
+{
+// Feeds blocks of 480 samples (10 ms at 48 kHz) with the given load, returns the number of level changes.
+int feed (cdrt::utility::QualityGovernor& governor, const double load, const double seconds)
+{
+    int changes = 0;
+
+    for (int block = 0; block < static_cast<int> (seconds * 100.0); ++block)
+        changes += governor.addMeasurement (load * 0.01, 480) ? 1 : 0;
+
+    return changes;
+}
+} // namespace
+
+TEST_CASE("QualityGovernor: steps down under load and back up with hysteresis")
+{
+    cdrt::utility::QualityGovernor governor;
+    governor.setMaximumLevel (3);
+    governor.prepare (48000.0);
+    governor.setThresholds (0.6, 0.3);
+
+    REQUIRE(governor.getLevel() == 3);
+
+    // Load between the thresholds never changes the level.
+    REQUIRE(feed (governor, 0.45, 10.0) == 0);
+    REQUIRE(governor.getLevel() == 3);
+
+    // Sustained overload goes down one level at a time, down to 0.
+    feed (governor, 0.9, 0.4);
+    REQUIRE(governor.getLevel() == 2);
+    feed (governor, 0.9, 10.0);
+    REQUIRE(governor.getLevel() == 0);
+
+    // A short period of headroom is not enough to go up.
+    feed (governor, 0.1, 1.0);
+    REQUIRE(governor.getLevel() == 0);
+    feed (governor, 0.1, 2.0);
+    REQUIRE(governor.getLevel() == 1);
+
+    // The maximum level bounds the current one.
+    governor.setMaximumLevel (0);
+    REQUIRE(governor.getLevel() == 0);
+    REQUIRE(feed (governor, 0.1, 10.0) == 0);
+}
+
+TEST_CASE("QualityGovernor: overload drops at once to the overload level")
+{
+    cdrt::utility::QualityGovernor governor;
+    governor.setMaximumLevel (6);
+    governor.prepare (48000.0);
+    governor.setThresholds (0.6, 0.3);
+    governor.setOverload (1.0, 1);
+
+    // Above the step down threshold only, one level at a time.
+    feed (governor, 0.8, 0.7);
+    REQUIRE(governor.getLevel() == 5);
+
+    // In overload the levels in between are skipped, without waiting for the load to settle.
+    REQUIRE(feed (governor, 2.0, 0.3) == 1);
+    REQUIRE(governor.getLevel() == 1);
+
+    // Below the overload level the steps are one at a time again.
+    feed (governor, 2.0, 0.2);
+    REQUIRE(governor.getLevel() == 1);
+    feed (governor, 2.0, 0.3);
+    REQUIRE(governor.getLevel() == 0);
+}
@@ -0,0 +1,180 @@
+#include <catch2/catch_test_macros.hpp>
+
+// The render service is Linux only.
+#if defined(__linux__)
+
+#include <atomic>
+#include <thread>
+#include <unistd.h>
+
+// Module to test.
+#include <cdrt/render/RenderClient.h>
+
+namespace
+{
+using namespace cdrt::render;
+
+constexpr uint32_t blockSize = 64;
+constexpr uint32_t numChannels = 2;
+
+// Segment of a daemon with one session served by a thread: every block is scaled by the last parameter value.
+struct FakeDaemon
+{
+    explicit FakeDaemon (const std::string& name)
+    {
+        Header layout {};
+        layout.numSessions = 1;
+        layout.blockSize = blockSize;
+        layout.numChannels = numChannels;
+
+        created = memory.create (protocol::getSegmentName (name), protocol::computeLayout (layout));
+
+        if (! created)
+            return;
+
+        header = static_cast<Header*> (memory.getData());
+        *header = layout;
+        header->sampleRate = 48000.0;
+        header->protocolVersion = protocol::version;
+        header->magicNumber = protocol::magic;
+
+        session().state.store (static_cast<uint32_t> (SessionState::idle));
+        worker = std::thread ([this] { serve(); });
+    }
+
+    ~FakeDaemon()
+    {
+        stop = true;
+        futex::wakeAll (session().blocks.written);
+
+        if (worker.joinable())
+            worker.join();
+    }
+
+    Session& session() { return protocol::getSession (*header, 0); }
+
+    void serve()
+    {
+        float gain = 1.0f;
+
+        while (! stop.load())
+        {
+            auto& current = session();
+            const auto processed = current.blocks.processed.load();
+            const auto written = current.blocks.written.load (std::memory_order_acquire);
+
+            if (current.state.load() != static_cast<uint32_t> (SessionState::claimed) || processed == written)
+            {
+                futex::wait (current.blocks.written, written, 10);
+                continue;
+            }
+
+            ParameterRing::Entry entry {};
+
+            while (current.parameters.pop (entry))
+                gain = entry.value;
+
+            for (uint32_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* samples = protocol::getSamples (*header, current, processed, channel);
+
+                for (uint32_t i = 0; i < blockSize; ++i)
+                    samples[i] *= gain;
+            }
+
+            current.blocks.processed.store (processed + 1, std::memory_order_release);
+            futex::wakeAll (current.blocks.processed);
+        }
+    }
+
+    SharedMemory memory;
+    Header* header = nullptr;
+    bool created = false;
+    std::atomic<bool> stop { false };
+    std::thread worker;
+};
+
+std::string getTestName()
+{
+    return "test-" + std::to_string (::getpid());
+}
+} // namespace
+
+TEST_CASE("RenderClient: blocks go through the worker in place, parameters apply from the next block")
+{
+    const auto name = getTestName();
+    FakeDaemon daemon (name);
+    REQUIRE(daemon.created);
+
+    RenderClient client;
+    REQUIRE(client.connect (name, 1000));
+    REQUIRE(client.getBlockSize() == static_cast<int> (blockSize));
+    REQUIRE(client.getNumChannels() == static_cast<int> (numChannels));
+
+    // The only session is taken.
+    RenderClient other;
+    REQUIRE_FALSE(other.connect (name, 20));
+
+    std::vector<float> left (blockSize, 1.0f), right (blockSize, -1.0f);
+    float* channels[] = { left.data(), right.data() };
+
+    REQUIRE(client.process (channels, channels, static_cast<int> (blockSize), 1000));
+    REQUIRE(left[0] == 1.0f);
+
+    REQUIRE(client.setParameter (0, 0.5f));
+    REQUIRE(client.process (channels, channels, static_cast<int> (blockSize), 1000));
+    REQUIRE(left[blockSize - 1] == 0.5f);
+    REQUIRE(right[0] == -0.5f);
+
+    // Pipelined: every slot is filled before the first output is read.
+    for (uint32_t block = 0; block < protocol::numBlockSlots; ++block)
+    {
+        auto* samples = client.getInputPointer (0);
+        REQUIRE(samples != nullptr);
+        std::fill (samples, samples + blockSize, static_cast<float> (block));
+        client.submitBlock();
+    }
+
+    REQUIRE(client.getInputPointer (0) == nullptr);
+
+    for (uint32_t block = 0; block < protocol::numBlockSlots; ++block)
+    {
+        const auto* samples = client.getOutputPointer (0, 1000);
+        REQUIRE(samples != nullptr);
+        REQUIRE(samples[0] == 0.5f * static_cast<float> (block));
+        client.finishBlock();
+    }
+
+    client.disconnect();
+    REQUIRE(daemon.session().state.load() == static_cast<uint32_t> (SessionState::released));
+}
+
+TEST_CASE("RenderClient: a failed worker fails the calls of the client only")
+{
+    const auto name = getTestName();
+    FakeDaemon daemon (name);
+    REQUIRE(daemon.created);
+
+    RenderClient client;
+    REQUIRE(client.connect (name, 1000));
+
+    // What the daemon does when the worker dies.
+    daemon.stop = true;
+    daemon.worker.join();
+    daemon.session().state.store (static_cast<uint32_t> (SessionState::failed));
+    futex::wakeAll (daemon.session().blocks.processed);
+
+    std::vector<float> left (blockSize, 1.0f), right (blockSize, 1.0f);
+    float* channels[] = { left.data(), right.data() };
+
+    REQUIRE_FALSE(client.isConnected());
+    REQUIRE_FALSE(client.process (channels, channels, static_cast<int> (blockSize), 1000));
+}
+
+TEST_CASE("RenderClient: connecting without a daemon fails")
+{
+    RenderClient client;
+    REQUIRE_FALSE(client.connect (getTestName() + "-missing", 10));
+}
+
+#endif
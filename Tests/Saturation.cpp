@@ -0,0 +1,169 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <juce_dsp/juce_dsp.h>
+
+// Module to test.
+#include <cdrt/dsp/Saturation.h>
+
+namespace
+{
+using Saturation = cdrt::dsp::Saturation<float>;
+
+constexpr double sampleRate = 48000.0;
+
+// Magnitude of the given frequency in the signal (single DFT bin).
+double magnitude (const std::vector<float>& signal, const double frequency)
+{
+    std::complex<double> sum;
+
+    for (size_t i = 0; i < signal.size(); ++i)
+        sum += static_cast<double> (signal[i]) * std::polar (1.0, -2.0 * std::numbers::pi * frequency * static_cast<double> (i) / sampleRate);
+
+    return std::abs (sum) / static_cast<double> (signal.size());
+}
+
+// A 5 kHz sine driven into the clipper, 4800 samples make every harmonic fall on a bin.
+std::vector<float> sine (const float amplitude)
+{
+    std::vector<float> signal (4800);
+
+    for (size_t i = 0; i < signal.size(); ++i)
+        signal[i] = amplitude * static_cast<float> (std::sin (2.0 * std::numbers::pi * 5000.0 * static_cast<double> (i) / sampleRate));
+
+    return signal;
+}
+} // namespace
+
+TEST_CASE("Saturation: constant inputs get the shaping function")
+{
+    for (const auto shape: { Saturation::Shape::tanh, Saturation::Shape::hardClip, Saturation::Shape::asymmetric })
+    {
+        Saturation saturation;
+        saturation.prepare (1);
+        saturation.setShape (shape);
+        saturation.setDrive (1.0f);
+
+        for (const auto input: { -0.5f, 0.05f, 0.3f, 1.0f })
+        {
+            float output = 0.0f;
+
+            for (int i = 0; i < 4; ++i)
+                output = saturation.processSample (0, input);
+
+            REQUIRE_THAT(output, Catch::Matchers::WithinAbs (Saturation::shapeFunction (shape, input, Saturation::getKnee (1.0f)), 1.0e-6));
+        }
+    }
+}
+
+TEST_CASE("Saturation: small signals are unchanged and loud ones keep their level")
+{
+    for (const auto shape: { Saturation::Shape::tanh, Saturation::Shape::hardClip, Saturation::Shape::asymmetric })
+    {
+        for (const auto drive: { 0.2f, 1.0f })
+        {
+            const auto knee = Saturation::getKnee (drive);
+
+            // Unit slope below the knee, full scale is never crossed and never far.
+            REQUIRE(Saturation::shapeFunction (shape, 0.5 * knee, knee) == 0.5 * knee);
+            REQUIRE(Saturation::shapeFunction (shape, -0.5 * knee, knee) == -0.5 * knee);
+
+            for (const auto input: { 1.0, -1.0, 4.0, -4.0 })
+            {
+                const auto output = std::abs (Saturation::shapeFunction (shape, input, knee));
+                REQUIRE(output <= 1.0);
+                REQUIRE(output >= 0.5 * std::min (std::abs (input), 1.0));
+            }
+
+            // The antiderivative matches the function.
+            for (const auto input: { -2.0, -0.7, 0.05, 0.6, 3.0 })
+            {
+                constexpr double h = 1.0e-5;
+                const auto slope = (Saturation::antiderivative (shape, input + h, knee) - Saturation::antiderivative (shape, input - h, knee)) / (2.0 * h);
+                REQUIRE_THAT(slope, Catch::Matchers::WithinAbs (Saturation::shapeFunction (shape, input, knee), 1.0e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Saturation: antiderivative antialiasing lowers the aliased harmonics")
+{
+    Saturation saturation;
+    saturation.prepare (1);
+    saturation.setShape (Saturation::Shape::hardClip);
+    saturation.setDrive (1.0f);
+
+    const auto input = sine (0.5f);
+    auto naive = input;
+    auto antialiased = input;
+
+    for (auto& sample: naive)
+        sample = static_cast<float> (Saturation::shapeFunction (Saturation::Shape::hardClip, sample, Saturation::getKnee (1.0f)));
+
+    for (auto& sample: antialiased)
+        sample = saturation.processSample (0, sample);
+
+    // The 9th harmonic (45 kHz) folds back to 3 kHz, the 3rd one (15 kHz) is below Nyquist.
+    REQUIRE(magnitude (antialiased, 3000.0) < 0.5 * magnitude (naive, 3000.0));
+    REQUIRE(magnitude (antialiased, 15000.0) > 0.3 * magnitude (naive, 15000.0));
+}
+
+TEST_CASE("Saturation: antiderivative antialiasing against oversampled waveshaping", "[.][benchmark]")
+{
+    constexpr int blockSize = 512;
+    const auto input = sine (0.5f);
+
+    juce::AudioBuffer<float> buffer (2, blockSize);
+
+    const auto fill = [&buffer, &input]
+    {
+        for (int channel = 0; channel < 2; ++channel)
+            buffer.copyFrom (channel, 0, input.data(), blockSize);
+    };
+
+    Saturation saturation;
+    saturation.prepare (2);
+    saturation.setShape (Saturation::Shape::tanh);
+    saturation.setDrive (1.0f);
+
+    BENCHMARK("ADAA tanh, base rate")
+    {
+        fill();
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            auto* samples = buffer.getWritePointer (channel);
+
+            for (int i = 0; i < blockSize; ++i)
+                samples[i] = saturation.processSample (channel, samples[i]);
+        }
+
+        return buffer.getSample (0, 0);
+    };
+
+    for (const auto factor: { 1, 2 })
+    {
+        juce::dsp::Oversampling<float> oversampling (2, static_cast<size_t> (factor), juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR);
+        oversampling.initProcessing (blockSize);
+
+        BENCHMARK(factor == 1 ? "tanh, 2x oversampled" : "tanh, 4x oversampled")
+        {
+            fill();
+
+            juce::dsp::AudioBlock<float> block (buffer);
+            auto upsampled = oversampling.processSamplesUp (block);
+
+            for (size_t channel = 0; channel < upsampled.getNumChannels(); ++channel)
+                for (size_t i = 0; i < upsampled.getNumSamples(); ++i)
+                    upsampled.setSample (static_cast<int> (channel), static_cast<int> (i),
+                                         static_cast<float> (Saturation::shapeFunction (Saturation::Shape::tanh, upsampled.getSample (static_cast<int> (channel), static_cast<int> (i)), Saturation::getKnee (1.0f))));
+
+            oversampling.processSamplesDown (block);
+            return buffer.getSample (0, 0);
+        };
+    }
+}
@@ -0,0 +1,71 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <vector>
+
+// Module to test.
+#include <cdrt/dsp/SpectralDelay.h>
+
+namespace
+{
+using SpectralDelay = cdrt::dsp::SpectralDelay;
+
+// Impulse response of one channel, processed in blocks of an odd size to cross the task points.
+std::vector<float> impulseResponse (SpectralDelay& spectralDelay, const int length)
+{
+    constexpr int blockSize = 100;
+    std::vector<float> samples (static_cast<size_t> (length), 0.0f);
+    samples[0] = 1.0f;
+
+    for (int start = 0; start < length; start += blockSize)
+    {
+        float* channels[] = { samples.data() + start };
+        juce::dsp::AudioBlock<float> block (channels, 1, static_cast<size_t> (juce::jmin (blockSize, length - start)));
+        spectralDelay.process (juce::dsp::ProcessContextReplacing<float> (block));
+    }
+
+    return samples;
+}
+} // namespace
+
+TEST_CASE("SpectralDelay: the same delay on every band is a plain delay after the latency")
+{
+    SpectralDelay spectralDelay;
+    spectralDelay.prepare ({ 48000.0, 100, 1 }, 48000);
+
+    for (int band = 0; band < SpectralDelay::numBands; ++band)
+        spectralDelay.setBand (band, 4.0f * SpectralDelay::hopSize, 0.0f);
+
+    const auto output = impulseResponse (spectralDelay, 8192);
+    const auto expected = static_cast<size_t> (spectralDelay.getLatencySamples() + 4 * SpectralDelay::hopSize);
+
+    for (size_t i = 0; i < output.size(); ++i)
+        REQUIRE_THAT(output[i], Catch::Matchers::WithinAbs (i == expected ? 1.0 : 0.0, 1.0e-4));
+}
+
+TEST_CASE("SpectralDelay: the feedback of a band repeats it at every delay")
+{
+    SpectralDelay spectralDelay;
+    spectralDelay.prepare ({ 48000.0, 100, 1 }, 48000);
+
+    for (int band = 0; band < SpectralDelay::numBands; ++band)
+        spectralDelay.setBand (band, 2.0f * SpectralDelay::hopSize, 0.5f);
+
+    const auto output = impulseResponse (spectralDelay, 8192);
+    const auto latency = static_cast<size_t> (spectralDelay.getLatencySamples());
+
+    for (size_t repeat = 1; repeat <= 4; ++repeat)
+        REQUIRE_THAT(output[latency + repeat * 2 * SpectralDelay::hopSize], Catch::Matchers::WithinAbs (std::pow (0.5, repeat - 1), 1.0e-4));
+}
+
+TEST_CASE("SpectralDelay: bands cover every bin once")
+{
+    SpectralDelay spectralDelay;
+
+    REQUIRE(spectralDelay.getBandStartBin (0) == 0);
+    REQUIRE(spectralDelay.getBandStartBin (SpectralDelay::numBands) == SpectralDelay::numBins);
+
+    for (int band = 0; band < SpectralDelay::numBands; ++band)
+        REQUIRE(spectralDelay.getBandStartBin (band) < spectralDelay.getBandStartBin (band + 1));
+}
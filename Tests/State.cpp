@@ -0,0 +1,44 @@
+#include <catch2/catch_test_macros.hpp>
+
+// Module to test.
+#include <cdrt/helper/State.h>
+
+TEST_CASE("State: parameters and snapshot survive a write/read round trip")
+{
+    const std::vector<cdrt::helper::state::Parameter> parameters { { 1, 0.5f }, { 3, 1250.0f }, { 8, 1.0f } };
+
+    cdrt::helper::state::Snapshot snapshot;
+    snapshot.sampleRate = 48000.0;
+    snapshot.buffer.setSize (2, 5);
+
+    for (int channel = 0; channel < 2; ++channel)
+        for (int i = 0; i < 5; ++i)
+            snapshot.buffer.setSample (channel, i, static_cast<float> (channel * 10 + i));
+
+    juce::MemoryBlock data;
+    cdrt::helper::state::write (data, parameters, &snapshot);
+
+    REQUIRE(cdrt::helper::state::isBinaryState (data.getData(), static_cast<int> (data.getSize())));
+
+    std::vector<cdrt::helper::state::Parameter> readParameters;
+    cdrt::helper::state::Snapshot readSnapshot;
+    REQUIRE(cdrt::helper::state::read (data.getData(), static_cast<int> (data.getSize()), readParameters, readSnapshot));
+
+    REQUIRE(readParameters.size() == parameters.size());
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        REQUIRE(readParameters[i].id == parameters[i].id);
+        REQUIRE(readParameters[i].value == parameters[i].value);
+    }
+
+    REQUIRE(readSnapshot.sampleRate == 48000.0);
+    REQUIRE(readSnapshot.buffer.getNumChannels() == 2);
+    REQUIRE(readSnapshot.buffer.getNumSamples() == 5);
+    REQUIRE(readSnapshot.buffer.getSample (1, 4) == 14.0f);
+
+    // Truncated data is rejected, XML data is not taken for a binary state.
+    REQUIRE_FALSE(cdrt::helper::state::read (data.getData(), static_cast<int> (data.getSize()) - 1, readParameters, readSnapshot));
+
+    const char xml[] = "<?xml version=\"1.0\"?>";
+    REQUIRE_FALSE(cdrt::helper::state::isBinaryState (xml, static_cast<int> (sizeof (xml))));
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <numbers>
+
+// Module to test.
+#include <cdrt/utility/Interpolation.h>
+#include <cdrt/utility/Tables.h>
+
+namespace tables = cdrt::utility::tables;
+
+// The tables are built by the compiler, the ends are checked while compiling.
+static_assert (tables::windowTable<tables::Window::linear>[0] == 0.0f);
+static_assert (tables::windowTable<tables::Window::linear>[512] == 1.0f);
+static_assert (tables::windowTable<tables::Window::hann>[0] == 0.0f);
+static_assert (tables::windowTable<tables::Window::equalPower, 64, double>[64] > 0.999999);
+static_assert (tables::lagrange3rdTable<>[0][1] == 1.0f);
+static_assert (tables::lagrange3rdTable<>[256][2] == 1.0f);
+
+TEST_CASE("Tables: windows match their definitions")
+{
+    for (int i = 0; i <= 100; ++i)
+    {
+        const auto position = static_cast<double> (i) / 100.0;
+        const auto in = tables::getWindowGain<tables::Window::equalPower> (position);
+        const auto out = tables::getWindowGain<tables::Window::equalPower> (1.0 - position);
+
+        REQUIRE_THAT(in, Catch::Matchers::WithinAbs (std::sin (position * std::numbers::pi / 2.0), 1.0e-5));
+        REQUIRE_THAT(in * in + out * out, Catch::Matchers::WithinAbs (1.0, 1.0e-5));
+
+        const auto hannIn = tables::getWindowGain<tables::Window::hann> (position);
+        const auto hannOut = tables::getWindowGain<tables::Window::hann> (1.0 - position);
+        REQUIRE_THAT(hannIn + hannOut, Catch::Matchers::WithinAbs (1.0, 1.0e-5));
+    }
+}
+
+TEST_CASE("Tables: tabulated lagrange matches the computed one")
+{
+    const float s1 = 0.3f, s2 = -0.7f, s3 = 0.9f, s4 = 0.1f;
+
+    for (int i = 0; i <= 256; ++i)
+    {
+        const auto delayFrac = 1.0f + static_cast<float> (i) / 256.0f;
+        REQUIRE_THAT(cdrt::utility::interpolation::lagrange3rdTabulated (s1, s2, s3, s4, delayFrac),
+                     Catch::Matchers::WithinAbs (cdrt::utility::interpolation::lagrange3rd (s1, s2, s3, s4, delayFrac), 1.0e-5));
+    }
+}
@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+
+// Module to test.
+#include <cdrt/utility/Trace.h>
+
+TEST_CASE("Trace ThreadBuffer: drained events are returned in push order")
+{
+    cdrt::utility::trace::ThreadBuffer buffer (1);
+
+    buffer.push ({ "first", 0, 10 });
+    buffer.push ({ "second", 10, 30 });
+
+    std::vector<juce::int64> durations;
+    buffer.drain ([&] (const cdrt::utility::trace::Event& event) { durations.push_back (event.end - event.start); });
+
+    REQUIRE(durations.size() == 2);
+    REQUIRE(durations[0] == 10);
+    REQUIRE(durations[1] == 20);
+}
+
+TEST_CASE("Trace ThreadBuffer: events pushed on a full buffer are dropped and counted")
+{
+    cdrt::utility::trace::ThreadBuffer buffer (1);
+
+    // Capacity is 1 << 15 events.
+    for (int i = 0; i < (1 << 15) + 3; ++i)
+        buffer.push ({ "event", i, i + 1 });
+
+    int drained = 0;
+    buffer.drain ([&] (const cdrt::utility::trace::Event&) { ++drained; });
+
+    REQUIRE(drained == (1 << 15));
+    REQUIRE(buffer.getAndResetDroppedEvents() == 3);
+    REQUIRE(buffer.getAndResetDroppedEvents() == 0);
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+
+// Module to test.
+#include <cdrt/utility/WorkerPool.h>
+
+namespace
+{
+struct Counters
+{
+    std::array<std::atomic<int>, 16> calls {};
+};
+
+void countCall (void* context, const int index)
+{
+    static_cast<Counters*> (context)->calls[static_cast<size_t> (index)].fetch_add (1);
+}
+} // namespace
+
+TEST_CASE("WorkerPool: every job runs exactly once per run")
+{
+    for (const auto numWorkers: { 0, 1, 3 })
+    {
+        cdrt::utility::WorkerPool pool;
+        pool.start (numWorkers);
+        REQUIRE(pool.getNumWorkers() == numWorkers);
+
+        Counters counters;
+        constexpr int numRuns = 2000;
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            // Alternating the number of jobs catches workers late from the previous run.
+            pool.run (&countCall, &counters, run % 2 == 0 ? 16 : 3);
+
+            // Sleeping workers must wake up too.
+            if (run % 500 == 0)
+                juce::Thread::sleep (5);
+        }
+
+        for (size_t i = 0; i < counters.calls.size(); ++i)
+            REQUIRE(counters.calls[i].load() == (i < 3 ? numRuns : numRuns / 2));
+
+        pool.stop();
+        REQUIRE(pool.getNumWorkers() == 0);
+    }
+}